@@ -0,0 +1,287 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Batch kernels compiled per instruction set with load-time dispatch.
+ *
+ * Each kernel is marked with the GNU "target_clones" attribute. The
+ * compiler emits one copy of the kernel per listed instruction set along
+ * with an (ifunc) resolver which the dynamic loader runs once to bind the
+ * kernel symbol to the best copy supported by the executing CPU.
+ *
+ * The kernels evaluate the same operations as EarthModel, but arranged
+ * as loops over blocks of (structure of arrays) values such that all
+ * but the trigonometric library calls vectorize for each instruction set.
+ * (The scalar EarthModel calls used in peri::batch do not vectorize, so
+ * that clones of a simple loop over them perform the same.)
+ */
+
+
+#include "periDispatch.h"
+
+#include "periBatch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+
+#if defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+#	if __has_attribute(target_clones)
+#		define PERI_DISPATCH_CLONES
+#	endif
+#endif
+
+#if defined(PERI_DISPATCH_CLONES)
+#	define PERI_KERNEL \
+		__attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#	define PERI_KERNEL
+#endif
+
+
+namespace
+{
+	//! Number of points per block (block values reside on the stack)
+	constexpr std::size_t sBlockSize{ 256u };
+
+	//! Kernel: geodetic for (at most sBlockSize) points (ref lpaForXyz())
+	PERI_KERNEL
+	void
+	lpaForXyzBlock
+		( peri::XYZ const * const xyzs
+		, std::size_t const numPnts
+		, peri::LPA * const lpas
+		, peri::EarthModel const & earthModel
+		)
+	{
+		std::array<double, 3u> const & muSqs
+			= earthModel.theEllip.theShapeNorm.theMuSqs;
+		double const lambda{ earthModel.theEllip.lambdaOrig() };
+		double const scl{ 1. / lambda };
+
+		// normalized locations and sigma start values (sphere)
+		double xs[sBlockSize];
+		double ys[sBlockSize];
+		double zs[sBlockSize];
+		double sigmas[sBlockSize];
+		unsigned char dones[sBlockSize];
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			xs[nn] = scl * xyzs[nn][0];
+			ys[nn] = scl * xyzs[nn][1];
+			zs[nn] = scl * xyzs[nn][2];
+			double const magSq{ xs[nn]*xs[nn] + ys[nn]*ys[nn] + zs[nn]*zs[nn] };
+			sigmas[nn] = std::sqrt(magSq) - 1.;
+			dones[nn] = 0u;
+		}
+
+		// linearized iteration (per point as EarthModel::sigmaNormFrom())
+		constexpr std::size_t nnMax{ 8u };
+		constexpr double tolDiff{ 1.e-15 };
+		for (std::size_t it{0u} ; it < nnMax ; ++it)
+		{
+			std::size_t numDone{ 0u };
+			for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+			{
+				double const sigma{ sigmas[nn] };
+				double const mps0{ muSqs[0] + sigma };
+				double const mps1{ muSqs[1] + sigma };
+				double const mps2{ muSqs[2] + sigma };
+				double term0{ (muSqs[0] * (xs[nn]*xs[nn])) / (mps0*mps0) };
+				double term1{ (muSqs[1] * (ys[nn]*ys[nn])) / (mps1*mps1) };
+				double term2{ (muSqs[2] * (zs[nn]*zs[nn])) / (mps2*mps2) };
+				double const func{ (term0 + term1 + term2) - 1. };
+				term0 /= mps0;
+				term1 /= mps1;
+				term2 /= mps2;
+				double const deriv{ -2.*(term0 + term1 + term2) };
+				double const next{ sigma - func/deriv };
+				bool const isConv
+					{ std::abs((1. + sigma) - (1. + next)) < tolDiff };
+				// converged points keep their value
+				sigmas[nn] = (dones[nn] ? sigma : next);
+				dones[nn] = static_cast<unsigned char>(dones[nn] | isConv);
+				numDone += dones[nn];
+			}
+			if (numPnts == numDone)
+			{
+				break;
+			}
+		}
+
+		// point on ellipsoid, gradient there and altitude
+		double gxs[sBlockSize];
+		double gys[sBlockSize];
+		double gzs[sBlockSize];
+		double hhs[sBlockSize];
+		double alts[sBlockSize];
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			double const sigma{ sigmas[nn] };
+			double const px{ muSqs[0] * xs[nn] / (muSqs[0] + sigma) };
+			double const py{ muSqs[1] * ys[nn] / (muSqs[1] + sigma) };
+			double const pz{ muSqs[2] * zs[nn] / (muSqs[2] + sigma) };
+			double const gx{ 2. * px / muSqs[0] };
+			double const gy{ 2. * py / muSqs[1] };
+			double const gz{ 2. * pz / muSqs[2] };
+			double const invMag{ 1. / std::sqrt(gx*gx + gy*gy + gz*gz) };
+			double const altNorm
+				{ (xs[nn] - px) * (invMag * gx)
+				+ (ys[nn] - py) * (invMag * gy)
+				+ (zs[nn] - pz) * (invMag * gz)
+				};
+			gxs[nn] = gx;
+			gys[nn] = gy;
+			gzs[nn] = gz;
+			hhs[nn] = std::sqrt(gx*gx + gy*gy);
+			alts[nn] = lambda * altNorm;
+		}
+
+		// angles (library calls, not vectorized)
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			double lon{ 0. };
+			if (! (0. == hhs[nn]))
+			{
+				lon = std::atan2(gys[nn], gxs[nn]);
+			}
+			lpas[nn] = peri::LPA{ lon, std::atan2(gzs[nn], hhs[nn]), alts[nn] };
+		}
+	}
+
+	//! Kernel: Cartesian for (at most sBlockSize) points (ref xyzForLpa())
+	PERI_KERNEL
+	void
+	xyzForLpaBlock
+		( peri::LPA const * const lpas
+		, std::size_t const numPnts
+		, peri::XYZ * const xyzs
+		, peri::EarthModel const & earthModel
+		)
+	{
+		std::array<double, 3u> const & muSqs
+			= earthModel.theEllip.theShapeNorm.theMuSqs;
+		double const lambda{ earthModel.theEllip.lambdaOrig() };
+
+		// up directions (library calls, not vectorized)
+		double uxs[sBlockSize];
+		double uys[sBlockSize];
+		double uzs[sBlockSize];
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			double const & lon = lpas[nn][0];
+			double const & par = lpas[nn][1];
+			uxs[nn] = std::cos(par) * std::cos(lon);
+			uys[nn] = std::cos(par) * std::sin(lon);
+			uzs[nn] = std::sin(par);
+		}
+
+		// displacement along normal from ellipsoid
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			double const & alt = lpas[nn][2];
+			double const sumMuUpSq
+				{ muSqs[0]*(uxs[nn]*uxs[nn])
+				+ muSqs[1]*(uys[nn]*uys[nn])
+				+ muSqs[2]*(uzs[nn]*uzs[nn])
+				};
+			double const scl{ lambda / std::sqrt(sumMuUpSq) };
+			xyzs[nn] = peri::XYZ
+				{ (scl*muSqs[0] + alt) * uxs[nn]
+				, (scl*muSqs[1] + alt) * uys[nn]
+				, (scl*muSqs[2] + alt) * uzs[nn]
+				};
+		}
+	}
+
+} // [annon]
+
+
+namespace peri
+{
+namespace dispatch
+{
+	char const *
+	isaName
+		()
+	{
+		char const * name{ "default" };
+#		if defined(PERI_DISPATCH_CLONES)
+		// same priority order as the resolver generated for PERI_KERNEL
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			name = "avx512f";
+		}
+		else
+		if (__builtin_cpu_supports("avx2"))
+		{
+			name = "avx2";
+		}
+#		endif
+		return name;
+	}
+
+	void
+	lpaForXyz
+		( XYZ const * const xyzs
+		, std::size_t const & numPnts
+		, LPA * const lpas
+		, EarthModel const & earthModel
+		)
+	{
+		PERI_TRACE_SCOPE("peri::dispatch::lpaForXyz", numPnts);
+		for (std::size_t beg{0u} ; beg < numPnts ; beg += sBlockSize)
+		{
+			std::size_t const num{ std::min(sBlockSize, numPnts - beg) };
+			lpaForXyzBlock(xyzs + beg, num, lpas + beg, earthModel);
+		}
+	}
+
+	void
+	xyzForLpa
+		( LPA const * const lpas
+		, std::size_t const & numPnts
+		, XYZ * const xyzs
+		, EarthModel const & earthModel
+		)
+	{
+		PERI_TRACE_SCOPE("peri::dispatch::xyzForLpa", numPnts);
+		for (std::size_t beg{0u} ; beg < numPnts ; beg += sBlockSize)
+		{
+			std::size_t const num{ std::min(sBlockSize, numPnts - beg) };
+			xyzForLpaBlock(lpas + beg, num, xyzs + beg, earthModel);
+		}
+	}
+
+} // [dispatch]
+} // [peri]
+
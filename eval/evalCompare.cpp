@@ -0,0 +1,560 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#include "peridetic.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/*! \file
+ * \brief Compare lpaForXyz() with classic published inverse algorithms.
+ *
+ * Each method is timed under the same loop harness (same data, same
+ * output buffer) and its results are compared with a reference solution
+ * computed in extended ('long double') precision.
+ *
+ * Alternative methods (textbook forms, not tuned):
+ * \arg Bowring (1976) - iteration on parametric latitude
+ * \arg Heikkinen (1982) - closed form (via cubic root)
+ * \arg Vermeille (2002) - closed form (via cubic root)
+ * \arg Fixed point - classic iteration on latitude via prime vertical
+ */
+
+
+namespace alt
+{
+	//! Ellipsoid parameter combinations used by the classic formulae
+	struct EllipParms
+	{
+		double const theA{};  //!< equatorial radius
+		double const theB{};  //!< polar radius
+		double const theE2{}; //!< first eccentricity squared
+		double const theEp2{}; //!< second eccentricity squared
+
+		//! Parameters for shape (expressed in physical units)
+		inline
+		static
+		EllipParms
+		from
+			( peri::Shape const & shape
+			)
+		{
+			double const & aa = shape.theRadA;
+			double const & bb = shape.theRadB;
+			double const aSq{ aa * aa };
+			double const bSq{ bb * bb };
+			return EllipParms
+				{ aa, bb, (aSq - bSq) / aSq, (aSq - bSq) / bSq };
+		}
+
+	}; // EllipParms
+
+	//! Altitude for (par, radius of parallel, z) location
+	inline
+	double
+	altitudeFor
+		( double const & par
+		, double const & hh
+		, double const & zz
+		, EllipParms const & ep
+		)
+	{
+		double const sPar{ std::sin(par) };
+		double const cPar{ std::cos(par) };
+		double const radN{ ep.theA / std::sqrt(1. - ep.theE2*sPar*sPar) };
+		return (hh*cPar + zz*sPar - ep.theA*ep.theA/radN);
+	}
+
+	//! Bowring's iteration starting from parametric latitude
+	inline
+	peri::LPA
+	lpaBowring
+		( peri::XYZ const & xyz
+		, EllipParms const & ep
+		, std::size_t const & numIter
+		)
+	{
+		double const & xx = xyz[0];
+		double const & yy = xyz[1];
+		double const & zz = xyz[2];
+		double const hh{ std::hypot(xx, yy) };
+		double const lon{ std::atan2(yy, xx) };
+		double const boa{ ep.theB / ep.theA };
+		double beta{ std::atan2(zz, boa * hh) };
+		double par{ beta };
+		for (std::size_t nn{0u} ; nn < numIter ; ++nn)
+		{
+			double const sb{ std::sin(beta) };
+			double const cb{ std::cos(beta) };
+			par = std::atan2
+				( zz + ep.theEp2 * ep.theB * sb*sb*sb
+				, hh - ep.theE2 * ep.theA * cb*cb*cb
+				);
+			beta = std::atan2(boa * std::sin(par), std::cos(par));
+		}
+		return { lon, par, altitudeFor(par, hh, zz, ep) };
+	}
+
+	//! Heikkinen's closed form solution
+	inline
+	peri::LPA
+	lpaHeikkinen
+		( peri::XYZ const & xyz
+		, EllipParms const & ep
+		)
+	{
+		double const & xx = xyz[0];
+		double const & yy = xyz[1];
+		double const & zz = xyz[2];
+		double const & aa = ep.theA;
+		double const & bb = ep.theB;
+		double const & e2 = ep.theE2;
+		double const aSq{ aa * aa };
+		double const bSq{ bb * bb };
+		double const zSq{ zz * zz };
+		double const hSq{ xx*xx + yy*yy };
+		double const hh{ std::sqrt(hSq) };
+		double const ff{ 54. * bSq * zSq };
+		double const gg{ hSq + (1. - e2)*zSq - e2*(aSq - bSq) };
+		double const cc{ e2*e2 * ff * hSq / (gg*gg*gg) };
+		double const ss{ std::cbrt(1. + cc + std::sqrt(cc*cc + 2.*cc)) };
+		double const kk{ ss + 1. + 1./ss };
+		double const pp{ ff / (3. * kk*kk * gg*gg) };
+		double const qq{ std::sqrt(1. + 2.*e2*e2*pp) };
+		double const r0
+			{ -(pp * e2 * hh) / (1. + qq)
+			+ std::sqrt
+				( .5*aSq*(1. + 1./qq)
+				- pp*(1. - e2)*zSq / (qq*(1. + qq))
+				- .5*pp*hSq
+				)
+			};
+		double const hmr{ hh - e2*r0 };
+		double const uu{ std::sqrt(hmr*hmr + zSq) };
+		double const vv{ std::sqrt(hmr*hmr + (1. - e2)*zSq) };
+		double const z0{ bSq * zz / (aa * vv) };
+		double const alt{ uu * (1. - bSq / (aa * vv)) };
+		double const par{ std::atan2(zz + ep.theEp2*z0, hh) };
+		double const lon{ std::atan2(yy, xx) };
+		return { lon, par, alt };
+	}
+
+	//! Vermeille's closed form solution
+	inline
+	peri::LPA
+	lpaVermeille
+		( peri::XYZ const & xyz
+		, EllipParms const & ep
+		)
+	{
+		double const & xx = xyz[0];
+		double const & yy = xyz[1];
+		double const & zz = xyz[2];
+		double const & aa = ep.theA;
+		double const & e2 = ep.theE2;
+		double const e4{ e2 * e2 };
+		double const aSq{ aa * aa };
+		double const hSq{ xx*xx + yy*yy };
+		double const hh{ std::sqrt(hSq) };
+		double const pp{ hSq / aSq };
+		double const qq{ (1. - e2) * zz*zz / aSq };
+		double const rr{ (pp + qq - e4) / 6. };
+		double const ss{ e4 * pp * qq / (4. * rr*rr*rr) };
+		double const tt{ std::cbrt(1. + ss + std::sqrt(ss * (2. + ss))) };
+		double const uu{ rr * (1. + tt + 1./tt) };
+		double const vv{ std::sqrt(uu*uu + e4*qq) };
+		double const ww{ e2 * (uu + vv - qq) / (2. * vv) };
+		double const kk{ std::sqrt(uu + vv + ww*ww) - ww };
+		double const dd{ kk * hh / (kk + e2) };
+		double const dz{ std::hypot(dd, zz) };
+		double const par{ 2. * std::atan2(zz, dd + dz) };
+		double const alt{ (kk + e2 - 1.) / kk * dz };
+		double const lon{ std::atan2(yy, xx) };
+		return { lon, par, alt };
+	}
+
+	//! Classic fixed point iteration on latitude (via prime vertical radius)
+	inline
+	peri::LPA
+	lpaFixedPoint
+		( peri::XYZ const & xyz
+		, EllipParms const & ep
+		)
+	{
+		double const & xx = xyz[0];
+		double const & yy = xyz[1];
+		double const & zz = xyz[2];
+		double const hh{ std::hypot(xx, yy) };
+		double const lon{ std::atan2(yy, xx) };
+		double par{ std::atan2(zz, (1. - ep.theE2) * hh) };
+		double alt{ 0. };
+		constexpr std::size_t nnMax{ 32u };
+		for (std::size_t nn{0u} ; nn < nnMax ; ++nn)
+		{
+			double const sPar{ std::sin(par) };
+			double const radN{ ep.theA / std::sqrt(1. - ep.theE2*sPar*sPar) };
+			alt = altitudeFor(par, hh, zz, ep);
+			double const next
+				{ std::atan2(zz, hh * (1. - ep.theE2 * radN / (radN + alt))) };
+			bool const done{ std::abs(next - par) < 1.e-15 };
+			par = next;
+			if (done)
+			{
+				break;
+			}
+		}
+		return { lon, par, altitudeFor(par, hh, zz, ep) };
+	}
+
+} // [alt]
+
+
+namespace ref
+{
+	using Real = long double;
+
+	/*! \brief Extended precision inverse transformation (reference values)
+	 *
+	 * Same geometric formulation as peridetic (perpendicular projection
+	 * via dilation parameter sigma) but evaluated with 'long double'
+	 * and iterated to full convergence.
+	 */
+	inline
+	peri::LPA
+	lpaFor
+		( peri::XYZ const & xyzOrig
+		, peri::Shape const & shapeOrig
+		)
+	{
+		Real const aa{ shapeOrig.theRadA };
+		Real const bb{ shapeOrig.theRadB };
+		Real const lam{ std::sqrt(aa * bb) };
+		std::array<Real, 3u> const muSqs
+			{ (aa/lam)*(aa/lam), (aa/lam)*(aa/lam), (bb/lam)*(bb/lam) };
+		std::array<Real, 3u> const xv
+			{ Real(xyzOrig[0])/lam, Real(xyzOrig[1])/lam, Real(xyzOrig[2])/lam };
+
+		Real sigma{ std::sqrt(xv[0]*xv[0] + xv[1]*xv[1] + xv[2]*xv[2]) - 1.L };
+		for (std::size_t nn{0u} ; nn < 64u ; ++nn)
+		{
+			Real func{ -1.L };
+			Real dfds{ 0.L };
+			for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+			{
+				Real const den{ muSqs[kk] + sigma };
+				Real const term{ muSqs[kk] * xv[kk]*xv[kk] / (den*den) };
+				func += term;
+				dfds += -2.L * term / den;
+			}
+			Real const next{ sigma - func/dfds };
+			bool const done{ next == sigma };
+			sigma = next;
+			if (done)
+			{
+				break;
+			}
+		}
+
+		std::array<Real, 3u> pv;
+		std::array<Real, 3u> gv;
+		for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+		{
+			pv[kk] = muSqs[kk] * xv[kk] / (muSqs[kk] + sigma);
+			gv[kk] = pv[kk] / muSqs[kk];
+		}
+		Real const gh{ std::sqrt(gv[0]*gv[0] + gv[1]*gv[1]) };
+		Real const gMag{ std::sqrt(gh*gh + gv[2]*gv[2]) };
+		Real lon{ 0.L };
+		if (! (0.L == gh))
+		{
+			lon = std::atan2(gv[1], gv[0]);
+		}
+		Real const par{ std::atan2(gv[2], gh) };
+		Real const alt
+			{ lam *
+				( (xv[0] - pv[0]) * gv[0]
+				+ (xv[1] - pv[1]) * gv[1]
+				+ (xv[2] - pv[2]) * gv[2]
+				) / gMag
+			};
+		return
+			{ static_cast<double>(lon)
+			, static_cast<double>(par)
+			, static_cast<double>(alt)
+			};
+	}
+
+} // [ref]
+
+
+namespace
+{
+	//! Evaluation data: (double) Cartesian inputs and reference LPA results
+	struct DataSet
+	{
+		std::string const theName{};
+		std::vector<peri::XYZ> theXyzs{};
+		std::vector<peri::LPA> theRefLpas{};
+
+		//! Samples at altitudes (and bulk lon/par) for earth shape
+		inline
+		static
+		DataSet
+		from
+			( std::string const & name
+			, std::vector<double> const & altSamps
+			, peri::EarthModel const & earth
+			)
+		{
+			std::vector<double> const lonSamps{ peri::sim::bulkSamplesLon(64u) };
+			std::vector<double> const parSamps{ peri::sim::bulkSamplesPar(64u) };
+			std::vector<peri::LPA> const lpas
+				{ peri::sim::comboSamplesLpa(lonSamps, parSamps, altSamps) };
+			peri::Shape const & shape = earth.theEllip.theShapeOrig;
+			DataSet data{ name, {}, {} };
+			data.theXyzs.reserve(lpas.size());
+			data.theRefLpas.reserve(lpas.size());
+			for (peri::LPA const & lpa : lpas)
+			{
+				peri::XYZ const xyz{ peri::xyzForLpa(lpa, earth) };
+				data.theXyzs.emplace_back(xyz);
+				data.theRefLpas.emplace_back(ref::lpaFor(xyz, shape));
+			}
+			return data;
+		}
+
+	}; // DataSet
+
+	//! Speed and accuracy summary for one method on one data set
+	struct Result
+	{
+		std::string theName{};
+		double theSecPerPnt{ peri::sNan };
+		double theMaxErrAng{ peri::sNan }; //!< [rad] worst of lon/par
+		double theMaxErrAlt{ peri::sNan }; //!< [m]
+		double theMaxErrLin{ peri::sNan }; //!< [m] combined (arc + alt)
+		std::size_t theNumBad{ 0u }; //!< count of invalid (NaN) results
+
+	}; // Result
+
+	//! Time (best of several runs) and evaluate errors for method func
+	template <typename Func>
+	inline
+	Result
+	resultFor
+		( std::string const & name
+		, DataSet const & data
+		, Func const & func
+		, peri::Shape const & shape
+		)
+	{
+		std::vector<peri::LPA> gotLpas(data.theXyzs.size());
+		double bestTime{ std::numeric_limits<double>::max() };
+		constexpr std::size_t numRuns{ 5u };
+		for (std::size_t run{0u} ; run < numRuns ; ++run)
+		{
+			using namespace std::chrono;
+			steady_clock::time_point const t0{ steady_clock::now() };
+			std::transform
+				( data.theXyzs.cbegin(), data.theXyzs.cend()
+				, gotLpas.begin()
+				, func
+				);
+			steady_clock::time_point const t1{ steady_clock::now() };
+			duration<double> const delta{ t1 - t0 };
+			bestTime = std::min(bestTime, delta.count());
+		}
+
+		Result result{ name };
+		result.theSecPerPnt
+			= bestTime / static_cast<double>(data.theXyzs.size());
+		result.theMaxErrAng = 0.;
+		result.theMaxErrAlt = 0.;
+		result.theMaxErrLin = 0.;
+		double const & radA = shape.theRadA;
+		for (std::size_t nn{0u} ; nn < gotLpas.size() ; ++nn)
+		{
+			peri::LPA const & got = gotLpas[nn];
+			peri::LPA const & exp = data.theRefLpas[nn];
+			// longitude error is irrelevant (undefined) on polar axis
+			double const cosPar{ std::cos(exp[1]) };
+			double const difLon{ cosPar * peri::principalAngle(got[0] - exp[0]) };
+			double const difPar{ got[1] - exp[1] };
+			double const difAlt{ got[2] - exp[2] };
+			double const errAng{ std::max(std::abs(difLon), std::abs(difPar)) };
+			double const errLin
+				{ std::sqrt
+					(peri::sq(radA*difLon) + peri::sq(radA*difPar) + peri::sq(difAlt))
+				};
+			// count (rather than propagate) NaN results, e.g. singularities
+			if (! peri::isValid(errLin))
+			{
+				++result.theNumBad;
+				continue;
+			}
+			result.theMaxErrAng = std::max(result.theMaxErrAng, errAng);
+			result.theMaxErrAlt = std::max(result.theMaxErrAlt, std::abs(difAlt));
+			result.theMaxErrLin = std::max(result.theMaxErrLin, errLin);
+		}
+		return result;
+	}
+
+	//! Tabular report of method results
+	std::string
+	infoString
+		( std::vector<Result> const & results
+		, std::string const & title
+		, std::size_t const & numSamps
+		)
+	{
+		std::ostringstream oss;
+		double const baseTime{ results.front().theSecPerPnt };
+		oss << std::endl;
+		oss << "# Data set: " << title << "  numSamps: " << numSamps << '\n';
+		oss << "#"
+			<< std::setw(23u) << "method"
+			<< std::setw(12u) << "ns/point"
+			<< std::setw(10u) << "relTime"
+			<< std::setw(16u) << "maxErrAng[rad]"
+			<< std::setw(16u) << "maxErrAlt[m]"
+			<< std::setw(16u) << "maxErrLin[m]"
+			<< std::setw(8u) << "numNaN"
+			<< '\n';
+		for (Result const & result : results)
+		{
+			oss << std::setw(24u) << result.theName
+				<< std::fixed << std::setprecision(2)
+				<< std::setw(12u) << (1.e+9 * result.theSecPerPnt)
+				<< std::setw(10u) << (result.theSecPerPnt / baseTime)
+				<< std::scientific << std::setprecision(2)
+				<< std::setw(16u) << result.theMaxErrAng
+				<< std::setw(16u) << result.theMaxErrAlt
+				<< std::setw(16u) << result.theMaxErrLin
+				<< std::setw(8u) << result.theNumBad
+				<< '\n';
+		}
+		return oss.str();
+	}
+
+	//! Evaluate all methods against data set
+	std::vector<Result>
+	resultsFor
+		( DataSet const & data
+		, peri::EarthModel const & earth
+		)
+	{
+		peri::Shape const & shape = earth.theEllip.theShapeOrig;
+		alt::EllipParms const ep{ alt::EllipParms::from(shape) };
+		return std::vector<Result>
+			{ resultFor
+				( "peridetic", data
+				, [&earth] (peri::XYZ const & xyz)
+					{ return earth.lpaForXyz(xyz); }
+				, shape
+				)
+			, resultFor
+				( "Bowring(1 iter)", data
+				, [&ep] (peri::XYZ const & xyz)
+					{ return alt::lpaBowring(xyz, ep, 1u); }
+				, shape
+				)
+			, resultFor
+				( "Bowring(2 iter)", data
+				, [&ep] (peri::XYZ const & xyz)
+					{ return alt::lpaBowring(xyz, ep, 2u); }
+				, shape
+				)
+			, resultFor
+				( "Heikkinen", data
+				, [&ep] (peri::XYZ const & xyz)
+					{ return alt::lpaHeikkinen(xyz, ep); }
+				, shape
+				)
+			, resultFor
+				( "Vermeille", data
+				, [&ep] (peri::XYZ const & xyz)
+					{ return alt::lpaVermeille(xyz, ep); }
+				, shape
+				)
+			, resultFor
+				( "FixedPoint(latitude)", data
+				, [&ep] (peri::XYZ const & xyz)
+					{ return alt::lpaFixedPoint(xyz, ep); }
+				, shape
+				)
+			};
+	}
+
+} // [annon]
+
+
+//! Report speed and accuracy of peridetic and classic alternatives
+int
+main
+	()
+{
+	peri::EarthModel const & earth = peri::model::WGS84;
+
+	std::cout << "--- setup: " << std::endl;
+
+	std::vector<DataSet> const datas
+		{ DataSet::from("design(+/-100km)", peri::sim::bulkSamplesAlt(32u), earth)
+		, DataSet::from("surface(+/-1km)", { -1.e+3, 0., 1.e+3 }, earth)
+		, DataSet::from("GNSS(20000km)", { 20.e+6 }, earth)
+		};
+
+	std::cout << "--- reporting: " << std::endl;
+
+	std::ostringstream rpt;
+	rpt << std::endl;
+	rpt << "# Comparison with classic algorithms" << '\n';
+	rpt << "# -- time: best of several runs (same loop for each method)" << '\n';
+	rpt << "# -- error: vs extended precision (long double) reference" << '\n';
+	rpt << "# -- maxErrLin: combined arc (at equator radius) and altitude" << '\n';
+	rpt << "# -- numNaN: invalid results (excluded from error maxima)" << '\n';
+	for (DataSet const & data : datas)
+	{
+		std::vector<Result> const results{ resultsFor(data, earth) };
+		rpt << infoString(results, data.theName, data.theXyzs.size());
+	}
+
+	std::cout << rpt.str() << std::endl;
+
+	return 0;
+}
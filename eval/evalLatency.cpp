@@ -0,0 +1,368 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#include "peridetic.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <x86intrin.h>
+#	define PeriUseTSC
+#endif
+
+
+/*! \file
+ * \brief Per-call latency distribution of peri::lpaForXyz().
+ *
+ * Each call is bracketed by serialized time stamp counter reads (on
+ * x86 platforms, otherwise std::chrono::steady_clock) so that the
+ * distribution tail (p99, p99.9, max) can be inspected separately
+ * for each altitude band (where solver iteration counts differ).
+ */
+
+
+namespace
+{
+	//! Prevent compiler from reordering/eliding access to value
+	template <typename Type>
+	inline
+	void
+	opaque
+		( Type & value
+		)
+	{
+#if defined(__GNUC__)
+		__asm__ __volatile__ ("" : "+m"(value) : : "memory");
+#else
+		(void)value;
+#endif
+	}
+
+	//! Serialized read of tick counter (all prior instructions retired)
+	inline
+	std::uint64_t
+	ticksBeg
+		()
+	{
+#if defined(PeriUseTSC)
+		_mm_lfence();
+		std::uint64_t const tick{ __rdtsc() };
+		_mm_lfence();
+		return tick;
+#else
+		using namespace std::chrono;
+		return static_cast<std::uint64_t>
+			(steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	//! Serialized read of tick counter (measured code has completed)
+	inline
+	std::uint64_t
+	ticksEnd
+		()
+	{
+#if defined(PeriUseTSC)
+		unsigned int aux{};
+		std::uint64_t const tick{ __rdtscp(&aux) };
+		_mm_lfence();
+		return tick;
+#else
+		return ticksBeg();
+#endif
+	}
+
+	//! Approximate duration of one tick in [ns] (via steady_clock)
+	inline
+	double
+	nanoSecPerTick
+		()
+	{
+		using namespace std::chrono;
+		steady_clock::time_point const tBeg{ steady_clock::now() };
+		std::uint64_t const kBeg{ ticksBeg() };
+		steady_clock::time_point tEnd{ tBeg };
+		while ((tEnd - tBeg) < milliseconds(50))
+		{
+			tEnd = steady_clock::now();
+		}
+		std::uint64_t const kEnd{ ticksEnd() };
+		duration<double, std::nano> const delta{ tEnd - tBeg };
+		return (delta.count() / static_cast<double>(kEnd - kBeg));
+	}
+
+	//! Altitude stratum over which to evaluate latency distribution
+	struct Region
+	{
+		std::string const theName{};
+		peri::sim::Range const theAltRange{};
+
+	}; // Region
+
+	//! Cartesian sample locations for region (in randomized order)
+	std::vector<peri::XYZ>
+	xyzSamplesFor
+		( Region const & region
+		, peri::EarthModel const & earth
+		)
+	{
+		constexpr std::size_t numLon{ 61u };
+		constexpr std::size_t numPar{ 59u };
+		constexpr std::size_t numAlt{ 17u };
+		std::vector<double> const lonSamps{ peri::sim::bulkSamplesLon(numLon) };
+		std::vector<double> const parSamps{ peri::sim::bulkSamplesPar(numPar) };
+		peri::sim::SampleSpec const altSpec{ numAlt, region.theAltRange };
+		std::vector<double> const altSamps
+			{ peri::sim::samplesAccordingTo(altSpec) };
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::comboSamplesLpa(lonSamps, parSamps, altSamps) };
+
+		std::vector<peri::XYZ> xyzs;
+		xyzs.reserve(lpas.size());
+		for (peri::LPA const & lpa : lpas)
+		{
+			xyzs.emplace_back(peri::xyzForLpa(lpa, earth));
+		}
+
+		// random order (repeatably) defeats branch history memorization
+		std::mt19937_64 gen(0x5eed5eedu);
+		std::shuffle(xyzs.begin(), xyzs.end(), gen);
+		return xyzs;
+	}
+
+	//! Tick count for each individual call (minus timing overhead)
+	std::vector<std::uint64_t>
+	callTicksFor
+		( std::vector<peri::XYZ> const & xyzs
+		, peri::EarthModel const & earth
+		, std::uint64_t const & overhead
+		, double * const & ptSink
+		)
+	{
+		std::vector<std::uint64_t> ticks;
+		ticks.reserve(xyzs.size());
+		double sink{ 0. };
+		for (peri::XYZ const & xyz : xyzs)
+		{
+			peri::XYZ xyzIn{ xyz };
+			opaque(xyzIn);
+			std::uint64_t const tBeg{ ticksBeg() };
+			opaque(xyzIn);
+			peri::LPA lpa{ earth.lpaForXyz(xyzIn) };
+			opaque(lpa);
+			std::uint64_t const tEnd{ ticksEnd() };
+			sink += lpa[2];
+			std::uint64_t const delta{ tEnd - tBeg };
+			ticks.emplace_back((overhead < delta) ? (delta - overhead) : 0u);
+		}
+		*ptSink += sink;
+		return ticks;
+	}
+
+	//! Minimum tick count for timing an empty code block
+	std::uint64_t
+	overheadTicks
+		()
+	{
+		std::uint64_t minTicks{ std::numeric_limits<std::uint64_t>::max() };
+		for (std::size_t nn{0u} ; nn < 4096u ; ++nn)
+		{
+			std::uint64_t const tBeg{ ticksBeg() };
+			std::uint64_t const tEnd{ ticksEnd() };
+			minTicks = std::min(minTicks, (tEnd - tBeg));
+		}
+		return minTicks;
+	}
+
+	//! Value at fractional rank (0 <= frac <= 1) of *SORTED* ticks
+	inline
+	std::uint64_t
+	percentile
+		( std::vector<std::uint64_t> const & sortTicks
+		, double const & frac
+		)
+	{
+		std::size_t const last{ sortTicks.size() - 1u };
+		std::size_t const ndx
+			{ static_cast<std::size_t>(frac * static_cast<double>(last)) };
+		return sortTicks[std::min(ndx, last)];
+	}
+
+	//! Percentile summary (in [ns]) for a region
+	std::string
+	percentileInfo
+		( std::vector<std::uint64_t> const & sortTicks
+		, double const & nsPerTick
+		, std::string const & title
+		)
+	{
+		std::ostringstream oss;
+		oss << std::setw(16u) << std::left << title << std::right;
+		std::vector<std::pair<double, std::string> > const fracNames
+			{ { .000, "min" }
+			, { .500, "p50" }
+			, { .900, "p90" }
+			, { .990, "p99" }
+			, { .999, "p99.9" }
+			, { 1.00, "max" }
+			};
+		for (std::pair<double, std::string> const & fracName : fracNames)
+		{
+			double const nsec
+				{ nsPerTick * static_cast<double>
+					(percentile(sortTicks, fracName.first))
+				};
+			oss << "  " << fracName.second << ": "
+				<< std::fixed << std::setprecision(1) << std::setw(8u) << nsec;
+		}
+		return oss.str();
+	}
+
+	//! Histogram (quarter octave bins in [ns]) for a region
+	std::string
+	histogramInfo
+		( std::vector<std::uint64_t> const & sortTicks
+		, double const & nsPerTick
+		)
+	{
+		std::ostringstream oss;
+		// bin edges increase geometrically by factor 2^(1/4)
+		double const binFactor{ std::pow(2., .25) };
+		double edgeLo{ 1. };
+		double const nsMax{ nsPerTick * static_cast<double>(sortTicks.back()) };
+		std::size_t const numTotal{ sortTicks.size() };
+		std::vector<std::uint64_t>::const_iterator itLo{ sortTicks.cbegin() };
+		while (edgeLo < (binFactor * nsMax))
+		{
+			double const edgeHi{ binFactor * edgeLo };
+			std::vector<std::uint64_t>::const_iterator const itHi
+				{ std::find_if
+					( itLo, sortTicks.cend()
+					, [&nsPerTick, &edgeHi] (std::uint64_t const & tick)
+						{ return ! (nsPerTick*static_cast<double>(tick) < edgeHi); }
+					)
+				};
+			std::size_t const count
+				{ static_cast<std::size_t>(std::distance(itLo, itHi)) };
+			if (0u < count)
+			{
+				double const frac
+					{ static_cast<double>(count) / static_cast<double>(numTotal) };
+				// bar length on log scale so that rare tail events are visible
+				std::size_t const barLen
+					{ static_cast<std::size_t>
+						(std::max(1., 60. + 6.*std::log2(frac)))
+					};
+				oss << std::fixed << std::setprecision(1)
+					<< "  [" << std::setw(8u) << edgeLo
+					<< "," << std::setw(8u) << edgeHi << ") ns "
+					<< std::setw(9u) << count << " "
+					<< std::string(barLen, '#')
+					<< '\n';
+			}
+			itLo = itHi;
+			edgeLo = edgeHi;
+		}
+		return oss.str();
+	}
+
+} // [annon]
+
+
+//! Report per-call latency distribution of lpaForXyz() by altitude band
+int
+main
+	()
+{
+	peri::EarthModel const & earth = peri::model::WGS84;
+
+	std::vector<Region> const regions
+		{ { "deep", { -100.e+3, -10.e+3 } }
+		, { "surface", { -10.e+3, 10.e+3 } }
+		, { "aerial", { 10.e+3, 100.e+3 } }
+		, { "orbitLEO", { 200.e+3, 2000.e+3 } }
+		, { "orbitGNSS", { 19.e+6, 26.e+6 } }
+		};
+
+	double const nsPerTick{ nanoSecPerTick() };
+	std::uint64_t const overhead{ overheadTicks() };
+
+	std::ostringstream rpt;
+	rpt << std::endl;
+	rpt << "# Per-call latency of lpaForXyz() [ns]" << '\n';
+#if defined(PeriUseTSC)
+	rpt << "# -- timer: serialized TSC (lfence/rdtsc ... rdtscp/lfence)" << '\n';
+#else
+	rpt << "# -- timer: std::chrono::steady_clock" << '\n';
+#endif
+	rpt << "# -- ns/tick: " << std::setprecision(6) << nsPerTick << '\n';
+	rpt << "# -- timer overhead (subtracted) [ticks]: " << overhead << '\n';
+	rpt << std::endl;
+
+	double sink{ 0. };
+	std::ostringstream hst;
+	for (Region const & region : regions)
+	{
+		std::vector<peri::XYZ> const xyzs{ xyzSamplesFor(region, earth) };
+
+		// warm caches and branch predictors before recording
+		(void)callTicksFor(xyzs, earth, overhead, &sink);
+		std::vector<std::uint64_t> ticks
+			{ callTicksFor(xyzs, earth, overhead, &sink) };
+		std::sort(ticks.begin(), ticks.end());
+
+		rpt << percentileInfo(ticks, nsPerTick, region.theName) << '\n';
+
+		hst << std::endl;
+		hst << "# Histogram: " << region.theName
+			<< "  alt[m]: " << peri::string::fixedLinear(region.theAltRange.first)
+			<< " " << peri::string::fixedLinear(region.theAltRange.second)
+			<< "  numSamps: " << ticks.size()
+			<< '\n';
+		hst << histogramInfo(ticks, nsPerTick);
+	}
+
+	std::cout << rpt.str() << hst.str() << std::endl;
+	std::cout << "# (sink: " << sink << ")" << std::endl;
+
+	return 0;
+}
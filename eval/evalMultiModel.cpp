@@ -0,0 +1,108 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Compare single pass two model conversion with separate passes.
+ */
+
+
+#include "periBatch.h"
+
+#include "evalTiming.h"
+#include "periSim.h"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+//! Compare WGS84+GRS80 single pass with single and separate conversions
+int
+main
+	()
+{
+	peri::EarthModel const & earthA = peri::model::WGS84;
+	peri::EarthModel const & earthB = peri::model::GRS80;
+
+	peri::sim::RandomGen const gen
+		{ 1u << 20u, 29u, peri::sim::sRangeLon, peri::sim::sRangePar };
+	std::size_t const numPnts{ gen.size() };
+	std::vector<peri::LPA> lpas(numPnts);
+	for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+	{
+		lpas[nn] = gen.valueAt(nn);
+	}
+	std::vector<peri::XYZ> xyzs(numPnts);
+	peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data(), earthA);
+
+	std::vector<peri::LPA> lpasA(numPnts);
+	std::vector<peri::LPA> lpasB(numPnts);
+	double const secSingle
+		{ eval::bestTimeOf
+			([&] ()
+				{ peri::batch::lpaForXyz
+					(xyzs.data(), numPnts, lpasA.data(), earthA);
+				}
+			)
+		};
+	double const secSeparate
+		{ eval::bestTimeOf
+			([&] ()
+				{
+					peri::batch::lpaForXyz
+						(xyzs.data(), numPnts, lpasA.data(), earthA);
+					peri::batch::lpaForXyz
+						(xyzs.data(), numPnts, lpasB.data(), earthB);
+				}
+			)
+		};
+	double const secPair
+		{ eval::bestTimeOf
+			([&] ()
+				{ peri::batch::lpaForXyzPair
+					( xyzs.data(), numPnts, lpasA.data(), lpasB.data()
+					, earthA, earthB
+					);
+				}
+			)
+		};
+
+	std::cout << "# numPnts: " << numPnts << '\n';
+	std::cout << std::fixed << std::setprecision(3)
+		<< "single model [sec]: " << secSingle << '\n'
+		<< "separate (2x) [sec]: " << secSeparate
+			<< "  (" << (secSeparate / secSingle) << " x single)" << '\n'
+		<< "single pass [sec]: " << secPair
+			<< "  (" << (secPair / secSingle) << " x single)" << '\n'
+		;
+
+	return 0;
+}
+
@@ -0,0 +1,667 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#include "peridetic.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/*! \file
+ * \brief Explore accuracy/speed trade-off of inverse solver configurations.
+ *
+ * Each solver configuration (floating point type, sigma seed estimator
+ * and iteration count) is evaluated for each altitude/latitude band.
+ * Errors are relative to a fully converged 'long double' solution.
+ *
+ * Results include:
+ * \arg Table of max/RMS error and throughput per band
+ * \arg Pareto table (overall throughput vs overall max error)
+ * \arg Plot data file "paretoData.dat" (ref plotPareto.plt)
+ *
+ * Optional argument: accuracy budget [m] - reports the fastest
+ * configuration with overall max error within that budget.
+ */
+
+
+namespace
+{
+	//! Initial estimate strategy for (normalized) sigma parameter
+	enum class Seed
+	{
+		  Sphere //!< |x| - 1 (as in peri::EarthModel)
+		, Radial //!< from radial pseudo-altitude (ref evalExcess)
+		, Zero //!< start on the ellipsoid
+	};
+
+	//! Name associated with seed enum
+	inline
+	std::string
+	nameFor
+		( Seed const & seed
+		)
+	{
+		std::string name{ "unknown" };
+		switch (seed)
+		{
+			case Seed::Sphere: name = "sphere"; break;
+			case Seed::Radial: name = "radial"; break;
+			case Seed::Zero: name = "zero"; break;
+		}
+		return name;
+	}
+
+	/*! \brief Configurable version of peridetic inverse solver.
+	 *
+	 * Mirrors the EarthModel::lpaForXyz() computation sequence but with
+	 * computation type (Real), sigma seed and iteration policy chosen
+	 * by template/construction parameters.
+	 */
+	template <typename Real>
+	struct Solver
+	{
+		//! Characteristic length for normalization
+		Real theLambda{};
+		//! Normalized squared radii
+		std::array<Real, 3u> theMuSqs{};
+		//! Seed estimation strategy
+		Seed theSeed{ Seed::Sphere };
+		//! Number of Newton steps (0 means iterate until converged)
+		std::size_t theNumIter{ 0u };
+
+		//! Solver configuration for shape
+		inline
+		explicit
+		Solver
+			( peri::Shape const & shape
+			, Seed const & seed
+			, std::size_t const & numIter
+			)
+			: theLambda{ static_cast<Real>(shape.theLambda) }
+			, theMuSqs{}
+			, theSeed{ seed }
+			, theNumIter{ numIter }
+		{
+			peri::Shape const norm{ shape.normalizedShape() };
+			for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+			{
+				theMuSqs[kk] = static_cast<Real>(norm.theMuSqs[kk]);
+			}
+		}
+
+		//! Initial sigma value
+		inline
+		Real
+		sigmaSeed
+			( std::array<Real, 3u> const & xv
+			) const
+		{
+			Real sigma{ 0 };
+			Real const xMag{ std::sqrt(xv[0]*xv[0] + xv[1]*xv[1] + xv[2]*xv[2]) };
+			if (Seed::Sphere == theSeed)
+			{
+				sigma = xMag - Real(1);
+			}
+			else
+			if (Seed::Radial == theSeed)
+			{
+				// radius of ellipsoid toward xv and gradient magnitude there
+				Real sumQ{ 0 };
+				for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+				{
+					sumQ += xv[kk]*xv[kk] / theMuSqs[kk];
+				}
+				Real const rScl{ Real(1) / std::sqrt(sumQ) }; // r = rScl * x
+				Real grSq{ 0 };
+				for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+				{
+					Real const grk{ Real(2) * rScl * xv[kk] / theMuSqs[kk] };
+					grSq += grk * grk;
+				}
+				Real const eta0{ (Real(1) - rScl) * xMag };
+				sigma = Real(2) * eta0 / std::sqrt(grSq);
+			}
+			return sigma;
+		}
+
+		//! One Newton step for sigma
+		inline
+		Real
+		nextSigma
+			( Real const & sigma
+			, std::array<Real, 3u> const & xv
+			) const
+		{
+			Real func{ -1 };
+			Real dfds{ 0 };
+			for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+			{
+				Real const den{ theMuSqs[kk] + sigma };
+				Real const term{ theMuSqs[kk] * xv[kk]*xv[kk] / (den*den) };
+				func += term;
+				dfds += Real(-2) * term / den;
+			}
+			return (sigma - func/dfds);
+		}
+
+		//! Geodetic coordinates via configured solution strategy
+		inline
+		peri::LPA
+		lpaFor
+			( peri::XYZ const & xyz
+			) const
+		{
+			std::array<Real, 3u> const xv
+				{ static_cast<Real>(xyz[0]) / theLambda
+				, static_cast<Real>(xyz[1]) / theLambda
+				, static_cast<Real>(xyz[2]) / theLambda
+				};
+			Real sigma{ sigmaSeed(xv) };
+			if (0u < theNumIter)
+			{
+				for (std::size_t nn{0u} ; nn < theNumIter ; ++nn)
+				{
+					sigma = nextSigma(sigma, xv);
+				}
+			}
+			else
+			{
+				constexpr Real tol{ Real(8) * std::numeric_limits<Real>::epsilon() };
+				for (std::size_t nn{0u} ; nn < 32u ; ++nn)
+				{
+					Real const next{ nextSigma(sigma, xv) };
+					bool const done{ std::abs(next - sigma) < tol };
+					sigma = next;
+					if (done)
+					{
+						break;
+					}
+				}
+			}
+			std::array<Real, 3u> pv;
+			std::array<Real, 3u> gv;
+			for (std::size_t kk{0u} ; kk < 3u ; ++kk)
+			{
+				pv[kk] = theMuSqs[kk] * xv[kk] / (theMuSqs[kk] + sigma);
+				gv[kk] = pv[kk] / theMuSqs[kk];
+			}
+			Real const gh{ std::sqrt(gv[0]*gv[0] + gv[1]*gv[1]) };
+			Real const gMag{ std::sqrt(gh*gh + gv[2]*gv[2]) };
+			Real lon{ 0 };
+			if (! (Real(0) == gh))
+			{
+				lon = std::atan2(gv[1], gv[0]);
+			}
+			Real const par{ std::atan2(gv[2], gh) };
+			Real const alt
+				{ theLambda *
+					( (xv[0] - pv[0]) * gv[0]
+					+ (xv[1] - pv[1]) * gv[1]
+					+ (xv[2] - pv[2]) * gv[2]
+					) / gMag
+				};
+			return
+				{ static_cast<double>(lon)
+				, static_cast<double>(par)
+				, static_cast<double>(alt)
+				};
+		}
+
+	}; // Solver
+
+	//! Altitude and (absolute) latitude limits of an evaluation band
+	struct Band
+	{
+		std::string theName{};
+		peri::sim::Range theAltRange{};
+		peri::sim::Range theParRange{}; //!< absolute value (both hemispheres)
+		std::vector<peri::XYZ> theXyzs{};
+		std::vector<peri::LPA> theRefLpas{};
+
+	}; // Band
+
+	//! Sample locations and reference solutions for band
+	Band
+	bandFor
+		( std::string const & name
+		, peri::sim::Range const & altRange
+		, peri::sim::Range const & parRange
+		, peri::EarthModel const & earth
+		)
+	{
+		using namespace peri::sim;
+		std::vector<double> const lonSamps{ bulkSamplesLon(32u) };
+		std::vector<double> parSamps
+			{ samplesAccordingTo(SampleSpec(17u, parRange)) };
+		std::vector<double> const parNegs
+			{ samplesAccordingTo
+				(SampleSpec(17u, Range{ -parRange.second, -parRange.first }))
+			};
+		parSamps.insert(parSamps.end(), parNegs.cbegin(), parNegs.cend());
+		std::vector<double> const altSamps
+			{ samplesAccordingTo(SampleSpec(9u, altRange)) };
+		std::vector<peri::LPA> const lpas
+			{ comboSamplesLpa(lonSamps, parSamps, altSamps) };
+
+		// (many) more Newton steps than needed for full convergence
+		Solver<long double> const refSolver
+			(earth.theEllip.theShapeOrig, Seed::Sphere, 16u);
+		Band band{ name, altRange, parRange, {}, {} };
+		band.theXyzs.reserve(lpas.size());
+		band.theRefLpas.reserve(lpas.size());
+		for (peri::LPA const & lpa : lpas)
+		{
+			peri::XYZ const xyz{ peri::xyzForLpa(lpa, earth) };
+			band.theXyzs.emplace_back(xyz);
+			band.theRefLpas.emplace_back(refSolver.lpaFor(xyz));
+		}
+		return band;
+	}
+
+	//! Error and throughput statistics
+	struct Stats
+	{
+		double theMaxErr{ 0. }; //!< [m]
+		double theSumSqErr{ 0. }; //!< [m^2]
+		std::size_t theCount{ 0u };
+		double theSeconds{ 0. };
+
+		//! Root mean square error [m]
+		inline
+		double
+		rmsErr
+			() const
+		{
+			return std::sqrt(theSumSqErr / static_cast<double>(theCount));
+		}
+
+		//! Points per second
+		inline
+		double
+		throughput
+			() const
+		{
+			return (static_cast<double>(theCount) / theSeconds);
+		}
+
+		//! Combine statistics
+		inline
+		void
+		operator+=
+			( Stats const & other
+			)
+		{
+			theMaxErr = std::max(theMaxErr, other.theMaxErr);
+			theSumSqErr += other.theSumSqErr;
+			theCount += other.theCount;
+			theSeconds += other.theSeconds;
+		}
+
+	}; // Stats
+
+	//! Combined linear error [m] (arc at equatorial radius and altitude)
+	inline
+	double
+	linearErr
+		( peri::LPA const & got
+		, peri::LPA const & exp
+		, double const & radA
+		)
+	{
+		double const difLon
+			{ std::cos(exp[1]) * peri::principalAngle(got[0] - exp[0]) };
+		double const difPar{ got[1] - exp[1] };
+		double const difAlt{ got[2] - exp[2] };
+		return std::sqrt
+			(peri::sq(radA*difLon) + peri::sq(radA*difPar) + peri::sq(difAlt));
+	}
+
+	//! Statistics for solver applied to band
+	template <typename Real>
+	Stats
+	statsFor
+		( Solver<Real> const & solver
+		, Band const & band
+		, double const & radA
+		)
+	{
+		Stats stats{};
+		std::vector<peri::LPA> gotLpas(band.theXyzs.size());
+		double bestTime{ std::numeric_limits<double>::max() };
+		for (std::size_t run{0u} ; run < 3u ; ++run)
+		{
+			using namespace std::chrono;
+			steady_clock::time_point const t0{ steady_clock::now() };
+			std::transform
+				( band.theXyzs.cbegin(), band.theXyzs.cend()
+				, gotLpas.begin()
+				, [&solver] (peri::XYZ const & xyz)
+					{ return solver.lpaFor(xyz); }
+				);
+			steady_clock::time_point const t1{ steady_clock::now() };
+			duration<double> const delta{ t1 - t0 };
+			bestTime = std::min(bestTime, delta.count());
+		}
+		stats.theSeconds = bestTime;
+		for (std::size_t nn{0u} ; nn < gotLpas.size() ; ++nn)
+		{
+			double const err{ linearErr(gotLpas[nn], band.theRefLpas[nn], radA) };
+			stats.theMaxErr = std::max(stats.theMaxErr, err);
+			stats.theSumSqErr += err*err;
+			++stats.theCount;
+		}
+		return stats;
+	}
+
+	//! Configuration description and associated results
+	struct Config
+	{
+		std::string theType{};
+		Seed theSeed{};
+		std::size_t theNumIter{};
+		std::vector<Stats> theBandStats{};
+		Stats theAllStats{};
+		bool theIsPareto{ false };
+
+		//! Short descriptive name
+		inline
+		std::string
+		name
+			() const
+		{
+			std::ostringstream oss;
+			oss << theType << "/" << nameFor(theSeed) << "/";
+			if (0u < theNumIter)
+			{
+				oss << "iter" << theNumIter;
+			}
+			else
+			{
+				oss << "conv";
+			}
+			return oss.str();
+		}
+
+	}; // Config
+
+	//! Evaluate solver configuration for all bands
+	template <typename Real>
+	Config
+	configFor
+		( std::string const & typeName
+		, Seed const & seed
+		, std::size_t const & numIter
+		, std::vector<Band> const & bands
+		, peri::Shape const & shape
+		)
+	{
+		Solver<Real> const solver(shape, seed, numIter);
+		Config config{ typeName, seed, numIter, {}, {}, false };
+		for (Band const & band : bands)
+		{
+			Stats const stats{ statsFor(solver, band, shape.theRadA) };
+			config.theBandStats.emplace_back(stats);
+			config.theAllStats += stats;
+		}
+		return config;
+	}
+
+	//! Mark configurations not dominated in (throughput, maxErr)
+	void
+	markPareto
+		( std::vector<Config> * const & ptConfigs
+		)
+	{
+		std::vector<Config> & configs = *ptConfigs;
+		for (Config & config : configs)
+		{
+			Stats const & curr = config.theAllStats;
+			bool dominated{ false };
+			for (Config const & other : configs)
+			{
+				Stats const & test = other.theAllStats;
+				bool const noWorse
+					{  (! (test.throughput() < curr.throughput()))
+					&& (! (curr.theMaxErr < test.theMaxErr))
+					};
+				bool const better
+					{  (curr.throughput() < test.throughput())
+					|| (test.theMaxErr < curr.theMaxErr)
+					};
+				if (noWorse && better)
+				{
+					dominated = true;
+					break;
+				}
+			}
+			config.theIsPareto = (! dominated);
+		}
+	}
+
+	//! Table of per-band statistics
+	std::string
+	bandInfo
+		( std::vector<Config> const & configs
+		, std::vector<Band> const & bands
+		)
+	{
+		std::ostringstream oss;
+		oss << std::endl;
+		oss << "# Per band: maxErr[m] rmsErr[m] Mpts/s" << '\n';
+		for (std::size_t nb{0u} ; nb < bands.size() ; ++nb)
+		{
+			Band const & band = bands[nb];
+			oss << std::endl;
+			oss << "# Band: " << band.theName
+				<< "  numSamps: " << band.theXyzs.size()
+				<< '\n';
+			for (Config const & config : configs)
+			{
+				Stats const & stats = config.theBandStats[nb];
+				oss << std::setw(28u) << config.name()
+					<< std::scientific << std::setprecision(2)
+					<< std::setw(12u) << stats.theMaxErr
+					<< std::setw(12u) << stats.rmsErr()
+					<< std::fixed << std::setprecision(2)
+					<< std::setw(10u) << (1.e-6 * stats.throughput())
+					<< '\n';
+			}
+		}
+		return oss.str();
+	}
+
+	//! Pareto table (overall statistics, sorted by throughput)
+	std::string
+	paretoInfo
+		( std::vector<Config> configs
+		)
+	{
+		std::sort
+			( configs.begin(), configs.end()
+			, [] (Config const & cA, Config const & cB)
+				{ return (cB.theAllStats.throughput() < cA.theAllStats.throughput()); }
+			);
+		std::ostringstream oss;
+		oss << std::endl;
+		oss << "# Overall (all bands) - '*' marks Pareto frontier" << '\n';
+		oss << "#"
+			<< std::setw(29u) << "config"
+			<< std::setw(12u) << "maxErr[m]"
+			<< std::setw(12u) << "rmsErr[m]"
+			<< std::setw(10u) << "Mpts/s"
+			<< '\n';
+		for (Config const & config : configs)
+		{
+			Stats const & stats = config.theAllStats;
+			oss << (config.theIsPareto ? " *" : "  ")
+				<< std::setw(28u) << config.name()
+				<< std::scientific << std::setprecision(2)
+				<< std::setw(12u) << stats.theMaxErr
+				<< std::setw(12u) << stats.rmsErr()
+				<< std::fixed << std::setprecision(2)
+				<< std::setw(10u) << (1.e-6 * stats.throughput())
+				<< '\n';
+		}
+		return oss.str();
+	}
+
+	//! Save data for plotting (ref plotPareto.plt)
+	void
+	savePlotData
+		( std::vector<Config> const & configs
+		, std::ostream & ostrm
+		)
+	{
+		ostrm << "# index Mpts/s maxErr rmsErr isPareto name" << '\n';
+		for (std::size_t nn{0u} ; nn < configs.size() ; ++nn)
+		{
+			Config const & config = configs[nn];
+			Stats const & stats = config.theAllStats;
+			ostrm
+				<< std::setw(4u) << nn
+				<< " " << peri::string::allDigits(1.e-6 * stats.throughput())
+				<< " " << peri::string::allDigits(stats.theMaxErr)
+				<< " " << peri::string::allDigits(stats.rmsErr())
+				<< " " << (config.theIsPareto ? 1 : 0)
+				<< " " << config.name()
+				<< '\n';
+		}
+	}
+
+} // [annon]
+
+
+//! Evaluate solver configurations over altitude/latitude bands
+int
+main
+	( int argc
+	, char ** argv
+	)
+{
+	double budget{ peri::sNan };
+	if (1 < argc)
+	{
+		budget = std::atof(argv[1]);
+	}
+
+	peri::EarthModel const & earth = peri::model::WGS84;
+	peri::Shape const & shape = earth.theEllip.theShapeOrig;
+
+	std::cout << "--- setup: " << std::endl;
+
+	using peri::radForDeg;
+	using peri::sim::Range;
+	std::vector<std::pair<std::string, Range> > const altBands
+		{ { "alt[-100,-10]km", Range{ -100.e+3, -10.e+3 } }
+		, { "alt[-10,+10]km", Range{ -10.e+3, 10.e+3 } }
+		, { "alt[+10,+100]km", Range{ 10.e+3, 100.e+3 } }
+		};
+	std::vector<std::pair<std::string, Range> > const parBands
+		{ { "|lat|[0,30]", Range{ radForDeg(0.), radForDeg(30.) } }
+		, { "|lat|[30,60]", Range{ radForDeg(30.), radForDeg(60.) } }
+		, { "|lat|[60,90]", Range{ radForDeg(60.), radForDeg(90.) } }
+		};
+	std::vector<Band> bands;
+	for (std::pair<std::string, Range> const & altBand : altBands)
+	{
+		for (std::pair<std::string, Range> const & parBand : parBands)
+		{
+			std::string const name{ altBand.first + " " + parBand.first };
+			bands.emplace_back
+				(bandFor(name, altBand.second, parBand.second, earth));
+		}
+	}
+
+	std::cout << "--- evaluating: " << std::endl;
+
+	std::vector<Seed> const seeds{ Seed::Sphere, Seed::Radial, Seed::Zero };
+	std::vector<std::size_t> const iters{ 1u, 2u, 3u, 4u, 0u };
+	std::vector<Config> configs;
+	for (Seed const & seed : seeds)
+	{
+		for (std::size_t const & iter : iters)
+		{
+			configs.emplace_back
+				(configFor<float>("float", seed, iter, bands, shape));
+			configs.emplace_back
+				(configFor<double>("double", seed, iter, bands, shape));
+			configs.emplace_back
+				(configFor<long double>("longdbl", seed, iter, bands, shape));
+		}
+	}
+	markPareto(&configs);
+
+	std::cout << "--- reporting: " << std::endl;
+
+	std::ostringstream rpt;
+	rpt << bandInfo(configs, bands);
+	rpt << paretoInfo(configs);
+
+	if (peri::isValid(budget))
+	{
+		Config const * ptBest{ nullptr };
+		for (Config const & config : configs)
+		{
+			Stats const & stats = config.theAllStats;
+			if ( (! (budget < stats.theMaxErr))
+			  && ( (! ptBest)
+			     || (ptBest->theAllStats.throughput() < stats.throughput())
+			     )
+			   )
+			{
+				ptBest = &config;
+			}
+		}
+		rpt << std::endl;
+		rpt << "# Fastest config with maxErr <= "
+			<< std::scientific << std::setprecision(2) << budget << "[m]: "
+			<< (ptBest ? ptBest->name() : std::string("<none>"))
+			<< '\n';
+	}
+
+	std::ofstream ofsPlot("paretoData.dat");
+	savePlotData(configs, ofsPlot);
+	rpt << std::endl;
+	rpt << "# Plot data saved to: paretoData.dat (ref plotPareto.plt)" << '\n';
+
+	std::cout << rpt.str() << std::endl;
+
+	return 0;
+}
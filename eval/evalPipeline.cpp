@@ -0,0 +1,179 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Compare throughput of fused pipeline with stage-by-stage passes.
+ *
+ * Multi-pass evaluation applies each stage to the entire data set
+ * (with intermediate arrays) before starting the next stage, whereas
+ * the fused pipeline applies all stages to each point in turn.
+ */
+
+
+#include "periPipeline.h"
+
+#include "evalTiming.h"
+#include "periSim.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	// (global values: e.g. ENU [mm] and offset lon [1e-7 deg] exceed int32)
+	using Ints = std::array<std::int64_t, 3u>;
+	using Triple = peri::pipeline::Triple;
+
+	//! Apply stage to all values (one pass through memory)
+	template <typename Stage, typename InType, typename OutType>
+	inline
+	void
+	pass
+		( Stage const & stage
+		, std::vector<InType> const & ins
+		, std::vector<OutType> * const & ptOuts
+		)
+	{
+		std::vector<OutType> & outs = *ptOuts;
+		for (std::size_t nn{0u} ; nn < ins.size() ; ++nn)
+		{
+			outs[nn] = stage(ins[nn]);
+		}
+	}
+
+	//! Report line for timing comparison
+	inline
+	std::string
+	infoString
+		( std::string const & name
+		, std::size_t const & numPnts
+		, double const & secFused
+		, double const & secMulti
+		)
+	{
+		std::ostringstream oss;
+		oss << std::setw(24) << name
+			<< "  fused[Mpt/s]: " << std::fixed << std::setprecision(2)
+				<< std::setw(8) << (1.e-6 * double(numPnts) / secFused)
+			<< "  multi[Mpt/s]: "
+				<< std::setw(8) << (1.e-6 * double(numPnts) / secMulti)
+			<< "  speedup: " << std::setprecision(3)
+				<< (secMulti / secFused)
+			;
+		return oss.str();
+	}
+
+} // [annon]
+
+
+//! Compare fused (single pass) and multi-pass pipeline evaluation
+int
+main
+	()
+{
+	using namespace peri::pipeline;
+	peri::EarthModel const & earth = peri::model::WGS84;
+
+	// several million points (~100 MB per intermediate array)
+	std::vector<peri::LPA> const lpas
+		{ peri::sim::bulkSamplesLpa(256u, 128u, 128u) };
+	std::size_t const numPnts{ lpas.size() };
+	std::vector<peri::XYZ> xyzs(numPnts);
+	peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data(), earth);
+
+	Helmert const datum
+		( Triple{{ -0.991, 1.9072, 0.5129 }}
+		, Triple{{ 1.25033e-7, 4.6785e-8, 5.6529e-8 }}
+		, 0.
+		);
+	Geodetic const geodetic(earth);
+	Offset const tile(Triple{{ 1., .5, 0. }});
+	Quantize<std::int64_t> const quantLpa
+		(peri::batch::FixedScale::lpaDegE7Mm());
+	LocalEnu const enu(peri::LPA{{ 1., .5, 0. }}, earth);
+	Quantize<std::int64_t> const quantEnu
+		(peri::batch::FixedScale::xyzMm());
+
+	std::vector<Triple> tmpA(numPnts);
+	std::vector<Triple> tmpB(numPnts);
+	std::vector<Ints> outs(numPnts);
+
+	std::cout << "# numPnts: " << numPnts << '\n';
+
+	// datum -> geodetic -> tile offset -> quantize
+	{
+		auto const pipe{ make(datum, geodetic, tile, quantLpa) };
+		double const secFused
+			{ eval::bestTimeOf
+				([&] () { pipe.run(xyzs.data(), numPnts, outs.data()); })
+			};
+		double const secMulti
+			{ eval::bestTimeOf
+				([&] ()
+					{
+						pass(datum, xyzs, &tmpA);
+						pass(geodetic, tmpA, &tmpB);
+						pass(tile, tmpB, &tmpA);
+						pass(quantLpa, tmpA, &outs);
+					}
+				)
+			};
+		std::cout << infoString("datum/geodetic/tile", numPnts
+			, secFused, secMulti) << '\n';
+	}
+
+	// datum -> local ENU -> quantize (memory bound stages only)
+	{
+		auto const pipe{ make(datum, enu, quantEnu) };
+		double const secFused
+			{ eval::bestTimeOf
+				([&] () { pipe.run(xyzs.data(), numPnts, outs.data()); })
+			};
+		double const secMulti
+			{ eval::bestTimeOf
+				([&] ()
+					{
+						pass(datum, xyzs, &tmpA);
+						pass(enu, tmpA, &tmpB);
+						pass(quantEnu, tmpB, &outs);
+					}
+				)
+			};
+		std::cout << infoString("datum/enu", numPnts
+			, secFused, secMulti) << '\n';
+	}
+
+	return 0;
+}
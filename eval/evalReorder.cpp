@@ -0,0 +1,172 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Assess when locality reordering (Morton key) pays off.
+ *
+ * Compares throughput of plain batch conversion with warm started
+ * conversion in the given order and with Morton reordered (warm
+ * started) conversion (including the key computation and sort) for
+ * several spatial distributions of input data.
+ */
+
+
+#include "periReorder.h"
+
+#include "periBatch.h"
+#include "evalTiming.h"
+#include "periSim.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Cartesian locations for lpas generated in random order
+	inline
+	std::vector<peri::XYZ>
+	xyzsFor
+		( peri::sim::RandomGen const & gen
+		)
+	{
+		std::size_t const numPnts{ gen.size() };
+		std::vector<peri::LPA> lpas(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			lpas[nn] = gen.valueAt(nn);
+		}
+		std::vector<peri::XYZ> xyzs(numPnts);
+		peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data());
+		return xyzs;
+	}
+
+	//! Time and report each conversion approach for xyzs
+	inline
+	std::string
+	infoString
+		( std::string const & name
+		, std::vector<peri::XYZ> const & xyzs
+		)
+	{
+		std::size_t const numPnts{ xyzs.size() };
+		std::vector<peri::LPA> lpas(numPnts);
+		double const secBatch
+			{ eval::bestTimeOf
+				([&] ()
+					{ peri::batch::lpaForXyz(xyzs.data(), numPnts, lpas.data()); }
+				)
+			};
+		double const secWarm
+			{ eval::bestTimeOf
+				([&] ()
+					{ peri::reorder::lpaForXyzWarm
+						(xyzs.data(), numPnts, lpas.data());
+					}
+				)
+			};
+		double const secReord
+			{ eval::bestTimeOf
+				([&] ()
+					{ peri::reorder::lpaForXyzReordered
+						(xyzs.data(), numPnts, lpas.data());
+					}
+				)
+			};
+		double const scale{ 1.e-6 * double(numPnts) };
+		std::ostringstream oss;
+		oss << std::setw(20) << name
+			<< std::fixed << std::setprecision(2)
+			<< "  batch[Mpt/s]: " << std::setw(7) << (scale / secBatch)
+			<< "  warm[Mpt/s]: " << std::setw(7) << (scale / secWarm)
+			<< "  reordered[Mpt/s]: " << std::setw(7) << (scale / secReord)
+			<< "  speedup: " << std::setprecision(3) << (secBatch / secReord)
+			;
+		return oss.str();
+	}
+
+} // [annon]
+
+
+//! Compare batch, warm started, and Morton reordered conversions
+int
+main
+	()
+{
+	std::size_t const numPnts{ 1u << 20u };
+	std::cout << "# numPnts: " << numPnts << '\n';
+
+	// global scatter (neighbors in key order still far apart)
+	std::cout << infoString
+		( "global"
+		, xyzsFor(peri::sim::RandomGen
+			{ numPnts, 17u, peri::sim::sRangeLon, peri::sim::sRangePar })
+		) << '\n';
+
+	// regional scatter (~100 km area, flight altitudes)
+	std::cout << infoString
+		( "regional"
+		, xyzsFor(peri::sim::RandomGen
+			{ numPnts, 19u, { 1., 1.015 }, { .5, .515 }, { 0., 1.e+4 } })
+		) << '\n';
+
+	// tile scatter (~1 km lidar tile)
+	std::cout << infoString
+		( "tile"
+		, xyzsFor(peri::sim::RandomGen
+			{ numPnts, 23u, { 1., 1.00015 }, { .5, .50015 }, { 0., 100. } })
+		) << '\n';
+
+	// scan ordered tile (already coherent, reordering is overhead)
+	{
+		std::vector<peri::LPA> lpas;
+		lpas.reserve(numPnts);
+		for (std::size_t nr{0u} ; nr < 1024u ; ++nr)
+		{
+			for (std::size_t nc{0u} ; nc < (numPnts / 1024u) ; ++nc)
+			{
+				lpas.emplace_back(peri::LPA
+					{ 1. + 1.5e-7 * double(nc)
+					, .5 + 1.5e-7 * double(nr)
+					, 50. + double(nc % 7u)
+					});
+			}
+		}
+		std::vector<peri::XYZ> xyzs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), xyzs.data());
+		std::cout << infoString("scan ordered", xyzs) << '\n';
+	}
+
+	return 0;
+}
+
@@ -34,7 +34,6 @@
 
 #include <algorithm>
 #include <chrono>
-#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -45,53 +44,55 @@ namespace eval
 
 	static peri::EarthModel const sEarth{ peri::model::WGS84 };
 
-	//! Convert collection of LPAs into XYZs
-	inline
-	std::vector<peri::XYZ>
-	xyzsFor
-		( std::vector<peri::LPA> const & lpas
-		)
-	{
-		std::vector<peri::XYZ> xyzs;
-		xyzs.reserve(lpas.size());
-		for (peri::LPA const & lpa : lpas)
-		{
-			xyzs.emplace_back(sEarth.xyzForLpa(lpa));
-		}
-		return xyzs;
-	}
+	//! Number of samples generated (and transformed) at once
+	constexpr std::size_t sChunkSize{ 1u << 14u };
 
-	//! A complete data set of pre-computed values
-	struct DataSet
+	//! basic support for simple 'wall-clock' style timing
+	namespace timer
 	{
-		std::vector<peri::LPA> const theLpas;
-		std::vector<peri::XYZ> const theXyzs;
+		using namespace std::chrono;
 
-		inline
-		explicit
-		DataSet
-			( std::size_t const & numLon
-			, std::size_t const & numPar
-			, std::size_t const & numAlt
-			)
-			: theLpas{ peri::sim::bulkSamplesLpa(numLon, numPar, numAlt) }
-			, theXyzs{ xyzsFor(theLpas) }
-		{
-		}
+		static high_resolution_clock sClock{};
 
-		inline
-		std::size_t
-		size
-			() const
+		//! Utilize std::chrono to get simple timing information
+		struct ChronoAboration
 		{
-			return theLpas.size();
-		}
+			time_point<high_resolution_clock, high_resolution_clock::duration>
+				theT0{};
+			time_point<high_resolution_clock, high_resolution_clock::duration>
+				theT1{};
 
-	}; // DataSet
+			void
+			start
+				()
+			{
+				theT0 = sClock.now();
+			}
+
+			void
+			stop
+				()
+			{
+				theT1 = sClock.now();
+			}
 
-	//! A pre-allocated (upon construction) workspace
+			//! Time between t0 and t1 in seconds
+			double
+			elapsed
+				() const
+			{
+				duration<double> const delta{ theT1 - theT0 };
+				return delta.count();
+			}
+
+		}; // ChronoAboration
+
+	} // [timer]
+
+	//! A pre-allocated (upon construction) workspace for one chunk
 	struct WorkSpace
 	{
+		std::vector<Array> theInputs{};
 		std::vector<Array> theSpace{};
 
 		inline
@@ -99,36 +100,41 @@ namespace eval
 		WorkSpace
 			( std::size_t const & size
 			)
-			: theSpace{}
+			: theInputs(size)
+			, theSpace(size)
 		{ 
-			// ensure workspace is preallocated
-			theSpace.reserve(size);
-		}
-
-		std::insert_iterator<std::vector<Array> >
-		insert_iterator
-			()
-		{
-			return std::insert_iterator(theSpace, theSpace.begin());
 		}
 
-
 	}; // WorkSpace
 
-	//! A group of transformations useful for speed evaluation
+	/*! \brief A group of transformations useful for speed evaluation
+	 *
+	 * Samples are generated a chunk at a time (ref peri::sim::forEachChunk)
+	 * into a fixed workspace, so memory use is constant regardless of the
+	 * number of samples. Only the transformation of each chunk is timed.
+	 */
 	struct Transformer
 	{
-		DataSet theDataSet;
+		peri::sim::GridGen theGen;
 		WorkSpace theWorkSpace;
 
 		inline
 		explicit
 		Transformer
-			( DataSet const & dataSet
+			( peri::sim::GridGen const & gen
 			)
-			: theDataSet{ dataSet }
-			, theWorkSpace(theDataSet.size())
+			: theGen{ gen }
+			, theWorkSpace(sChunkSize)
+		{
+		}
+
+		//! Total number of samples transformed by each test
+		inline
+		std::size_t
+		size
+			() const
 		{
+			return theGen.size();
 		}
 
 		// should optimize away, e.g. for timing only data loop/move overhead
@@ -198,134 +204,102 @@ namespace eval
 			return peri::lpaForXyz(xyz, sEarth);
 		}
 
-		//! Perform reference computations
+		//! Time (in sec) to transform all (Cartesian if useXyz) samples
 		template <typename Func>
 		inline
-		void
+		double
 		run
-			( std::vector<Array> const & locData
+			( bool const & useXyz
 			, Func const & func
 			)
 		{
-			std::transform
-				( locData.cbegin()
-				, locData.cend()
-				, theWorkSpace.insert_iterator()
-				, func
+			double sumTime{ 0. };
+			std::vector<Array> & inputs = theWorkSpace.theInputs;
+			std::vector<Array> & outputs = theWorkSpace.theSpace;
+			peri::sim::forEachChunk
+				( theGen, sChunkSize
+				, [&]
+					( peri::LPA const * const samps
+					, std::size_t const & num
+					, std::size_t const & // beg
+					)
+					{
+						// prepare input values (not timed)
+						for (std::size_t nn{0u} ; nn < num ; ++nn)
+						{
+							inputs[nn] = (useXyz)
+								? sEarth.xyzForLpa(samps[nn])
+								: samps[nn];
+						}
+						// reuse (preallocated) workspace for each chunk
+						timer::ChronoAboration timer{};
+						timer.start();
+						std::transform
+							( inputs.cbegin()
+							, inputs.cbegin() + num
+							, outputs.begin()
+							, func
+							);
+						timer.stop();
+						sumTime += timer.elapsed();
+					}
 				);
+			return sumTime;
 		}
 
 		//! Run simple copy operation ('compute' should be optimized away)
 		inline
-		void
+		double
 		runCpy
 			()
 		{
-			run(theDataSet.theXyzs, funcCpy);
+			return run(true, funcCpy);
 		}
 
 		//! Perform simple multiplication on every element
 		inline
-		void
+		double
 		runMul
 			()
 		{
-			run(theDataSet.theXyzs, funcMul);
+			return run(true, funcMul);
 		}
 
 		//! Perform square root (of abs()) on every element
 		inline
-		void
+		double
 		runSqt
 			()
 		{
-			run(theDataSet.theXyzs, funcSqt);
+			return run(true, funcSqt);
 		}
 
 		//! Perform (easy) forward computations
 		inline
-		void
+		double
 		runXyz
 			()
 		{
-			run(theDataSet.theLpas, funcXyz);
+			return run(false, funcXyz);
 		}
 
 		//! Perform (complex) inverse computations
 		inline
-		void
+		double
 		runLpa
 			()
 		{
-			run(theDataSet.theXyzs, funcLpa);
+			return run(true, funcLpa);
 		}
 
 	}; // Transformer
 
-	//! basic support for simple 'wall-clock' style timing
-	namespace timer
-	{
-		using namespace std::chrono;
-
-		static high_resolution_clock sClock{};
-
-		//! Utilize std::chrono to get simple timing information
-		struct ChronoAboration
-		{
-			time_point<high_resolution_clock, high_resolution_clock::duration>
-				theT0{};
-			time_point<high_resolution_clock, high_resolution_clock::duration>
-				theT1{};
-
-			void
-			start
-				()
-			{
-				theT0 = sClock.now();
-			}
-
-			void
-			stop
-				()
-			{
-				theT1 = sClock.now();
-			}
-
-			//! Time between t0 and t1 in seconds
-			double
-			elapsed
-				() const
-			{
-				duration<double> const delta{ theT1 - theT0 };
-				return delta.count();
-			}
-
-		}; // ChronoAboration
-
-	} // [timer]
-
-	
 } // [eval]
 
 
 namespace report
 {
 
-	//! Return time (in sec) to run func()
-	template <typename Func>
-	inline
-	double
-	runTimeFor
-		( Func const & func
-		)
-	{
-		eval::timer::ChronoAboration timer{};
-		timer.start();
-		func();
-		timer.stop();
-		return timer.elapsed();
-	}
-
 	//! Consistently formatted time representation
 	std::string
 	timeString
@@ -454,18 +428,10 @@ main
 
 	std::cout << "--- setup: " << std::endl;
 
-	// allocate data with pre-set values in both domains
-	eval::DataSet const data(numLon, numPar, numAlt);
-	std::size_t const numSamps{ data.size() };
-	// allocate fixed workspace for available transformations
-	eval::Transformer xformer(data);
-
-	using Func_t = std::function<void(void)>;
-	Func_t const funcCpy{ std::bind(&eval::Transformer::runCpy, xformer) };
-	Func_t const funcMul{ std::bind(&eval::Transformer::runMul, xformer) };
-	Func_t const funcSqt{ std::bind(&eval::Transformer::runSqt, xformer) };
-	Func_t const funcXyz{ std::bind(&eval::Transformer::runXyz, xformer) };
-	Func_t const funcLpa{ std::bind(&eval::Transformer::runLpa, xformer) };
+	// generate data in fixed size chunks (constant memory use)
+	eval::Transformer xformer
+		(peri::sim::GridGen::bulk(numLon, numPar, numAlt));
+	std::size_t const numSamps{ xformer.size() };
 
 	std::string const nameCpy{ "Reference evaluation - copy: " };
 	std::string const nameMul{ "Reference evaluation - multiply: " };
@@ -474,11 +440,11 @@ main
 	std::string const nameLpa{ "Geodetic from Cartesian - lpaForXyz(): " };
 
 	// run each computation test and note (wall) time it takes
-	double const timeCpy{ report::runTimeFor(funcCpy) };
-	double const timeMul{ report::runTimeFor(funcMul) };
-	double const timeSqt{ report::runTimeFor(funcSqt) };
-	double const timeXyz{ report::runTimeFor(funcXyz) };
-	double const timeLpa{ report::runTimeFor(funcLpa) };
+	double const timeCpy{ xformer.runCpy() };
+	double const timeMul{ xformer.runMul() };
+	double const timeSqt{ xformer.runSqt() };
+	double const timeXyz{ xformer.runXyz() };
+	double const timeLpa{ xformer.runLpa() };
 
 	// gather results for use in reporting
 	std::vector<report::TimeName> const allTimeNames
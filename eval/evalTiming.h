@@ -0,0 +1,70 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef peri_evalTiming_INCL_
+#define peri_evalTiming_INCL_
+
+
+/*! \file
+ * \brief Timing utilities shared by evaluation programs.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+
+namespace eval
+{
+	//! Fastest [sec] of several evaluations of func()
+	template <typename Func>
+	inline
+	double
+	bestTimeOf
+		( Func const & func
+		, std::size_t const & numTrials = 5u
+		)
+	{
+		double best{ std::numeric_limits<double>::max() };
+		for (std::size_t nt{0u} ; nt < numTrials ; ++nt)
+		{
+			std::chrono::steady_clock::time_point const t0
+				{ std::chrono::steady_clock::now() };
+			func();
+			std::chrono::duration<double> const dur
+				{ std::chrono::steady_clock::now() - t0 };
+			best = std::min(best, dur.count());
+		}
+		return best;
+	}
+
+} // [eval]
+
+#endif // peri_evalTiming_INCL_
@@ -0,0 +1,24 @@
+
+set title "Inverse solver configurations: accuracy vs speed"
+
+unset mouse
+set logscale y
+set format y "%.0e"
+set grid
+
+set xlabel "throughput [Mpts/s]"
+set ylabel "max error [m]"
+
+# columns: index Mpts/s maxErr rmsErr isPareto name
+plot \
+	  'paretoData.dat' u 2:3 \
+		w p pt 6 ps .75 \
+		lc "gray" ti "all configs" \
+	, 'paretoData.dat' u 2:($5 > 0 ? $3 : 1/0) \
+		w p pt 5 ps 1.0 \
+		lc "red" ti "Pareto frontier" \
+	, 'paretoData.dat' u 2:($5 > 0 ? $3 : 1/0):6 \
+		w labels left offset 1,0 font ",8" notitle \
+	;
+pause -1;
+
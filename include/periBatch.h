@@ -0,0 +1,506 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#ifndef periBatch_INCL_
+#define periBatch_INCL_
+
+
+#include "peridetic.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+
+/*! \brief Transformation of many locations with a single call.
+ *
+ * Functions operate on caller supplied (pre-allocated) storage and
+ * perform no heap allocation.
+ *
+ * E.g.:
+ * \code
+ * std::vector<peri::XYZ> const xyzs{ ... };
+ * std::vector<peri::LPA> lpas(xyzs.size());
+ * peri::batch::lpaForXyz(xyzs.data(), xyzs.size(), lpas.data());
+ * \endcode
+ */
+namespace peri
+{
+namespace batch
+{
+	/*! \brief Geodetic coordinates for each of numPnts Cartesian locations.
+	 *
+	 * Equivalent to calling peri::lpaForXyz() for each element.
+	 * Input and output ranges must not overlap (unless identical).
+	 */
+	inline
+	void
+	lpaForXyz
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, LPA * const lpas
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::lpaForXyz", numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			lpas[nn] = earthModel.lpaForXyz(xyzs[nn]);
+		}
+	}
+
+	/*! \brief Cartesian coordinates for each of numPnts Geodetic locations.
+	 *
+	 * Equivalent to calling peri::xyzForLpa() for each element.
+	 * Input and output ranges must not overlap (unless identical).
+	 */
+	inline
+	void
+	xyzForLpa
+		( LPA const * const lpas
+			//!< Start of numPnts Geodetic locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, XYZ * const xyzs
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::xyzForLpa", numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			xyzs[nn] = earthModel.xyzForLpa(lpas[nn]);
+		}
+	}
+
+	/*! \brief Geodetic coordinates with respect to two Earth models.
+	 *
+	 * Equivalent (to within a few ulps) to batch::lpaForXyz() for each
+	 * model, but in a single pass in which only the solver start value is
+	 * shared: the second model's solver starts from the (rescaled) first
+	 * model solution. For similar ellipsoids (e.g. WGS84 and GRS80 differ
+	 * by about 0.1[mm]) a single Newton step then suffices for the second
+	 * solution. The remaining work (normalization, point on ellipsoid and
+	 * angles) is repeated for each model, such that the combined cost is
+	 * about 1.4 times that of one conversion, compared with 2 times for
+	 * separate conversions (ref eval/evalMultiModel).
+	 *
+	 * Input and output ranges must not overlap.
+	 */
+	inline
+	void
+	lpaForXyzPair
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, LPA * const lpasA
+			//!< Start of space for numPnts results w.r.t. earthModelA
+		, LPA * const lpasB
+			//!< Start of space for numPnts results w.r.t. earthModelB
+		, EarthModel const & earthModelA = model::WGS84
+		, EarthModel const & earthModelB = model::GRS80
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::lpaForXyzPair", numPnts);
+		double const lambdaA{ earthModelA.theEllip.lambdaOrig() };
+		double const lambdaB{ earthModelB.theEllip.lambdaOrig() };
+		// normalized (model A) to normalized (model B) scale
+		double const ratio{ lambdaA / lambdaB };
+		// sigma values scale with square of normalization
+		double const ratioSq{ ratio * ratio };
+		// (quadratic convergence) after step smaller than this, error
+		// is well below tolerance used by the EarthModel solver iteration
+		constexpr double tolStep{ 1.e-8 };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			double sigmaNormA{ sNan }; // start from sphere approximation
+			lpasA[nn] = earthModelA.lpaForXyzFrom(xyzs[nn], &sigmaNormA);
+			// one Newton step from (close) seed, iterate only if step is large
+			double sigmaNormB{ ratioSq * sigmaNormA };
+			lpasB[nn] = earthModelB.lpaForXyzFrom
+				(xyzs[nn], &sigmaNormB, tolStep);
+		}
+	}
+
+	/*! \brief Geodetic coordinates for Cartesian values within records.
+	 *
+	 * Each input record holds three consecutive doubles (x,y,z) starting
+	 * at xyzBase + nn*xyzStride bytes, and the output (lon,par,alt) is
+	 * stored at lpaBase + nn*lpaStride. E.g. to transform a field of an
+	 * array of structures (in place) without gather/scatter copies:
+	 * \code
+	 * struct Rec { float intensity; XYZ loc; double time; };
+	 * std::vector<Rec> recs{ ... };
+	 * peri::batch::lpaForXyzStrided
+	 * 	( &(recs[0].loc), sizeof(Rec), recs.size()
+	 * 	, &(recs[0].loc), sizeof(Rec)
+	 * 	);
+	 * \endcode
+	 *
+	 * Values are copied through memcpy and need not be aligned. Input and
+	 * output records must not overlap (unless identical).
+	 */
+	inline
+	void
+	lpaForXyzStrided
+		( void const * const xyzBase
+			//!< Location of first (x,y,z) triple
+		, std::size_t const & xyzStride
+			//!< Number of bytes between consecutive input triples
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, void * const lpaBase
+			//!< Location for first (lon,par,alt) result
+		, std::size_t const & lpaStride
+			//!< Number of bytes between consecutive output triples
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::lpaForXyzStrided", numPnts);
+		unsigned char const * const inBytes
+			{ static_cast<unsigned char const *>(xyzBase) };
+		unsigned char * const outBytes{ static_cast<unsigned char *>(lpaBase) };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			XYZ xyz;
+			std::memcpy(xyz.data(), inBytes + nn*xyzStride, sizeof(xyz));
+			LPA const lpa{ earthModel.lpaForXyz(xyz) };
+			std::memcpy(outBytes + nn*lpaStride, lpa.data(), sizeof(lpa));
+		}
+	}
+
+	/*! \brief Cartesian coordinates for Geodetic values within records.
+	 *
+	 * Each input record holds three consecutive doubles (lon,par,alt)
+	 * starting at lpaBase + nn*lpaStride bytes, and the output (x,y,z)
+	 * is stored at xyzBase + nn*xyzStride. Ref lpaForXyzStrided().
+	 */
+	inline
+	void
+	xyzForLpaStrided
+		( void const * const lpaBase
+			//!< Location of first (lon,par,alt) triple
+		, std::size_t const & lpaStride
+			//!< Number of bytes between consecutive input triples
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, void * const xyzBase
+			//!< Location for first (x,y,z) result
+		, std::size_t const & xyzStride
+			//!< Number of bytes between consecutive output triples
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::xyzForLpaStrided", numPnts);
+		unsigned char const * const inBytes
+			{ static_cast<unsigned char const *>(lpaBase) };
+		unsigned char * const outBytes{ static_cast<unsigned char *>(xyzBase) };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			LPA lpa;
+			std::memcpy(lpa.data(), inBytes + nn*lpaStride, sizeof(lpa));
+			XYZ const xyz{ earthModel.xyzForLpa(lpa) };
+			std::memcpy(outBytes + nn*xyzStride, xyz.data(), sizeof(xyz));
+		}
+	}
+
+	/*! \brief Scale and offset relating integer values to coordinates.
+	 *
+	 * Coordinate value for component k is:
+	 * \code
+	 * value[k] = theOffsets[k] + theScales[k] * double(intValue[k])
+	 * \endcode
+	 * with units [m] for Cartesian and for altitude and [rad] for angles.
+	 */
+	struct FixedScale
+	{
+		std::array<double, 3u> theScales;
+		std::array<double, 3u> theOffsets;
+
+		//! Common GNSS/point cloud layout: angles in 1e-7 [deg], alt [mm]
+		inline
+		static
+		FixedScale
+		lpaDegE7Mm  // FixedScale::
+			()
+		{
+			double const radPerDegE7{ sRadPerDeg * 1.e-7 };
+			return FixedScale
+				{ {{ radPerDegE7, radPerDegE7, 1.e-3 }}
+				, {{ 0., 0., 0. }}
+				};
+		}
+
+		//! Cartesian values in [mm] relative to (optional) origin [m]
+		inline
+		static
+		FixedScale
+		xyzMm  // FixedScale::
+			( XYZ const & origin = {{ 0., 0., 0. }}
+			)
+		{
+			return FixedScale{ {{ 1.e-3, 1.e-3, 1.e-3 }}, origin };
+		}
+
+	}; // FixedScale
+
+	/*! \brief Geodetic for Cartesian locations with integer (fixed point)
+	 * values for both input and output.
+	 *
+	 * Input and output are packed triples of IntType (e.g. std::int32_t)
+	 * interpreted via xyzFix and lpaFix respectively. Scale and offset
+	 * factors are folded into the (normalized unit) computation constants
+	 * so no intermediate double arrays are formed. Output values are
+	 * rounded to nearest integer (results must be representable).
+	 */
+	template <typename IntType>
+	inline
+	void
+	lpaForXyzFixed
+		( IntType const * const xyzInts
+			//!< Start of 3*numPnts integers (x,y,z)
+		, FixedScale const & xyzFix
+			//!< Interpretation of input integers
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, IntType * const lpaInts
+			//!< Start of space for 3*numPnts integers (lon,par,alt)
+		, FixedScale const & lpaFix
+			//!< Encoding of output integers
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::lpaForXyzFixed", numPnts);
+		// input: normalized = offset/lambda + (scale/lambda)*int
+		double const lambda{ earthModel.theEllip.lambdaOrig() };
+		std::array<double, 3u> const inScls
+			{{ xyzFix.theScales[0] / lambda
+			,  xyzFix.theScales[1] / lambda
+			,  xyzFix.theScales[2] / lambda
+			}};
+		std::array<double, 3u> const inOffs
+			{{ xyzFix.theOffsets[0] / lambda
+			,  xyzFix.theOffsets[1] / lambda
+			,  xyzFix.theOffsets[2] / lambda
+			}};
+		// output: int = value*(1/scale) - offset/scale (alt incl lambda)
+		std::array<double, 3u> const outScls
+			{{ 1. / lpaFix.theScales[0]
+			,  1. / lpaFix.theScales[1]
+			,  lambda / lpaFix.theScales[2]
+			}};
+		std::array<double, 3u> const outOffs
+			{{ lpaFix.theOffsets[0] / lpaFix.theScales[0]
+			,  lpaFix.theOffsets[1] / lpaFix.theScales[1]
+			,  lpaFix.theOffsets[2] / lpaFix.theScales[2]
+			}};
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			IntType const * const inInts{ xyzInts + 3u*nn };
+			XYZ const xVecNorm
+				{{ inOffs[0] + inScls[0] * static_cast<double>(inInts[0])
+				,  inOffs[1] + inScls[1] * static_cast<double>(inInts[1])
+				,  inOffs[2] + inScls[2] * static_cast<double>(inInts[2])
+				}};
+			LPA const lpaNorm{ earthModel.lpaNormForXyzNorm(xVecNorm) };
+			IntType * const outInts{ lpaInts + 3u*nn };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				outInts[nc] = static_cast<IntType>
+					(std::llround(outScls[nc] * lpaNorm[nc] - outOffs[nc]));
+			}
+		}
+	}
+
+	/*! \brief Cartesian for Geodetic locations with integer (fixed point)
+	 * values for both input and output.
+	 *
+	 * Ref lpaForXyzFixed() - e.g. for int32 lon/lat in 1e-7 [deg] and
+	 * height in [mm] to int32 ECEF [mm] relative to a local origin:
+	 * \code
+	 * peri::batch::xyzForLpaFixed
+	 * 	( lpaInts.data(), FixedScale::lpaDegE7Mm(), numPnts
+	 * 	, xyzInts.data(), FixedScale::xyzMm(origin)
+	 * 	);
+	 * \endcode
+	 */
+	template <typename IntType>
+	inline
+	void
+	xyzForLpaFixed
+		( IntType const * const lpaInts
+			//!< Start of 3*numPnts integers (lon,par,alt)
+		, FixedScale const & lpaFix
+			//!< Interpretation of input integers
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, IntType * const xyzInts
+			//!< Start of space for 3*numPnts integers (x,y,z)
+		, FixedScale const & xyzFix
+			//!< Encoding of output integers
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::xyzForLpaFixed", numPnts);
+		// output: int = (lambda*mu/scale)/sqrt(sum) + alt/scale)*up - off/scale
+		std::array<double, 3u> const & muSqs
+			= earthModel.theEllip.theShapeNorm.theMuSqs;
+		double const lambda{ earthModel.theEllip.lambdaOrig() };
+		std::array<double, 3u> const invScls
+			{{ 1. / xyzFix.theScales[0]
+			,  1. / xyzFix.theScales[1]
+			,  1. / xyzFix.theScales[2]
+			}};
+		std::array<double, 3u> const muScls
+			{{ lambda * muSqs[0] * invScls[0]
+			,  lambda * muSqs[1] * invScls[1]
+			,  lambda * muSqs[2] * invScls[2]
+			}};
+		std::array<double, 3u> const outOffs
+			{{ xyzFix.theOffsets[0] * invScls[0]
+			,  xyzFix.theOffsets[1] * invScls[1]
+			,  xyzFix.theOffsets[2] * invScls[2]
+			}};
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			IntType const * const inInts{ lpaInts + 3u*nn };
+			LPA const lpa
+				{{ lpaFix.theOffsets[0]
+					+ lpaFix.theScales[0] * static_cast<double>(inInts[0])
+				,  lpaFix.theOffsets[1]
+					+ lpaFix.theScales[1] * static_cast<double>(inInts[1])
+				,  lpaFix.theOffsets[2]
+					+ lpaFix.theScales[2] * static_cast<double>(inInts[2])
+				}};
+			XYZ const up{ upDirAtLpa(lpa) };
+			double const sumMuUpSq
+				{ muSqs[0]*sq(up[0])
+				+ muSqs[1]*sq(up[1])
+				+ muSqs[2]*sq(up[2])
+				};
+			double const invRoot{ 1. / std::sqrt(sumMuUpSq) };
+			IntType * const outInts{ xyzInts + 3u*nn };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				double const value
+					{ (muScls[nc]*invRoot + lpa[2]*invScls[nc]) * up[nc]
+					- outOffs[nc]
+					};
+				outInts[nc] = static_cast<IntType>(std::llround(value));
+			}
+		}
+	}
+
+	/*! \brief Cartesian locations relative to (tile) origin as float32.
+	 *
+	 * For each geodetic location computes (in double precision) the
+	 * Cartesian offset from origin and then rounds the offset to float:
+	 * \code
+	 * relXyzs[3*nn+k] = float(xyzForLpa(lpas[nn])[k] - origin[k])
+	 * \endcode
+	 * Output precision is thus relative to offset magnitude (e.g. better
+	 * than 1 [mm] for offsets up to about 8 [km]) in a single pass.
+	 */
+	inline
+	void
+	xyzForLpaRelative
+		( LPA const * const lpas
+			//!< Start of numPnts Geodetic locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, XYZ const & origin
+			//!< Tile center (double precision) subtracted from results
+		, float * const relXyzs
+			//!< Start of space for 3*numPnts float values (x,y,z)
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::xyzForLpaRelative", numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			XYZ const xyz{ earthModel.xyzForLpa(lpas[nn]) };
+			float * const outs{ relXyzs + 3u*nn };
+			outs[0] = static_cast<float>(xyz[0] - origin[0]);
+			outs[1] = static_cast<float>(xyz[1] - origin[1]);
+			outs[2] = static_cast<float>(xyz[2] - origin[2]);
+		}
+	}
+
+	/*! \brief Cartesian offsets from (tile) origin as float32 high/low pairs.
+	 *
+	 * As xyzForLpaRelative() but each offset component is split into
+	 * (high,low) float values such that high+low (evaluated in double)
+	 * reproduces the double offset to about 48 bits, e.g. for GPU
+	 * "relative to eye" rendering with double emulation:
+	 * \code
+	 * highs[3*nn+k] = float(offset[k])
+	 * lows[3*nn+k] = float(offset[k] - double(highs[3*nn+k]))
+	 * \endcode
+	 */
+	inline
+	void
+	xyzForLpaRelativeSplit
+		( LPA const * const lpas
+			//!< Start of numPnts Geodetic locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, XYZ const & origin
+			//!< Tile center (double precision) subtracted from results
+		, float * const highs
+			//!< Start of space for 3*numPnts (high part) float values
+		, float * const lows
+			//!< Start of space for 3*numPnts (low part) float values
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::batch::xyzForLpaRelativeSplit", numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			XYZ const xyz{ earthModel.xyzForLpa(lpas[nn]) };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				double const offset{ xyz[nc] - origin[nc] };
+				float const high{ static_cast<float>(offset) };
+				highs[3u*nn + nc] = high;
+				lows[3u*nn + nc]
+					= static_cast<float>(offset - static_cast<double>(high));
+			}
+		}
+	}
+
+} // [batch]
+} // [peri]
+
+
+#endif // periBatch_INCL_
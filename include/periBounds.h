@@ -0,0 +1,556 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periBounds_INCL_
+#define periBounds_INCL_
+
+
+/*! \file
+ * \brief Geodetic bounds of (large) collections of Cartesian locations.
+ *
+ * Computes the minimum and maximum of longitude, latitude (par) and
+ * altitude over all points in a point cloud. Rather than converting
+ * every point, inexpensive Cartesian tests identify the points that
+ * could possibly extend the current extremes, and only those candidate
+ * points are fully converted (with peri::lpaForXyz()). E.g.:
+ *
+ * \code
+ * peri::interval::Box const lpaBox
+ * 	{ peri::bounds::lpaBoxFor(xyzs.data(), xyzs.size()).lpaBox() };
+ * \endcode
+ *
+ * The longitude interval is the smaller of the range of longitude values
+ * expressed in [-pi,pi) and in [0,2pi) such that point clouds straddling
+ * the anti-meridian produce a compact interval (with theMax > pi, ref
+ * peri::interval::lonContains()).
+ *
+ * Also provides the (tight) Cartesian axis-aligned box enclosing a
+ * geodetic cell (ref xyzBoxFor(), xyzBoxesFor()).
+ */
+
+
+#include "periInterval.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include <vector>
+
+
+namespace peri
+{
+namespace bounds
+{
+	/*! \brief Accumulation of geodetic extremes (with candidate pruning).
+	 *
+	 * Pruning tests (relative to the current extremes) are:
+	 * \arg Longitude: point is outside of the current longitude wedge(s),
+	 *   evaluated with cross products of horizontal components.
+	 * \arg Latitude: point is on the polar side of the ellipsoid normal
+	 *   line at the current extreme latitude (in the meridian plane the
+	 *   set of points with latitude par is the line
+	 *   z*cos(par) - rho*sin(par) + e^2*N(par)*sin(par)*cos(par) = 0 and,
+	 *   as for peri::interval::lpaBoxForXyzBox(), these lines do not
+	 *   cross outside of the evolute).
+	 * \arg Altitude: bounds on altitude from the distance, t, along the
+	 *   geocentric ray to the ellipsoid. The altitude is no more than t
+	 *   and (outside) no less than t*cos(delta) where delta is the
+	 *   largest angle between geocentric and ellipsoid normal directions
+	 *   (for inside points, a curvature term is added for the bound).
+	 */
+	class Extremes
+	{
+		EarthModel const * theModel{ nullptr };
+		std::size_t theNumPnts{ 0u };
+		std::size_t theNumConverted{ 0u };
+
+		// longitude range in [-pi,pi] (A) and in [0,2pi) (B)
+		interval::Interval theLonA{ 0., 0. };
+		interval::Interval theLonB{ 0., 0. };
+		interval::Interval thePar{ 0., 0. };
+		interval::Interval theAlt{ 0., 0. };
+
+		// ellipsoid constants
+		double theRadASq{ 0. };
+		double theRadBSq{ 0. };
+		double theEccSq{ 0. };
+		double theCosDelta{ 1. };
+		double theRadCurvMin{ 1. };
+
+		// horizontal unit directions at lon range ends: {cos, sin}
+		std::array<double, 2u> theDirLoA{{ 1., 0. }};
+		std::array<double, 2u> theDirHiA{{ 1., 0. }};
+		std::array<double, 2u> theDirLoB{{ 1., 0. }};
+		std::array<double, 2u> theDirHiB{{ 1., 0. }};
+
+		// normal line coefficients {cos(par), sin(par), e^2*N*sin*cos}
+		std::array<double, 3u> theLineParMax{{ 1., 0., 0. }};
+		std::array<double, 3u> theLineParMin{{ 1., 0., 0. }};
+
+		//! Tolerance [m] for cross product and line tests
+		static constexpr double sTolLinear{ 1.e-6 };
+
+		//! Coefficients for the line of constant latitude (ref class doc)
+		inline
+		std::array<double, 3u>
+		lineForPar  // Extremes::
+			( double const & par
+			) const
+		{
+			double const cPar{ std::cos(par) };
+			double const sPar{ std::sin(par) };
+			double const radN
+				{ std::sqrt(theRadASq / (1. - theEccSq * sPar * sPar)) };
+			return {{ cPar, sPar, theEccSq * radN * sPar * cPar }};
+		}
+
+		//! True if horizontal (xx,yy) is within ccw wedge from dirLo to dirHi
+		inline
+		static
+		bool
+		inWedge  // Extremes::
+			( double const & xx
+			, double const & yy
+			, std::array<double, 2u> const & dirLo
+			, std::array<double, 2u> const & dirHi
+			, double const & span
+			)
+		{
+			double const crossLo{ dirLo[0]*yy - dirLo[1]*xx };
+			double const crossHi{ xx*dirHi[1] - yy*dirHi[0] };
+			bool inside{ false };
+			if (span <= sPi)
+			{
+				inside = ((sTolLinear < crossLo) && (sTolLinear < crossHi));
+			}
+			else
+			{
+				inside = ((sTolLinear < crossLo) || (sTolLinear < crossHi));
+			}
+			return inside;
+		}
+
+		//! Update cached test values from current extremes
+		inline
+		void
+		updateTests  // Extremes::
+			()
+		{
+			theDirLoA = {{ std::cos(theLonA.theMin), std::sin(theLonA.theMin) }};
+			theDirHiA = {{ std::cos(theLonA.theMax), std::sin(theLonA.theMax) }};
+			theDirLoB = {{ std::cos(theLonB.theMin), std::sin(theLonB.theMin) }};
+			theDirHiB = {{ std::cos(theLonB.theMax), std::sin(theLonB.theMax) }};
+			theLineParMax = lineForPar(thePar.theMax);
+			theLineParMin = lineForPar(thePar.theMin);
+		}
+
+		//! Include geodetic location into extremes
+		inline
+		void
+		includeLpa  // Extremes::
+			( LPA const & lpa
+			)
+		{
+			double const & lonA = lpa[0];
+			double const lonB{ (lonA < 0.) ? (lonA + sTwoPi) : lonA };
+			if (0u == theNumConverted)
+			{
+				theLonA = interval::Interval{ lonA, lonA };
+				theLonB = interval::Interval{ lonB, lonB };
+				thePar = interval::Interval{ lpa[1], lpa[1] };
+				theAlt = interval::Interval{ lpa[2], lpa[2] };
+			}
+			else
+			{
+				theLonA.theMin = std::min(theLonA.theMin, lonA);
+				theLonA.theMax = std::max(theLonA.theMax, lonA);
+				theLonB.theMin = std::min(theLonB.theMin, lonB);
+				theLonB.theMax = std::max(theLonB.theMax, lonB);
+				thePar.theMin = std::min(thePar.theMin, lpa[1]);
+				thePar.theMax = std::max(thePar.theMax, lpa[1]);
+				theAlt.theMin = std::min(theAlt.theMin, lpa[2]);
+				theAlt.theMax = std::max(theAlt.theMax, lpa[2]);
+			}
+			++theNumConverted;
+			updateTests();
+		}
+
+		//! True if xyz could extend any of the current extremes
+		inline
+		bool
+		isCandidate  // Extremes::
+			( XYZ const & xyz
+			) const
+		{
+			double const & xx = xyz[0];
+			double const & yy = xyz[1];
+			double const & zz = xyz[2];
+			double const rhoSq{ xx*xx + yy*yy };
+			double const rho{ std::sqrt(rhoSq) };
+
+			// latitude: above (below) normal line at max (min) latitude
+			double const distMax
+				{ zz*theLineParMax[0] - rho*theLineParMax[1] + theLineParMax[2] };
+			double const distMin
+				{ zz*theLineParMin[0] - rho*theLineParMin[1] + theLineParMin[2] };
+			bool candidate{ (-sTolLinear < distMax) || (distMin < sTolLinear) };
+
+			// altitude: bounds from geocentric ray distance to ellipsoid
+			if (! candidate)
+			{
+				double const radSq{ rhoSq + zz*zz };
+				double const rad{ std::sqrt(radSq) };
+				double const radEll
+					{ std::sqrt
+						( (theRadASq * theRadBSq * radSq)
+						/ (theRadBSq * rhoSq + theRadASq * zz*zz)
+						)
+					};
+				double const tt{ rad - radEll };
+				double altLo{ tt };
+				double altHi{ tt };
+				if (0. <= tt)
+				{
+					altLo = tt * theCosDelta;
+				}
+				else
+				{
+					altHi = tt * theCosDelta + (tt*tt / theRadCurvMin);
+				}
+				candidate =
+					(  (theAlt.theMax < altHi + sTolLinear)
+					|| (altLo - sTolLinear < theAlt.theMin)
+					);
+			}
+
+			// longitude: outside of either wedge
+			if (! candidate)
+			{
+				candidate =
+					(! (  inWedge
+							(xx, yy, theDirLoA, theDirHiA, theLonA.magnitude())
+					   && inWedge
+							(xx, yy, theDirLoB, theDirHiB, theLonB.magnitude())
+					   ));
+			}
+			return candidate;
+		}
+
+	public:
+
+		//! Empty accumulation (no points yet)
+		Extremes
+			() = default;
+
+		//! Empty accumulation for use with earth model (must outlive this)
+		inline
+		explicit
+		Extremes  // Extremes::
+			( EarthModel const & earthModel
+			)
+			: theModel{ &earthModel }
+		{
+			Shape const & shape = earthModel.theEllip.theShapeOrig;
+			theRadASq = shape.theRadA * shape.theRadA;
+			theRadBSq = shape.theRadB * shape.theRadB;
+			theEccSq = 1. - (theRadBSq / theRadASq);
+			// largest angle between geocentric and normal directions
+			double const tanDelta
+				{ (theRadASq - theRadBSq) / (2. * shape.theRadA * shape.theRadB) };
+			theCosDelta = 1. / std::sqrt(1. + tanDelta*tanDelta);
+			theRadCurvMin = theRadBSq / shape.theRadA;
+		}
+
+		//! Include location (converted only if a candidate extreme)
+		inline
+		void
+		add  // Extremes::
+			( XYZ const & xyz
+			)
+		{
+			if ((0u == theNumConverted) || isCandidate(xyz))
+			{
+				includeLpa(theModel->lpaForXyz(xyz));
+			}
+			++theNumPnts;
+		}
+
+		//! Include extremes from other accumulation (e.g. other thread)
+		inline
+		void
+		merge  // Extremes::
+			( Extremes const & other
+			)
+		{
+			if (0u == theNumConverted)
+			{
+				theLonA = other.theLonA;
+				theLonB = other.theLonB;
+				thePar = other.thePar;
+				theAlt = other.theAlt;
+			}
+			else
+			if (0u < other.theNumConverted)
+			{
+				theLonA.theMin = std::min(theLonA.theMin, other.theLonA.theMin);
+				theLonA.theMax = std::max(theLonA.theMax, other.theLonA.theMax);
+				theLonB.theMin = std::min(theLonB.theMin, other.theLonB.theMin);
+				theLonB.theMax = std::max(theLonB.theMax, other.theLonB.theMax);
+				thePar.theMin = std::min(thePar.theMin, other.thePar.theMin);
+				thePar.theMax = std::max(thePar.theMax, other.thePar.theMax);
+				theAlt.theMin = std::min(theAlt.theMin, other.theAlt.theMin);
+				theAlt.theMax = std::max(theAlt.theMax, other.theAlt.theMax);
+			}
+			theNumConverted += other.theNumConverted;
+			updateTests();
+			theNumPnts += other.theNumPnts;
+		}
+
+		//! Number of points included
+		inline
+		std::size_t
+		numPoints  // Extremes::
+			() const
+		{
+			return theNumPnts;
+		}
+
+		//! Number of points that were fully converted to geodetic
+		inline
+		std::size_t
+		numConverted  // Extremes::
+			() const
+		{
+			return theNumConverted;
+		}
+
+		//! Geodetic extremes: (lon, par, alt) ranges (NaN if no points)
+		inline
+		interval::Box
+		lpaBox  // Extremes::
+			() const
+		{
+			interval::Box box
+				{{ interval::Interval{ sNan, sNan }
+				,  interval::Interval{ sNan, sNan }
+				,  interval::Interval{ sNan, sNan }
+				}};
+			if (0u < theNumConverted)
+			{
+				interval::Interval lon{ theLonA };
+				if (theLonB.magnitude() < theLonA.magnitude())
+				{
+					lon = theLonB;
+					if (sPi <= lon.theMin)
+					{
+						lon.theMin -= sTwoPi;
+						lon.theMax -= sTwoPi;
+					}
+				}
+				box = interval::Box{{ lon, thePar, theAlt }};
+			}
+			return box;
+		}
+
+	}; // Extremes
+
+	/*! \brief Geodetic extremes of numPnts Cartesian locations.
+	 *
+	 * Locations are partitioned into contiguous blocks that are reduced
+	 * by separate threads (the calling thread handles the first block)
+	 * after which the block results are merged.
+	 */
+	inline
+	Extremes
+	lpaBoxFor
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations
+		, EarthModel const & earthModel = model::WGS84
+			//!< Ellipsoid (must outlive return value)
+		, std::size_t const & numThreads = std::thread::hardware_concurrency()
+			//!< Number of threads to use (including calling thread)
+		)
+	{
+		std::size_t const minPerThread{ 4096u };
+		std::size_t const numUse
+			{ std::max
+				( std::size_t{ 1u }
+				, std::min(numThreads, numPnts / minPerThread)
+				)
+			};
+		std::vector<Extremes> parts(numUse, Extremes(earthModel));
+		auto const reduce
+			{ [&] (std::size_t const part)
+				{
+					std::size_t const beg{ (part * numPnts) / numUse };
+					std::size_t const end{ ((part + 1u) * numPnts) / numUse };
+					Extremes & extremes = parts[part];
+					for (std::size_t nn{beg} ; nn < end ; ++nn)
+					{
+						extremes.add(xyzs[nn]);
+					}
+				}
+			};
+		std::vector<std::thread> threads;
+		threads.reserve(numUse);
+		for (std::size_t part{1u} ; part < numUse ; ++part)
+		{
+			threads.emplace_back(reduce, part);
+		}
+		reduce(0u);
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+		for (std::size_t part{1u} ; part < numUse ; ++part)
+		{
+			parts[0].merge(parts[part]);
+		}
+		return parts[0];
+	}
+
+	/*! \brief Tight Cartesian axis-aligned box enclosing a geodetic cell.
+	 *
+	 * The cell comprises all locations with lon, par and alt values in
+	 * the respective lpaCell intervals (lon may wrap, ref periInterval.h,
+	 * and the alt interval minimum should be well above -6000[km]).
+	 *
+	 * In the meridian plane, with ellipsoid normal radius of curvature
+	 * N(par), location components are:
+	 * \arg rho = (N + alt)*cos(par) - increasing with alt and decreasing
+	 *   with magnitude of par.
+	 * \arg z = (N*b^2/a^2 + alt)*sin(par) - increasing with par and
+	 *   increasing with alt magnitude (with sign of par).
+	 *
+	 * such that the extremes of rho and z occur at the corners of the
+	 * (par,alt) interval pair or on the equator (if spanned by the cell).
+	 * The x and y extremes are products of the rho extremes with the
+	 * extremes of cos(lon) and sin(lon), which include interior values
+	 * (+/-1) where the cell spans longitudes 0, 90, 180 or 270 [deg].
+	 * Results are padded outward by interval::sPadLinear.
+	 */
+	inline
+	interval::Box
+	xyzBoxFor
+		( interval::Box const & lpaCell
+			//!< Geodetic cell: lon, par (latitude) and alt intervals
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		interval::Interval const & parRange = lpaCell[1];
+		interval::Interval const & altRange = lpaCell[2];
+		Shape const & shape = earthModel.theEllip.theShapeOrig;
+		double const radASq{ shape.theRadA * shape.theRadA };
+		double const radBSq{ shape.theRadB * shape.theRadB };
+
+		// meridian plane location for (par, alt)
+		auto const rhoZFor
+			{ [&] (double const & par, double const & alt)
+				{
+					double const cPar{ std::cos(par) };
+					double const sPar{ std::sin(par) };
+					double const radN
+						{ radASq
+						/ std::sqrt(radASq*cPar*cPar + radBSq*sPar*sPar)
+						};
+					return std::array<double, 2u>
+						{{ (radN + alt) * cPar
+						,  ((radBSq / radASq) * radN + alt) * sPar
+						}};
+				}
+			};
+
+		// rho: largest nearest equator (and highest), smallest most polar
+		double const parNear
+			{ std::min(std::max(0., parRange.theMin), parRange.theMax) };
+		double const parFar
+			{ (std::abs(parRange.theMax) < std::abs(parRange.theMin))
+			? parRange.theMin : parRange.theMax
+			};
+		double const rhoMax{ rhoZFor(parNear, altRange.theMax)[0] };
+		double const rhoMin{ rhoZFor(parFar, altRange.theMin)[0] };
+
+		// z: extremes at par range ends (alt per hemisphere)
+		double const zMax
+			{ rhoZFor
+				( parRange.theMax
+				, (0. <= parRange.theMax) ? altRange.theMax : altRange.theMin
+				)[1]
+			};
+		double const zMin
+			{ rhoZFor
+				( parRange.theMin
+				, (0. <= parRange.theMin) ? altRange.theMin : altRange.theMax
+				)[1]
+			};
+
+		// x,y: products of independent rho and cos/sin(lon) ranges
+		interval::Interval const cosLon{ interval::cosOf(lpaCell[0]) };
+		interval::Interval const sinLon{ interval::sinOf(lpaCell[0]) };
+		interval::Interval const rhoRange{ rhoMin, rhoMax };
+
+		return interval::Box
+			{{ interval::padded(rhoRange * cosLon, interval::sPadLinear)
+			,  interval::padded(rhoRange * sinLon, interval::sPadLinear)
+			,  interval::padded
+				(interval::Interval{ zMin, zMax }, interval::sPadLinear)
+			}};
+	}
+
+	//! Cartesian boxes for each of numCells geodetic cells (ref xyzBoxFor())
+	inline
+	void
+	xyzBoxesFor
+		( interval::Box const * const lpaCells
+			//!< Start of numCells geodetic cells
+		, std::size_t const & numCells
+			//!< Number of cells
+		, interval::Box * const xyzBoxes
+			//!< Start of space for numCells results
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::bounds::xyzBoxesFor", numCells);
+		for (std::size_t nn{0u} ; nn < numCells ; ++nn)
+		{
+			xyzBoxes[nn] = xyzBoxFor(lpaCells[nn], earthModel);
+		}
+	}
+
+} // [bounds]
+} // [peri]
+
+
+#endif // periBounds_INCL_
@@ -0,0 +1,390 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periCache_INCL_
+#define periCache_INCL_
+
+
+/*! \file
+ * \brief Bounded thread-safe memoization of transformation results.
+ *
+ * Useful when the same (e.g. station or control point) locations are
+ * converted many times interleaved with unique (e.g. rover) locations.
+ * Entries are keyed on the exact bit pattern of the input coordinates
+ * together with the Earth model shape (so that results for different
+ * models, or for inputs differing in any bit, are never confused).
+ *
+ * Storage is a fixed size open addressing table (probes limited to a
+ * small window; a full window overwrites one of its entries). Each slot
+ * is guarded by a sequence counter so that lookups are lock-free and
+ * never block on stores (stores that find a slot busy are skipped).
+ */
+
+
+#include "peridetic.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+
+namespace peri
+{
+namespace cache
+{
+	//! Exact bit pattern of value
+	inline
+	std::uint64_t
+	bitsOf
+		( double const & value
+		)
+	{
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	//! Value with bit pattern
+	inline
+	double
+	valueOf
+		( std::uint64_t const & bits
+		)
+	{
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	//! Hit and miss counts (ref Memo::stats())
+	struct Stats
+	{
+		std::uint64_t theNumHits;
+		std::uint64_t theNumMisses;
+	};
+
+	/*! \brief Fixed capacity table of transformation results.
+	 *
+	 * Separate tables are used for each transformation direction.
+	 * Functions may be called concurrently from any number of threads.
+	 */
+	class Memo
+	{
+		//! Number of words in key (model radA, model radB, 3 coordinates)
+		static constexpr std::size_t sNumKey{ 5u };
+
+		//! Entry storage (all words atomic so that races are well defined)
+		struct Slot
+		{
+			//! Sequence counter: odd while entry is being written
+			std::atomic<std::uint64_t> theSeq{ 0u };
+			//! Key words followed by result coordinate words
+			std::atomic<std::uint64_t> theWords[sNumKey + 3u];
+		};
+
+		//! One table of slots
+		struct Table
+		{
+			std::unique_ptr<Slot[]> theSlots;
+			std::size_t theMask;
+		};
+
+		//! Number of consecutive slots searched for each key
+		static constexpr std::size_t sNumProbe{ 4u };
+
+		//! Results for Cartesian inputs (i.e. geodetic values)
+		Table theXyzTable;
+
+		//! Results for geodetic inputs (i.e. Cartesian values)
+		Table theLpaTable;
+
+		//! Usage counters
+		mutable std::atomic<std::uint64_t> theNumHits{ 0u };
+		mutable std::atomic<std::uint64_t> theNumMisses{ 0u };
+
+		//! Table with (power of two) capacity at least numSlots
+		inline
+		static
+		Table
+		tableFor  // Memo::
+			( std::size_t const & numSlots
+			)
+		{
+			std::size_t size{ sNumProbe };
+			while (size < numSlots)
+			{
+				size <<= 1u;
+			}
+			std::unique_ptr<Slot[]> slots(new Slot[size]);
+			for (std::size_t ns{0u} ; ns < size ; ++ns)
+			{
+				for (std::atomic<std::uint64_t> & word : slots[ns].theWords)
+				{
+					word.store(0u, std::memory_order_relaxed);
+				}
+			}
+			return Table{ std::move(slots), size - 1u };
+		}
+
+		//! Key words for input coordinates and model
+		inline
+		static
+		std::array<std::uint64_t, sNumKey>
+		keyFor  // Memo::
+			( std::array<double, 3u> const & coords
+			, EarthModel const & earthModel
+			)
+		{
+			Shape const & shape = earthModel.theEllip.theShapeOrig;
+			return std::array<std::uint64_t, sNumKey>
+				{{ bitsOf(shape.theRadA), bitsOf(shape.theRadB)
+				 , bitsOf(coords[0]), bitsOf(coords[1]), bitsOf(coords[2])
+				}};
+		}
+
+		//! Hash of key words (independent products, one final mixing)
+		inline
+		static
+		std::uint64_t
+		hashFor  // Memo::
+			( std::array<std::uint64_t, sNumKey> const & key
+			)
+		{
+			std::uint64_t hash
+				{ (key[0] ^ (key[1] << 1u))
+				+ key[2] * 0x9e3779b97f4a7c15u
+				+ key[3] * 0xbf58476d1ce4e5b9u
+				+ key[4] * 0x94d049bb133111ebu
+				};
+			hash = (hash ^ (hash >> 30u)) * 0xbf58476d1ce4e5b9u;
+			hash = (hash ^ (hash >> 27u)) * 0x94d049bb133111ebu;
+			return (hash ^ (hash >> 31u));
+		}
+
+		//! True (and set *ptResult) if key is present in table
+		inline
+		bool
+		find  // Memo::
+			( Table const & table
+			, std::array<std::uint64_t, sNumKey> const & key
+			, std::uint64_t const & hash
+			, std::array<double, 3u> * const & ptResult
+			) const
+		{
+			for (std::size_t np{0u} ; np < sNumProbe ; ++np)
+			{
+				Slot const & slot = table.theSlots[(hash + np) & table.theMask];
+				std::uint64_t const seq0
+					{ slot.theSeq.load(std::memory_order_acquire) };
+				if ((0u == seq0) || (0u != (seq0 & 1u)))
+				{
+					continue; // empty or being written
+				}
+				std::uint64_t words[sNumKey + 3u];
+				for (std::size_t nw{0u} ; nw < (sNumKey + 3u) ; ++nw)
+				{
+					words[nw] = slot.theWords[nw].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (! (seq0 == slot.theSeq.load(std::memory_order_relaxed)))
+				{
+					continue; // overwritten while reading
+				}
+				bool match{ true };
+				for (std::size_t nw{0u} ; match && (nw < sNumKey) ; ++nw)
+				{
+					match = (key[nw] == words[nw]);
+				}
+				if (match)
+				{
+					*ptResult = std::array<double, 3u>
+						{{ valueOf(words[sNumKey + 0u])
+						 , valueOf(words[sNumKey + 1u])
+						 , valueOf(words[sNumKey + 2u])
+						}};
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//! Store result (skipped if the target slot is busy)
+		inline
+		void
+		store  // Memo::
+			( Table * const & ptTable
+			, std::array<std::uint64_t, sNumKey> const & key
+			, std::uint64_t const & hash
+			, std::array<double, 3u> const & result
+			)
+		{
+			// first empty slot in probe window, else evict (by hash bits)
+			std::size_t ndx
+				{ (hash + ((hash >> 32u) % sNumProbe)) & ptTable->theMask };
+			for (std::size_t np{0u} ; np < sNumProbe ; ++np)
+			{
+				std::size_t const ndxProbe{ (hash + np) & ptTable->theMask };
+				if (0u == ptTable->theSlots[ndxProbe].theSeq.load
+					(std::memory_order_relaxed))
+				{
+					ndx = ndxProbe;
+					break;
+				}
+			}
+			Slot & slot = ptTable->theSlots[ndx];
+
+			// claim slot for writing (odd sequence), skip if busy
+			std::uint64_t seq{ slot.theSeq.load(std::memory_order_relaxed) };
+			if ((0u != (seq & 1u)) || (! slot.theSeq.compare_exchange_strong
+				(seq, seq + 1u, std::memory_order_acquire)))
+			{
+				return;
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+			for (std::size_t nw{0u} ; nw < sNumKey ; ++nw)
+			{
+				slot.theWords[nw].store(key[nw], std::memory_order_relaxed);
+			}
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				slot.theWords[sNumKey + nc].store
+					(bitsOf(result[nc]), std::memory_order_relaxed);
+			}
+			slot.theSeq.store(seq + 2u, std::memory_order_release);
+		}
+
+		//! Cached result if available, else compute with func and store
+		template <typename OutType, typename InType, typename Func>
+		inline
+		OutType
+		lookup  // Memo::
+			( Table * const & ptTable
+			, InType const & coords
+			, EarthModel const & earthModel
+			, Func const & func
+			)
+		{
+			std::array<std::uint64_t, sNumKey> const key
+				{ keyFor(coords, earthModel) };
+			std::uint64_t const hash{ hashFor(key) };
+			std::array<double, 3u> result;
+			if (find(*ptTable, key, hash, &result))
+			{
+				theNumHits.fetch_add(1u, std::memory_order_relaxed);
+				return OutType{ result };
+			}
+			theNumMisses.fetch_add(1u, std::memory_order_relaxed);
+			OutType const out{ func(coords, earthModel) };
+			store(ptTable, key, hash, out);
+			return out;
+		}
+
+	public:
+
+		//! Tables holding (about) numEntries results for each direction
+		inline
+		explicit
+		Memo  // Memo::
+			( std::size_t const & numEntries = 4096u
+			)
+			: theXyzTable{ tableFor(numEntries) }
+			, theLpaTable{ tableFor(numEntries) }
+		{ }
+
+		//! Number of entries that can be held per direction
+		inline
+		std::size_t
+		capacity  // Memo::
+			() const
+		{
+			return (theXyzTable.theMask + 1u);
+		}
+
+		//! Geodetic for Cartesian location (cached as peri::lpaForXyz())
+		inline
+		LPA
+		lpaForXyz  // Memo::
+			( XYZ const & xyz
+			, EarthModel const & earthModel = model::WGS84
+			)
+		{
+			return lookup<LPA>
+				( &theXyzTable, xyz, earthModel
+				, [] (XYZ const & xyzIn, EarthModel const & model)
+					{ return peri::lpaForXyz(xyzIn, model); }
+				);
+		}
+
+		//! Cartesian for geodetic location (cached as peri::xyzForLpa())
+		inline
+		XYZ
+		xyzForLpa  // Memo::
+			( LPA const & lpa
+			, EarthModel const & earthModel = model::WGS84
+			)
+		{
+			return lookup<XYZ>
+				( &theLpaTable, lpa, earthModel
+				, [] (LPA const & lpaIn, EarthModel const & model)
+					{ return peri::xyzForLpa(lpaIn, model); }
+				);
+		}
+
+		//! Hit and miss counts since construction (or resetStats())
+		inline
+		Stats
+		stats  // Memo::
+			() const
+		{
+			return Stats
+				{ theNumHits.load(std::memory_order_relaxed)
+				, theNumMisses.load(std::memory_order_relaxed)
+				};
+		}
+
+		//! Zero the hit and miss counters
+		inline
+		void
+		resetStats  // Memo::
+			()
+		{
+			theNumHits.store(0u, std::memory_order_relaxed);
+			theNumMisses.store(0u, std::memory_order_relaxed);
+		}
+
+	}; // Memo
+
+} // [cache]
+} // [peri]
+
+
+#endif // periCache_INCL_
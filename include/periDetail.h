@@ -36,6 +36,18 @@
 #include <numeric>
 
 
+// Optional instrumentation trace points (ref periTrace.h for detail)
+#if defined(PERIDETIC_TRACE)
+#	include "periTrace.h"
+#elif ! defined(PERI_TRACE_MARK)
+	// by default, trace points compile to nothing
+#	define PERI_TRACE_BEG(name, value)
+#	define PERI_TRACE_END(name, value)
+#	define PERI_TRACE_MARK(name, value)
+#	define PERI_TRACE_SCOPE(name, value)
+#endif
+
+
 // utilities
 namespace peri
 {
@@ -45,6 +57,15 @@ namespace peri
 	//! Invalid triplet
 	constexpr std::array<double, 3u> sNull{ sNan, sNan, sNan };
 
+	//! Half turn angle [rad]
+	constexpr double sPi{ 3.14159265358979323846 };
+
+	//! Full turn angle [rad]
+	constexpr double sTwoPi{ 2. * sPi };
+
+	//! Conversion factor from [deg] to [rad]
+	constexpr double sRadPerDeg{ sPi / 180. };
+
 	//! Classic square operation (value times itself)
 	template <typename Type>
 	inline
@@ -174,6 +195,7 @@ namespace peri
 
 
 	//! Geodetic (Lon/Par) angles for local ellipsoid gradient (or up dir)
+	inline
 	std::pair<double, double>
 	anglesLonParOf // Note: units are unimportant since angles are ratios
 		( XYZ const & anyVec
@@ -192,6 +214,10 @@ namespace peri
 		{
 			lon = std::atan2(yy, xx);
 		}
+		else
+		{
+			PERI_TRACE_MARK("peri::anglesLonParOf:polarAxis", 0u);
+		}
 		double const par{ std::atan2(zz, hh) };
 		return { lon, par };
 	}
@@ -556,24 +582,86 @@ namespace peri
 			XYZ const & xVecOrig = xLocXyz;
 			// normalize data values to facilitate stable computation
 			XYZ const xVecNorm{ theEllip.xyzNormFrom(xVecOrig) };
-			// find point, pVec, on ellipsoid closest to world point, xVec
-			XYZ const pVecNorm{ poeNormFor(xVecNorm) };
-			// compute local vertical direction from gradient
-			XYZ const pGrad{ theEllip.theShapeNorm.gradientAt(pVecNorm) };
-			XYZ const pUp{ unit(pGrad) };
-			// compute altitude as directed distance from ellipsoid at pVec
-			double const altNorm{ dot((xVecNorm - pVecNorm), pUp) };
+			LPA const lpaNorm{ lpaNormForXyzNorm(xVecNorm) };
 			// rescale altitude to original units
 			double const lambdaOrig{ theEllip.lambdaOrig() };
-			double const altOrig{ lambdaOrig * altNorm };
-			// find point, pVec, on ellipsoid closest to world point, xVec
-			// extract LP (at A=0.) from vertical direction at pVec
-			std::pair<double, double> const pairLonPar{ anglesLonParOf(pGrad) };
+			double const altOrig{ lambdaOrig * lpaNorm[2] };
 			// angles are invariant to scale (unaffected by normalization)
-			double const & pLonOrig = pairLonPar.first;
-			double const & pParOrig = pairLonPar.second;
-			// return value as combo of LP and A computed results
-			return LPA{ pLonOrig, pParOrig, altOrig };
+			return LPA{ lpaNorm[0], lpaNorm[1], altOrig };
+		}
+
+		/*! \brief Geodetic coordinates with solver started from *ptSigmaNorm.
+		 *
+		 * Supports warm starts, e.g. from the solution at a nearby location.
+		 * On input, *ptSigmaNorm is the starting solver value (the output
+		 * of a previous call) or NaN to start from the sphere approximation
+		 * (as for lpaForXyz()). On output, it is the solved value. Solver
+		 * values are in normalized units (i.e. they scale with the square
+		 * of theEllip.lambdaOrig()).
+		 *
+		 * If the first (Newton) step is smaller than tolStep, then it is
+		 * accepted without further iteration. If iteration from a warm
+		 * start does not converge (e.g. start from a distant location),
+		 * the solution is restarted from the sphere approximation.
+		 */
+		inline
+		LPA
+		lpaForXyzFrom  // EarthModel::
+			( XYZ const & xLocXyz
+				//!< Cartesian location (physical units)
+			, double * const & ptSigmaNorm
+				//!< In: solver start value (or NaN), Out: solved value
+			, double const & tolStep = 0.
+				//!< Accept a single step smaller than this (0: iterate)
+			, bool * const & ptDidIterate = nullptr
+				//!< If not null, set true if more than one step was used
+			) const
+		{
+			XYZ const xVecNorm{ theEllip.xyzNormFrom(xLocXyz) };
+			double sigmaStart{ *ptSigmaNorm };
+			bool const isWarm{ std::isfinite(sigmaStart) };
+			if (! isWarm)
+			{
+				sigmaStart = sigmaNormWrtSphere(xVecNorm);
+			}
+			double sigmaNorm{ nextSigmaNormFor(sigmaStart, xVecNorm) };
+			bool const didIterate
+				{ ! (std::abs(sigmaNorm - sigmaStart) < tolStep) };
+			if (didIterate)
+			{
+				bool converged{ false };
+				sigmaNorm = sigmaNormFrom(xVecNorm, sigmaNorm, &converged);
+				// unsuitable warm start: solve as for lpaForXyz() instead
+				if (isWarm && (! (converged && std::isfinite(sigmaNorm))))
+				{
+					sigmaNorm = sigmaNormFor(xVecNorm);
+				}
+			}
+			LPA const lpaNorm{ lpaNormForSigmaNorm(xVecNorm, sigmaNorm) };
+			*ptSigmaNorm = sigmaNorm;
+			if (ptDidIterate)
+			{
+				*ptDidIterate = didIterate;
+			}
+			// rescale altitude to original units
+			double const lambdaOrig{ theEllip.lambdaOrig() };
+			return LPA{ lpaNorm[0], lpaNorm[1], lambdaOrig * lpaNorm[2] };
+		}
+
+		/*! \brief Geodetic coordinates for normalized Cartesian location.
+		 *
+		 * Input xVecNorm is in normalized units (physical values divided
+		 * by theEllip.lambdaOrig()) and altitude of the returned value is
+		 * also in normalized units. Useful for callers that fold their own
+		 * scale factors (e.g. fixed point data) into the normalization.
+		 */
+		inline
+		LPA
+		lpaNormForXyzNorm  // EarthModel::
+			( XYZ const & xVecNorm
+			) const
+		{
+			return lpaNormForSigmaNorm(xVecNorm, sigmaNormFor(xVecNorm));
 		}
 
 		//! Cartesian coordinates for geodetic location lpa
@@ -647,16 +735,25 @@ namespace peri
 			return nextSigma;
 		}
 
-		//! Refined altitude scale factor at normalized point location xVecNorm
+		/*! \brief Refined altitude scale factor starting from sigmaStart.
+		 *
+		 * The sigmaStart value may be sigmaNormWrtSphere() (as used by
+		 * lpaForXyz()) or a value from a nearby location (warm start, ref
+		 * lpaForXyzFrom()).
+		 */
 		inline
 		double
-		sigmaNormFor  // EarthModel::
+		sigmaNormFrom  // EarthModel::
 			( XYZ const & xVecNorm
+			, double const & sigmaStart
+			, bool * const & ptConverged = nullptr
+				//!< If not null, set true if iteration met tolerance
 			) const
 		{
 			// linearized iteration
-			double sigmaNorm{ sigmaNormWrtSphere(xVecNorm) };
+			double sigmaNorm{ sigmaStart };
 			double currTestVal{ 1. + sigmaNorm };
+			bool converged{ false };
 			// Convergence is extremely quick within operational range
 			// e.g. 3 or 2 iterations typically sufficient
 			constexpr std::size_t nnMax{ 8u };
@@ -668,13 +765,59 @@ namespace peri
 				constexpr double tolDiff{ 1.e-15 };
 				if (std::abs(currTestVal - nextTestVal) < tolDiff)
 				{
+					converged = true;
 					break;
 				}
 				currTestVal = nextTestVal;
+				if ((nnMax - 1u) == nn)
+				{
+					PERI_TRACE_MARK("peri::sigmaNormFrom:nonConvergence", nnMax);
+				}
+			}
+			if (ptConverged)
+			{
+				*ptConverged = converged;
 			}
 			return sigmaNorm;
 		}
 
+		//! Refined altitude scale factor at normalized point location xVecNorm
+		inline
+		double
+		sigmaNormFor  // EarthModel::
+			( XYZ const & xVecNorm
+			) const
+		{
+			return sigmaNormFrom(xVecNorm, sigmaNormWrtSphere(xVecNorm));
+		}
+
+		/*! \brief Geodetic coordinates for normalized location and sigma.
+		 *
+		 * As lpaNormForXyzNorm() but with the (normalized) altitude scale
+		 * factor, sigmaNorm, already solved (e.g. by sigmaNormFrom()).
+		 */
+		inline
+		LPA
+		lpaNormForSigmaNorm  // EarthModel::
+			( XYZ const & xVecNorm
+			, double const & sigmaNorm
+			) const
+		{
+			// find point, pVec, on ellipsoid closest to world point, xVec
+			XYZ const pVecNorm{ poeNormForSigmaNorm(xVecNorm, sigmaNorm) };
+			// compute local vertical direction from gradient
+			XYZ const pGrad{ theEllip.theShapeNorm.gradientAt(pVecNorm) };
+			XYZ const pUp{ unit(pGrad) };
+			// compute altitude as directed distance from ellipsoid at pVec
+			double const altNorm{ dot((xVecNorm - pVecNorm), pUp) };
+			// extract LP (at A=0.) from vertical direction at pVec
+			std::pair<double, double> const pairLonPar{ anglesLonParOf(pGrad) };
+			double const & pLon = pairLonPar.first;
+			double const & pPar = pairLonPar.second;
+			// return value as combo of LP and A computed results
+			return LPA{ pLon, pPar, altNorm };
+		}
+
 		//! Point-on-ellipsoid: pVec = perp projection onto ellipsoid from xVec
 		inline
 		XYZ
@@ -683,7 +826,19 @@ namespace peri
 				//!< Point of interest in normalized coordinates
 			) const
 		{
-			double const sigmaNorm{ sigmaNormFor(xVecNorm) };
+			return poeNormForSigmaNorm(xVecNorm, sigmaNormFor(xVecNorm));
+		}
+
+		//! Point-on-ellipsoid for xVecNorm given (solved) sigma value
+		inline
+		XYZ
+		poeNormForSigmaNorm  // EarthModel::
+			( XYZ const & xVecNorm
+				//!< Point of interest in normalized coordinates
+			, double const & sigmaNorm
+				//!< Altitude scale factor (ref sigmaNormFrom())
+			) const
+		{
 			std::array<double, 3u> const & muSqNorms
 				= theEllip.theShapeNorm.theMuSqs;
 			XYZ const pVecNorm
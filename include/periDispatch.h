@@ -0,0 +1,105 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periDispatch_INCL_
+#define periDispatch_INCL_
+
+
+#include "peridetic.h"
+
+#include <cstddef>
+
+
+/*! \brief Batch transformations from the (optional) compiled library.
+ *
+ * Declarations for the perideticDispatch library (ref ../dispatch).
+ * The header-only peri::batch functions are compiled for whatever
+ * instruction set each consumer selects (e.g. via -march), whereas the
+ * library builds its batch kernels for several x86-64 instruction sets
+ * (AVX-512, AVX2 and the SSE2 baseline) and selects one at program load
+ * time according to the capabilities of the running CPU.
+ *
+ * The kernels evaluate the same operations as peri::batch, arranged in
+ * blocks such that they vectorize (e.g. lpaForXyz() is about 1.5x, 1.9x
+ * and 2x faster than peri::batch for the SSE2, AVX2 and AVX-512 kernels).
+ * The library is compiled without floating point contraction, so results
+ * are identical to peri::batch compiled likewise. A consumer compiling
+ * peri::batch with fused multiply-add contraction (e.g. -march=native)
+ * gets results that differ in the last few bits (ref testDispatch). On
+ * other platforms (or compilers without function multiversioning) the
+ * library contains only the baseline kernels.
+ *
+ * This header is installed only along with the library.
+ *
+ * E.g. (link with peridetic::perideticDispatch):
+ * \code
+ * std::vector<peri::XYZ> const xyzs{ ... };
+ * std::vector<peri::LPA> lpas(xyzs.size());
+ * peri::dispatch::lpaForXyz(xyzs.data(), xyzs.size(), lpas.data());
+ * \endcode
+ */
+namespace peri
+{
+namespace dispatch
+{
+	//! Name of instruction set used by kernels ("avx512f","avx2","default")
+	char const *
+	isaName
+		();
+
+	//! Geodetic coordinates for numPnts locations (ref peri::batch)
+	void
+	lpaForXyz
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, LPA * const lpas
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		);
+
+	//! Cartesian coordinates for numPnts locations (ref peri::batch)
+	void
+	xyzForLpa
+		( LPA const * const lpas
+			//!< Start of numPnts Geodetic locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, XYZ * const xyzs
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		);
+
+} // [dispatch]
+} // [peri]
+
+
+#endif // periDispatch_INCL_
@@ -0,0 +1,257 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periIncrement_INCL_
+#define periIncrement_INCL_
+
+
+/*! \file
+ * \brief Incremental geodetic updates for small changes in location.
+ *
+ * For iterative processes (e.g. bundle adjustment, filter updates) in
+ * which points move by small amounts between evaluations, a State is
+ * kept for each point. Subsequent conversions of the (moved) point
+ * then use the least expensive of:
+ * \arg FirstOrder - Cached Jacobian applied to location change (no
+ *   trigonometric or solver evaluation).
+ * \arg NewtonStep - A single Newton step of the solver starting from
+ *   the cached (sigma) solution.
+ * \arg FullSolve - Iteration to convergence (starting from the cached
+ *   solution).
+ *
+ * for which the estimated error is less than the caller's tolerance.
+ * E.g.:
+ * \code
+ * peri::increment::State state{ peri::increment::stateFor(xyz) };
+ * for (...) // each adjustment iteration
+ * {
+ * 	xyz = ...; // small change
+ * 	peri::LPA const lpa{ peri::increment::lpaForXyz(&state, xyz) };
+ * }
+ * \endcode
+ */
+
+
+#include "peridetic.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+
+namespace peri
+{
+namespace increment
+{
+	//! Evaluation method used for an update
+	enum Method
+	{
+		  FirstOrder = 0 //!< Linear (Jacobian) extrapolation
+		, NewtonStep = 1 //!< One solver step from cached solution
+		, FullSolve = 2 //!< Solver iteration to convergence
+	};
+
+	//! Cached solution and local derivatives at a location
+	struct State
+	{
+		//! Location at which state was evaluated
+		XYZ theXyz;
+		//! Geodetic coordinates of theXyz
+		LPA theLpa;
+		//! Solver altitude scale factor (ref EarthModel::lpaForXyzFrom())
+		double theSigmaNorm;
+		//! Rows: gradients of lon, par and alt with respect to (x,y,z)
+		std::array<XYZ, 3u> theJacobian;
+		//! Smallest radius of curvature relevant to linearization [m]
+		double theRadMin;
+
+	}; // State
+
+	//! State for location xyz with (already) converged solution
+	inline
+	State
+	stateAt
+		( XYZ const & xyz
+		, LPA const & lpa
+		, double const & sigmaNorm
+		, EarthModel const & earthModel
+		)
+	{
+		Shape const & shape = earthModel.theEllip.theShapeOrig;
+		double const eccSq
+			{ 1. - (shape.theRadB * shape.theRadB)
+				/ (shape.theRadA * shape.theRadA)
+			};
+		double const cLon{ std::cos(lpa[0]) };
+		double const sLon{ std::sin(lpa[0]) };
+		double const cPar{ std::cos(lpa[1]) };
+		double const sPar{ std::sin(lpa[1]) };
+		double const & alt = lpa[2];
+		// prime vertical and meridional radii of curvature
+		double const ww{ std::sqrt(1. - eccSq * sPar * sPar) };
+		double const radN{ shape.theRadA / ww };
+		double const radM{ shape.theRadA * (1. - eccSq) / (ww * ww * ww) };
+		double const radLon{ (radN + alt) * cPar }; // distance from axis
+		double const radPar{ radM + alt };
+		return State
+			{ xyz
+			, lpa
+			, sigmaNorm
+			, std::array<XYZ, 3u>
+				{{ XYZ{ -sLon / radLon, cLon / radLon, 0. }
+				,  XYZ{ -sPar*cLon / radPar, -sPar*sLon / radPar, cPar / radPar }
+				,  XYZ{ cPar*cLon, cPar*sLon, sPar }
+				}}
+			, std::min(radLon, radPar)
+			};
+	}
+
+	//! State for location xyz (full conversion)
+	inline
+	State
+	stateFor
+		( XYZ const & xyz
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		double sigmaNorm{ sNan }; // start from sphere approximation
+		LPA const lpa{ earthModel.lpaForXyzFrom(xyz, &sigmaNorm) };
+		return stateAt(xyz, lpa, sigmaNorm, earthModel);
+	}
+
+	/*! \brief Geodetic coordinates of xyz updated from *ptState.
+	 *
+	 * Error estimates (in [m] along the Earth surface) are:
+	 * \arg FirstOrder: (second order terms) |delta|^2 / theRadMin
+	 * \arg NewtonStep: (quadratic convergence) 2*lambda*step^2 with
+	 *   step the (normalized) change in sigma.
+	 *
+	 * The State is refreshed (to xyz) unless FirstOrder is used, such
+	 * that linearization is always about an exactly solved location.
+	 */
+	inline
+	LPA
+	lpaForXyz
+		( State * const & ptState
+			//!< Previous state (updated as needed)
+		, XYZ const & xyz
+			//!< New location (e.g. near ptState->theXyz)
+		, EarthModel const & earthModel = model::WGS84
+			//!< Same model as used to create *ptState
+		, double const & tolLinear = 1.e-6
+			//!< Acceptable error [m] (angles as arc length on surface)
+		, Method * const & ptMethod = nullptr
+			//!< If not null, set to the method used
+		)
+	{
+		State & state = *ptState;
+		LPA lpa;
+		Method method{ FirstOrder };
+		XYZ const delta
+			{ xyz[0] - state.theXyz[0]
+			, xyz[1] - state.theXyz[1]
+			, xyz[2] - state.theXyz[2]
+			};
+		double const errFirst{ dot(delta, delta) / state.theRadMin };
+		if (errFirst < tolLinear)
+		{
+			std::array<XYZ, 3u> const & jac = state.theJacobian;
+			lpa = LPA
+				{ state.theLpa[0] + dot(jac[0], delta)
+				, state.theLpa[1] + dot(jac[1], delta)
+				, state.theLpa[2] + dot(jac[2], delta)
+				};
+			// keep longitude in principal range
+			if (sPi < lpa[0])
+			{
+				lpa[0] -= sTwoPi;
+			}
+			else
+			if (lpa[0] < -sPi)
+			{
+				lpa[0] += sTwoPi;
+			}
+		}
+		else
+		{
+			// single Newton step suffices if (2*lambda*step^2 < tolLinear)
+			double const lambda{ earthModel.theEllip.lambdaOrig() };
+			double const tolStep{ std::sqrt(.5 * tolLinear / lambda) };
+			double sigmaNorm{ state.theSigmaNorm };
+			bool didIterate{ false };
+			lpa = earthModel.lpaForXyzFrom
+				(xyz, &sigmaNorm, tolStep, &didIterate);
+			method = (didIterate ? FullSolve : NewtonStep);
+			state = stateAt(xyz, lpa, sigmaNorm, earthModel);
+		}
+		if (ptMethod)
+		{
+			*ptMethod = method;
+		}
+		return lpa;
+	}
+
+	/*! \brief Incremental update for each of numPnts locations.
+	 *
+	 * Returns the number of points updated with each Method (indexed
+	 * by Method value).
+	 */
+	inline
+	std::array<std::size_t, 3u>
+	lpaForXyz
+		( State * const & states
+			//!< Start of numPnts states (updated as needed)
+		, XYZ const * const & xyzs
+			//!< Start of numPnts new locations
+		, std::size_t const & numPnts
+			//!< Number of locations
+		, LPA * const & lpas
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		, double const & tolLinear = 1.e-6
+		)
+	{
+		PERI_TRACE_SCOPE("peri::increment::lpaForXyz", numPnts);
+		std::array<std::size_t, 3u> counts{{ 0u, 0u, 0u }};
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			Method method{ FirstOrder };
+			lpas[nn] = lpaForXyz
+				(states + nn, xyzs[nn], earthModel, tolLinear, &method);
+			++counts[method];
+		}
+		return counts;
+	}
+
+} // [increment]
+} // [peri]
+
+
+#endif // periIncrement_INCL_
@@ -0,0 +1,442 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periInterval_INCL_
+#define periInterval_INCL_
+
+
+/*! \file
+ * \brief Conservative transformation of coordinate boxes (intervals).
+ *
+ * Functions transform an axis-aligned box of coordinates (e.g. an
+ * octree node in ECEF) into intervals that contain the transformation
+ * of every point within the box. E.g. for spatial culling:
+ * \code
+ * peri::interval::Box const node{{ {x0, x1}, {y0, y1}, {z0, z1} }};
+ * peri::interval::Box const lpaBox
+ * 	{ peri::interval::lpaBoxForXyzBox(node) };
+ * if (! peri::interval::lonOverlaps(lpaBox[0], queryLon)) { // reject }
+ * \endcode
+ *
+ * Longitude intervals satisfy (-pi <= theMin < pi) and (theMin <= theMax)
+ * but theMax may exceed pi for intervals that wrap across the
+ * anti-meridian (ref lonContains(), lonOverlaps()).
+ *
+ * Results are padded outward (by amounts well below the accuracy of
+ * point transformations) to cover numerical rounding.
+ */
+
+
+#include "peridetic.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+
+namespace peri
+{
+namespace interval
+{
+	//! Closed range of values [theMin, theMax]
+	struct Interval
+	{
+		double theMin;
+		double theMax;
+
+		//! True if value is within range (inclusive)
+		inline
+		bool
+		contains  // Interval::
+			( double const & value
+			) const
+		{
+			return ((theMin <= value) && (value <= theMax));
+		}
+
+		//! True if any value is in both this and other range
+		inline
+		bool
+		overlaps  // Interval::
+			( Interval const & other
+			) const
+		{
+			return ((theMin <= other.theMax) && (other.theMin <= theMax));
+		}
+
+		//! Size of range
+		inline
+		double
+		magnitude  // Interval::
+			() const
+		{
+			return (theMax - theMin);
+		}
+
+	}; // Interval
+
+	//! Axis-aligned box: intervals for (x,y,z) or for (lon,par,alt)
+	typedef std::array<Interval, 3u> Box;
+
+	//! Outward pad applied to angle results [rad]
+	constexpr double sPadAngular{ 1.e-12 };
+
+	//! Outward pad applied to linear results [m]
+	constexpr double sPadLinear{ 1.e-6 };
+
+	//! Interval expanded by pad on each end
+	inline
+	Interval
+	padded
+		( Interval const & range
+		, double const & pad
+		)
+	{
+		return Interval{ range.theMin - pad, range.theMax + pad };
+	}
+
+	//! True if longitude lon (any branch) is within (wrapping) lonRange
+	inline
+	bool
+	lonContains
+		( Interval const & lonRange
+		, double const & lon
+		)
+	{
+		double const delta
+			{ lon - sTwoPi*std::floor((lon - lonRange.theMin) / sTwoPi) };
+		return lonRange.contains(delta) || (sTwoPi <= lonRange.magnitude());
+	}
+
+	//! True if (wrapping) longitude ranges have any values in common
+	inline
+	bool
+	lonOverlaps
+		( Interval const & lonA
+		, Interval const & lonB
+		)
+	{
+		return
+			(  lonContains(lonA, lonB.theMin)
+			|| lonContains(lonB, lonA.theMin)
+			);
+	}
+
+	/*! \brief Range of unit amplitude sinusoid over angles in angRange.
+	 *
+	 * Function values are valBeg, valEnd at the ends of angRange, and
+	 * the function maximum (+1) occurs at angAtMax (modulo 2pi).
+	 */
+	inline
+	Interval
+	sinusoidRange
+		( Interval const & angRange
+		, double const & valBeg
+		, double const & valEnd
+		, double const & angAtMax
+		)
+	{
+		Interval result{ -1., 1. };
+		if (angRange.magnitude() < sTwoPi)
+		{
+			result = Interval{ std::min(valBeg, valEnd), std::max(valBeg, valEnd) };
+			// interior maximum at angAtMax, minimum at (angAtMax + pi)
+			if (std::ceil((angRange.theMin - angAtMax) / sTwoPi)
+				<= std::floor((angRange.theMax - angAtMax) / sTwoPi))
+			{
+				result.theMax = 1.;
+			}
+			double const angAtMin{ angAtMax + sPi };
+			if (std::ceil((angRange.theMin - angAtMin) / sTwoPi)
+				<= std::floor((angRange.theMax - angAtMin) / sTwoPi))
+			{
+				result.theMin = -1.;
+			}
+		}
+		return result;
+	}
+
+	//! Range of cos(angle) over all angles in range (exact extrema)
+	inline
+	Interval
+	cosOf
+		( Interval const & angRange
+		)
+	{
+		return sinusoidRange
+			( angRange
+			, std::cos(angRange.theMin), std::cos(angRange.theMax)
+			, 0.
+			);
+	}
+
+	//! Range of sin(angle) over all angles in range (exact extrema)
+	inline
+	Interval
+	sinOf
+		( Interval const & angRange
+		)
+	{
+		return sinusoidRange
+			( angRange
+			, std::sin(angRange.theMin), std::sin(angRange.theMax)
+			, .5*sPi
+			);
+	}
+
+	//! Range of products of values from each range
+	inline
+	Interval
+	operator*
+		( Interval const & rangeA
+		, Interval const & rangeB
+		)
+	{
+		std::array<double, 4u> const prods
+			{{ rangeA.theMin * rangeB.theMin
+			,  rangeA.theMin * rangeB.theMax
+			,  rangeA.theMax * rangeB.theMin
+			,  rangeA.theMax * rangeB.theMax
+			}};
+		return Interval
+			{ *std::min_element(prods.cbegin(), prods.cend())
+			, *std::max_element(prods.cbegin(), prods.cend())
+			};
+	}
+
+	//! Range of sums of values from each range
+	inline
+	Interval
+	operator+
+		( Interval const & rangeA
+		, Interval const & rangeB
+		)
+	{
+		return Interval
+			{ rangeA.theMin + rangeB.theMin
+			, rangeA.theMax + rangeB.theMax
+			};
+	}
+
+	//! Range of squares of values in range
+	inline
+	Interval
+	sq
+		( Interval const & range
+		)
+	{
+		double const sqMin{ range.theMin * range.theMin };
+		double const sqMax{ range.theMax * range.theMax };
+		Interval result{ std::min(sqMin, sqMax), std::max(sqMin, sqMax) };
+		if (range.contains(0.))
+		{
+			result.theMin = 0.;
+		}
+		return result;
+	}
+
+	/*! \brief Geodetic intervals containing all locations within xyzBox.
+	 *
+	 * Uses the structure of the geodetic relationship within a meridian
+	 * plane, with coordinates (rho,z) where rho=sqrt(x^2+y^2). Outside
+	 * of the ellipsoid evolute (i.e. for all locations more than about
+	 * 50[km] from Earth center) the ShapeClosure merit function has a
+	 * single relevant root such that lines of constant latitude (the
+	 * ellipsoid normals) do not intersect. Thereby:
+	 * \arg Latitude increases with z, and for fixed z, decreases
+	 *   in magnitude with increasing rho.
+	 * \arg Altitude increases with rho, and for fixed rho, increases
+	 *   with the magnitude of z.
+	 *
+	 * The image of the box in the meridian plane is the rectangle of
+	 * (rho,z) values, and the extrema occur at its corners. Therefore the
+	 * intervals are tight (other than padding) and are computed with at
+	 * most four point transformations. Longitude extrema are those of the
+	 * box corners (unless the box contains the polar axis, in which case
+	 * the longitude interval is the entire circle).
+	 *
+	 * Boxes that extend deep inside the Earth (closer to the center than
+	 * half the equatorial radius, e.g. octree root nodes) may reach the
+	 * evolute (where geodetic values are ambiguous). For these, the
+	 * latitude interval is the full range [-pi/2, pi/2] and the minimum
+	 * altitude is (conservatively) the negative equatorial radius.
+	 */
+	inline
+	Box
+	lpaBoxForXyzBox
+		( Box const & xyzBox
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		Interval const & xRange = xyzBox[0];
+		Interval const & yRange = xyzBox[1];
+		Interval const & zRange = xyzBox[2];
+
+		// meridian plane distance range (to/from the polar axis)
+		double const xNear{ std::min(std::max(0., xRange.theMin), xRange.theMax) };
+		double const yNear{ std::min(std::max(0., yRange.theMin), yRange.theMax) };
+		double const xFar
+			{ std::max(std::abs(xRange.theMin), std::abs(xRange.theMax)) };
+		double const yFar
+			{ std::max(std::abs(yRange.theMin), std::abs(yRange.theMax)) };
+		double const rhoMin{ std::hypot(xNear, yNear) };
+		double const rhoMax{ std::hypot(xFar, yFar) };
+
+		// longitude
+		Interval lonRange{ -sPi, sPi };
+		if (! (xRange.contains(0.) && yRange.contains(0.)))
+		{
+			// box is within (less than) half circle around nearest point
+			double const lonRef{ std::atan2(yNear, xNear) };
+			std::array<double, 4u> const deltas
+				{{ std::remainder
+					(std::atan2(yRange.theMin, xRange.theMin) - lonRef, sTwoPi)
+				,  std::remainder
+					(std::atan2(yRange.theMin, xRange.theMax) - lonRef, sTwoPi)
+				,  std::remainder
+					(std::atan2(yRange.theMax, xRange.theMin) - lonRef, sTwoPi)
+				,  std::remainder
+					(std::atan2(yRange.theMax, xRange.theMax) - lonRef, sTwoPi)
+				}};
+			lonRange = padded
+				( Interval
+					{ lonRef + *std::min_element(deltas.cbegin(), deltas.cend())
+					, lonRef + *std::max_element(deltas.cbegin(), deltas.cend())
+					}
+				, sPadAngular
+				);
+			// express with principal value for theMin
+			double const shift
+				{ sTwoPi * std::floor((lonRange.theMin + sPi) / sTwoPi) };
+			lonRange.theMin -= shift;
+			lonRange.theMax -= shift;
+		}
+
+		// nearest/farthest (rho,z) from Earth center
+		double const zNear
+			{ std::min(std::max(0., zRange.theMin), zRange.theMax) };
+		double const zFar
+			{ std::max(std::abs(zRange.theMin), std::abs(zRange.theMax)) };
+
+		// deep interior: monotonic relationships do not apply near evolute
+		Shape const & shape = earthModel.theEllip.theShapeOrig;
+		double const radDeep{ .5 * shape.theRadA };
+		bool const nearIsDeep
+			{ (rhoMin*rhoMin + zNear*zNear) < (radDeep*radDeep) };
+		bool const farIsDeep
+			{ (rhoMax*rhoMax + zFar*zFar) < (radDeep*radDeep) };
+
+		// latitude: extrema at the most polar (rho,z) corners
+		Interval parRange{ -.5*sPi, .5*sPi };
+		if (! nearIsDeep)
+		{
+			double const rhoAtZMax{ (0. <= zRange.theMax) ? rhoMin : rhoMax };
+			double const rhoAtZMin{ (zRange.theMin <= 0.) ? rhoMin : rhoMax };
+			LPA const lpaParMax
+				{ earthModel.lpaForXyz(XYZ{ rhoAtZMax, 0., zRange.theMax }) };
+			LPA const lpaParMin
+				{ earthModel.lpaForXyz(XYZ{ rhoAtZMin, 0., zRange.theMin }) };
+			parRange = Interval{ lpaParMin[1], lpaParMax[1] };
+		}
+
+		// altitude: extrema nearest/farthest from Earth center (since
+		// altitude is non-decreasing with rho and with |z| everywhere)
+		double altMin{ -shape.theRadA };
+		if (! nearIsDeep)
+		{
+			altMin = earthModel.lpaForXyz(XYZ{ rhoMin, 0., zNear })[2];
+		}
+		// (altitude never exceeds distance from center less polar radius)
+		double altMax{ std::hypot(rhoMax, zFar) - shape.theRadB };
+		if (! farIsDeep)
+		{
+			altMax = earthModel.lpaForXyz(XYZ{ rhoMax, 0., zFar })[2];
+		}
+
+		return Box
+			{{ lonRange
+			,  padded(parRange, sPadAngular)
+			,  padded(Interval{ altMin, altMax }, sPadLinear)
+			}};
+	}
+
+	/*! \brief Cartesian box containing all locations within lpaBox.
+	 *
+	 * Evaluates peri::xyzForLpa() with interval arithmetic. Result is
+	 * conservative (contains all points) but is not necessarily tight
+	 * since dependent sub-expressions are bounded independently. (Ref
+	 * peri::bounds::xyzBoxFor() in periBounds.h for a tight box).
+	 */
+	inline
+	Box
+	xyzBoxForLpaBox
+		( Box const & lpaBox
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		Interval const cosLon{ cosOf(lpaBox[0]) };
+		Interval const sinLon{ sinOf(lpaBox[0]) };
+		Interval const cosPar{ cosOf(lpaBox[1]) };
+		Interval const sinPar{ sinOf(lpaBox[1]) };
+		Interval const & alt = lpaBox[2];
+
+		// up direction components
+		Interval const upX{ cosPar * cosLon };
+		Interval const upY{ cosPar * sinLon };
+		Interval const & upZ = sinPar;
+
+		// scale (ref EarthModel::xyzForLpa()) with sum(mu*up^2) expressed
+		// as mu[0]*cos^2(par) + mu[2]*sin^2(par)
+		std::array<double, 3u> const & muSqs
+			= earthModel.theEllip.theShapeNorm.theMuSqs;
+		Interval const sumMuUpSq
+			{ Interval{ muSqs[0], muSqs[0] } * sq(cosPar)
+			+ Interval{ muSqs[2], muSqs[2] } * sq(sinPar)
+			};
+		double const lambda{ earthModel.theEllip.lambdaOrig() };
+		Interval const scl
+			{ lambda / std::sqrt(sumMuUpSq.theMax)
+			, lambda / std::sqrt(sumMuUpSq.theMin)
+			};
+		Interval const magX{ scl * Interval{ muSqs[0], muSqs[0] } + alt };
+		Interval const magZ{ scl * Interval{ muSqs[2], muSqs[2] } + alt };
+
+		return Box
+			{{ padded(magX * upX, sPadLinear)
+			,  padded(magX * upY, sPadLinear)
+			,  padded(magZ * upZ, sPadLinear)
+			}};
+	}
+
+} // [interval]
+} // [peri]
+
+
+#endif // periInterval_INCL_
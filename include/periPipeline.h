@@ -0,0 +1,429 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periPipeline_INCL_
+#define periPipeline_INCL_
+
+
+#if ! (__cplusplus >= 201703L)
+#	error "periPipeline.h requires C++17 (use peridetic.h or periBatch.h)"
+#endif
+
+
+/*! \file
+ * \brief Fused (single pass) pipelines of per-point transformation stages.
+ *
+ * A pipeline is composed (at compile time) from a sequence of stages,
+ * e.g. datum shift, geodetic conversion, local frame offset and
+ * quantization. Each stage is a function object mapping one triple of
+ * values into another. The pipeline applies all stages to each point
+ * in turn such that data make a single pass through memory (rather than
+ * one pass per stage with intermediate arrays). E.g.:
+ *
+ * \code
+ * using namespace peri::pipeline;
+ * auto const pipe
+ * 	{ make
+ * 		( Helmert(shifts, rotations, scalePPM) // XYZ -> XYZ (datum)
+ * 		, Geodetic(peri::model::WGS84) // XYZ -> LPA
+ * 		, Offset(tileOrigin, tileScales) // LPA -> tile coordinates
+ * 		, Quantize<std::int32_t>(fixedScale) // -> integer triples
+ * 		)
+ * 	};
+ * pipe.run(xyzs.data(), xyzs.size(), ints.data());
+ * \endcode
+ *
+ * Stages are any copyable type with a const operator() accepting the
+ * previous stage output (std::array<double, 3u> unless otherwise noted).
+ *
+ * Unlike peridetic.h, this (optional) header requires C++17.
+ */
+
+
+#include "periBatch.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace peri
+{
+namespace pipeline
+{
+	//! Values for one location (e.g. XYZ, LPA, ENU, tile coordinates)
+	typedef std::array<double, 3u> Triple;
+
+	/*! \brief Seven parameter similarity (datum) transformation: XYZ->XYZ.
+	 *
+	 * Position vector convention (small angle rotations):
+	 * \code
+	 * out = shift + (1 + scale) * R * in
+	 * R = [  1  -rz   ry ]
+	 *     [  rz   1  -rx ]
+	 *     [ -ry  rx    1 ]
+	 * \endcode
+	 */
+	class Helmert
+	{
+		Triple theShift;
+		std::array<Triple, 3u> theMat;
+
+	public:
+
+		//! Construct from conventional parameter values
+		inline
+		explicit
+		Helmert  // Helmert::
+			( Triple const & shift
+				//!< Translation [m]
+			, Triple const & rots = {{ 0., 0., 0. }}
+				//!< Rotations (rx,ry,rz) [rad]
+			, double const & scalePPM = 0.
+				//!< Scale difference [parts per million]
+			)
+			: theShift(shift)
+			, theMat()
+		{
+			double const scl{ 1. + 1.e-6*scalePPM };
+			theMat[0] = Triple{{ scl, -scl*rots[2], scl*rots[1] }};
+			theMat[1] = Triple{{ scl*rots[2], scl, -scl*rots[0] }};
+			theMat[2] = Triple{{ -scl*rots[1], scl*rots[0], scl }};
+		}
+
+		//! Transformed location
+		inline
+		Triple
+		operator()  // Helmert::
+			( Triple const & xyz
+			) const
+		{
+			return
+				{{ theShift[0] + dot(theMat[0], xyz)
+				,  theShift[1] + dot(theMat[1], xyz)
+				,  theShift[2] + dot(theMat[2], xyz)
+				}};
+		}
+
+	}; // Helmert
+
+	//! Geodetic coordinates: XYZ->LPA (ref peri::lpaForXyz())
+	class Geodetic
+	{
+		EarthModel const * theModel;
+
+	public:
+
+		//! Attach to earth model (which must outlive stage)
+		inline
+		explicit
+		Geodetic  // Geodetic::
+			( EarthModel const & earthModel = model::WGS84
+			)
+			: theModel{ &earthModel }
+		{ }
+
+		//! Geodetic location
+		inline
+		Triple
+		operator()  // Geodetic::
+			( Triple const & xyz
+			) const
+		{
+			return theModel->lpaForXyz(xyz);
+		}
+
+	}; // Geodetic
+
+	//! Cartesian coordinates: LPA->XYZ (ref peri::xyzForLpa())
+	class Cartesian
+	{
+		EarthModel const * theModel;
+
+	public:
+
+		//! Attach to earth model (which must outlive stage)
+		inline
+		explicit
+		Cartesian  // Cartesian::
+			( EarthModel const & earthModel = model::WGS84
+			)
+			: theModel{ &earthModel }
+		{ }
+
+		//! Cartesian location
+		inline
+		Triple
+		operator()  // Cartesian::
+			( Triple const & lpa
+			) const
+		{
+			return theModel->xyzForLpa(lpa);
+		}
+
+	}; // Cartesian
+
+	//! Local East/North/Up coordinates: XYZ->ENU (relative to origin)
+	class LocalEnu
+	{
+		XYZ theOrigin;
+		std::array<Triple, 3u> theRows; // east, north, up directions
+
+	public:
+
+		//! Frame tangent to ellipsoid (at zero altitude) below origin
+		inline
+		explicit
+		LocalEnu  // LocalEnu::
+			( LPA const & origin
+				//!< Geodetic location of frame origin
+			, EarthModel const & earthModel = model::WGS84
+				//!< Ellipsoid (used only at construction)
+			)
+			: theOrigin(earthModel.xyzForLpa(origin))
+			, theRows()
+		{
+			double const cLon{ std::cos(origin[0]) };
+			double const sLon{ std::sin(origin[0]) };
+			double const cPar{ std::cos(origin[1]) };
+			double const sPar{ std::sin(origin[1]) };
+			theRows[0] = Triple{{ -sLon, cLon, 0. }};
+			theRows[1] = Triple{{ -sPar*cLon, -sPar*sLon, cPar }};
+			theRows[2] = Triple{{ cPar*cLon, cPar*sLon, sPar }};
+		}
+
+		//! Location in local frame
+		inline
+		Triple
+		operator()  // LocalEnu::
+			( Triple const & xyz
+			) const
+		{
+			Triple const rel
+				{{ xyz[0] - theOrigin[0]
+				,  xyz[1] - theOrigin[1]
+				,  xyz[2] - theOrigin[2]
+				}};
+			return
+				{{ dot(theRows[0], rel)
+				,  dot(theRows[1], rel)
+				,  dot(theRows[2], rel)
+				}};
+		}
+
+	}; // LocalEnu
+
+	//! Per component offset and scale: out = scale * (in - origin)
+	class Offset
+	{
+		Triple theOrigin;
+		Triple theScales;
+
+	public:
+
+		//! Construct with (e.g. tile) origin and scale factors
+		inline
+		explicit
+		Offset  // Offset::
+			( Triple const & origin
+			, Triple const & scales = {{ 1., 1., 1. }}
+			)
+			: theOrigin(origin)
+			, theScales(scales)
+		{ }
+
+		//! Offset and scaled values
+		inline
+		Triple
+		operator()  // Offset::
+			( Triple const & value
+			) const
+		{
+			return
+				{{ theScales[0] * (value[0] - theOrigin[0])
+				,  theScales[1] * (value[1] - theOrigin[1])
+				,  theScales[2] * (value[2] - theOrigin[2])
+				}};
+		}
+
+	}; // Offset
+
+	/*! \brief Integer (fixed point) values: Triple->std::array<IntType, 3u>
+	 *
+	 * Result is the nearest integer to the value (ref batch::FixedScale)
+	 * and must be representable as IntType.
+	 */
+	template <typename IntType>
+	class Quantize
+	{
+		Triple theInvScales;
+		Triple theOffsets;
+
+	public:
+
+		//! Construct for integer interpretation fixScale
+		inline
+		explicit
+		Quantize  // Quantize::
+			( batch::FixedScale const & fixScale
+			)
+			: theInvScales
+				{{ 1. / fixScale.theScales[0]
+				,  1. / fixScale.theScales[1]
+				,  1. / fixScale.theScales[2]
+				}}
+			, theOffsets(fixScale.theOffsets)
+		{ }
+
+		//! Integer values
+		inline
+		std::array<IntType, 3u>
+		operator()  // Quantize::
+			( Triple const & value
+			) const
+		{
+			std::array<IntType, 3u> ints;
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				ints[nc] = static_cast<IntType>
+					(std::llround(theInvScales[nc] * (value[nc] - theOffsets[nc])));
+			}
+			return ints;
+		}
+
+	}; // Quantize
+
+	//! Composition of stages applied in order (ref make())
+	template <typename ... Stages>
+	class Pipeline
+	{
+		std::tuple<Stages ...> theStages;
+
+		//! Result of applying stages [Ndx, end) in sequence to value
+		template <std::size_t Ndx, typename Value>
+		inline
+		auto
+		applyFrom  // Pipeline::
+			( Value const & value
+			) const
+		{
+			if constexpr (sizeof...(Stages) == Ndx)
+			{
+				return value;
+			}
+			else
+			{
+				return applyFrom<Ndx + 1u>(std::get<Ndx>(theStages)(value));
+			}
+		}
+
+	public:
+
+		//! Construct from stage instances (ref make())
+		inline
+		explicit
+		Pipeline  // Pipeline::
+			( Stages const & ... stages
+			)
+			: theStages(stages ...)
+		{ }
+
+		//! Result of applying all stages to a single input value
+		template <typename InType>
+		inline
+		auto
+		operator()  // Pipeline::
+			( InType const & value
+			) const
+		{
+			return applyFrom<0u>(value);
+		}
+
+		/*! \brief Apply all stages to each of numPnts values (single pass).
+		 *
+		 * OutType must be assignable from the last stage result. Ranges
+		 * must not overlap (unless identical with same size elements).
+		 */
+		template <typename InType, typename OutType>
+		inline
+		void
+		run  // Pipeline::
+			( InType const * const ins
+			, std::size_t const & numPnts
+			, OutType * const outs
+			) const
+		{
+			PERI_TRACE_SCOPE("peri::pipeline::run", numPnts);
+			for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+			{
+				outs[nn] = applyFrom<0u>(ins[nn]);
+			}
+		}
+
+		//! Pipeline with additional stage appended
+		template <typename NextStage>
+		inline
+		Pipeline<Stages ..., NextStage>
+		then  // Pipeline::
+			( NextStage const & nextStage
+			) const
+		{
+			return std::apply
+				( [&nextStage] (Stages const & ... stages)
+					{
+						return Pipeline<Stages ..., NextStage>
+							(stages ..., nextStage);
+					}
+				, theStages
+				);
+		}
+
+	}; // Pipeline
+
+	//! Pipeline composed from stages (applied in order of arguments)
+	template <typename ... Stages>
+	inline
+	Pipeline<std::decay_t<Stages> ...>
+	make
+		( Stages && ... stages
+		)
+	{
+		return Pipeline<std::decay_t<Stages> ...>
+			(std::forward<Stages>(stages) ...);
+	}
+
+} // [pipeline]
+} // [peri]
+
+
+#endif // periPipeline_INCL_
@@ -0,0 +1,737 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periPlan_INCL_
+#define periPlan_INCL_
+
+
+/*! \file
+ * \brief Transformation plans with autotuned execution strategy.
+ *
+ * A peri::Plan is created once for a particular transformation problem
+ * (earth model, direction, record layout and number of points). At
+ * creation, the plan times the candidate execution strategies (kernel,
+ * number of threads and chunk size) on synthetic data, and remembers
+ * the fastest. Subsequent calls to Plan::execute() use that choice.
+ *
+ * Decisions may be accumulated in a peri::plan::Wisdom instance, which
+ * may be saved to (and later loaded from) a text file such that future
+ * plans for the same problem are created without timing.
+ *
+ * E.g.:
+ * \code
+ * peri::plan::Wisdom wisdom;
+ * wisdom.loadFile("peri.wisdom"); // (okay if not yet existing)
+ * peri::Plan const plan
+ * 	(peri::model::WGS84, peri::plan::LpaForXyz, xyzs.size(), &wisdom);
+ * wisdom.saveFile("peri.wisdom");
+ * for (...) // e.g. many batches of same size
+ * {
+ * 	plan.execute(xyzs.data(), lpas.data());
+ * }
+ * \endcode
+ *
+ * \note Planning allocates scratch data and spawns threads, and so has
+ * a cost comparable to several executions. Wisdom is specific to the
+ * machine on which it was created.
+ */
+
+
+#include "periBatch.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace peri
+{
+namespace plan
+{
+	//! Transformation to be planned
+	enum Direction
+	{
+		  LpaForXyz //!< Geodetic from Cartesian (ref peri::lpaForXyz())
+		, XyzForLpa //!< Cartesian from Geodetic (ref peri::xyzForLpa())
+	};
+
+	//! Bytes between consecutive input and output (3 double) records
+	struct Layout
+	{
+		std::size_t theInStride;
+		std::size_t theOutStride;
+
+		//! Layout for contiguous arrays of XYZ and/or LPA values
+		inline
+		static
+		Layout
+		packed  // Layout::
+			()
+		{
+			return Layout{ sizeof(XYZ), sizeof(LPA) };
+		}
+
+		//! True if both input and output are contiguous arrays
+		inline
+		bool
+		isPacked  // Layout::
+			() const
+		{
+			return
+				(  (sizeof(XYZ) == theInStride)
+				&& (sizeof(LPA) == theOutStride)
+				);
+		}
+
+	}; // Layout
+
+	//! Function signature for (single thread) transformation kernels
+	typedef void (*KernelFunc)
+		( void const * const inBase
+		, std::size_t const & inStride
+		, std::size_t const & numPnts
+		, void * const outBase
+		, std::size_t const & outStride
+		, EarthModel const & earthModel
+		);
+
+	//! Named kernel (e.g. a wrapper of peri::dispatch functions)
+	struct Kernel
+	{
+		std::string theName;
+		KernelFunc theFunc;
+		bool thePackedOnly; //!< If true, only use with Layout::isPacked()
+
+	}; // Kernel
+
+	//! Execution strategy selected by planning
+	struct Choice
+	{
+		std::string theKernelName;
+		std::size_t theNumThreads;
+		std::size_t theChunkSize; //!< Points claimed at once per thread
+		double theSeconds; //!< Measured execution time (at planning)
+
+	}; // Choice
+
+	/*! \brief Fewest points per thread for which a worker thread is started.
+	 *
+	 * Threads are created (and joined) within each Plan::execute(), so
+	 * for smaller problems the start-up cost outweighs the parallelism
+	 * and the execution is done serially in the calling thread.
+	 */
+	constexpr std::size_t sMinPntsPerThread{ 8192u };
+
+	namespace priv
+	{
+		//! Adapt peri::batch::lpaForXyz() to KernelFunc signature
+		inline
+		void
+		lpaForXyzPacked
+			( void const * const inBase
+			, std::size_t const &
+			, std::size_t const & numPnts
+			, void * const outBase
+			, std::size_t const &
+			, EarthModel const & earthModel
+			)
+		{
+			batch::lpaForXyz
+				( static_cast<XYZ const *>(inBase), numPnts
+				, static_cast<LPA *>(outBase), earthModel
+				);
+		}
+
+		//! Adapt peri::batch::xyzForLpa() to KernelFunc signature
+		inline
+		void
+		xyzForLpaPacked
+			( void const * const inBase
+			, std::size_t const &
+			, std::size_t const & numPnts
+			, void * const outBase
+			, std::size_t const &
+			, EarthModel const & earthModel
+			)
+		{
+			batch::xyzForLpa
+				( static_cast<LPA const *>(inBase), numPnts
+				, static_cast<XYZ *>(outBase), earthModel
+				);
+		}
+
+		//! Adapt peri::batch::lpaForXyzStrided() to KernelFunc signature
+		inline
+		void
+		lpaForXyzStrided
+			( void const * const inBase
+			, std::size_t const & inStride
+			, std::size_t const & numPnts
+			, void * const outBase
+			, std::size_t const & outStride
+			, EarthModel const & earthModel
+			)
+		{
+			batch::lpaForXyzStrided
+				(inBase, inStride, numPnts, outBase, outStride, earthModel);
+		}
+
+		//! Adapt peri::batch::xyzForLpaStrided() to KernelFunc signature
+		inline
+		void
+		xyzForLpaStrided
+			( void const * const inBase
+			, std::size_t const & inStride
+			, std::size_t const & numPnts
+			, void * const outBase
+			, std::size_t const & outStride
+			, EarthModel const & earthModel
+			)
+		{
+			batch::xyzForLpaStrided
+				(inBase, inStride, numPnts, outBase, outStride, earthModel);
+		}
+
+	} // [priv]
+
+	//! Kernels (from periBatch.h) always considered for direction
+	inline
+	std::vector<Kernel>
+	builtinKernels
+		( Direction const & direction
+		)
+	{
+		std::vector<Kernel> kernels;
+		if (LpaForXyz == direction)
+		{
+			kernels.push_back(Kernel{ "packed", priv::lpaForXyzPacked, true });
+			kernels.push_back
+				(Kernel{ "strided", priv::lpaForXyzStrided, false });
+		}
+		else
+		{
+			kernels.push_back(Kernel{ "packed", priv::xyzForLpaPacked, true });
+			kernels.push_back
+				(Kernel{ "strided", priv::xyzForLpaStrided, false });
+		}
+		return kernels;
+	}
+
+	//! Text identifying a planning problem (e.g. for use as Wisdom key)
+	inline
+	std::string
+	keyFor
+		( EarthModel const & earthModel
+		, Direction const & direction
+		, Layout const & layout
+		, std::size_t const & numPnts
+		)
+	{
+		Shape const & shape = earthModel.theEllip.theShapeOrig;
+		std::ostringstream oss;
+		oss << std::setprecision(17)
+			<< ((LpaForXyz == direction) ? "lpaForXyz" : "xyzForLpa")
+			<< '/' << layout.theInStride
+			<< '/' << layout.theOutStride
+			<< '/' << numPnts
+			<< '/' << shape.theRadA
+			<< '/' << shape.theRadB
+			;
+		return oss.str();
+	}
+
+	/*! \brief Collection of planning decisions (thread safe).
+	 *
+	 * Text format has one decision per line with (space separated)
+	 * fields: key kernelName numThreads chunkSize seconds. Lines starting
+	 * with '#' are ignored.
+	 */
+	class Wisdom
+	{
+		mutable std::mutex theMutex{};
+		std::map<std::string, Choice> theChoices{};
+
+	public:
+
+		//! True if a choice is known for key (and if so, set *choice)
+		inline
+		bool
+		find  // Wisdom::
+			( std::string const & key
+			, Choice * const & choice
+			) const
+		{
+			std::lock_guard<std::mutex> const lock(theMutex);
+			std::map<std::string, Choice>::const_iterator const itFind
+				{ theChoices.find(key) };
+			bool const found{ (theChoices.end() != itFind) };
+			if (found)
+			{
+				*choice = itFind->second;
+			}
+			return found;
+		}
+
+		//! Record (or replace) choice for key
+		inline
+		void
+		remember  // Wisdom::
+			( std::string const & key
+			, Choice const & choice
+			)
+		{
+			std::lock_guard<std::mutex> const lock(theMutex);
+			theChoices[key] = choice;
+		}
+
+		//! Number of decisions
+		inline
+		std::size_t
+		size  // Wisdom::
+			() const
+		{
+			std::lock_guard<std::mutex> const lock(theMutex);
+			return theChoices.size();
+		}
+
+		//! Put decisions to stream in text format
+		inline
+		void
+		save  // Wisdom::
+			( std::ostream & ostrm
+			) const
+		{
+			std::lock_guard<std::mutex> const lock(theMutex);
+			ostrm << "# peridetic wisdom\n";
+			for (std::map<std::string, Choice>::const_iterator
+				it{ theChoices.begin() } ; theChoices.end() != it ; ++it)
+			{
+				Choice const & choice = it->second;
+				ostrm
+					<< it->first
+					<< ' ' << choice.theKernelName
+					<< ' ' << choice.theNumThreads
+					<< ' ' << choice.theChunkSize
+					<< ' ' << choice.theSeconds
+					<< '\n';
+			}
+		}
+
+		//! Add decisions from stream: true if all lines were valid
+		inline
+		bool
+		load  // Wisdom::
+			( std::istream & istrm
+			)
+		{
+			bool okay{ true };
+			std::string line;
+			while (std::getline(istrm, line))
+			{
+				if (line.empty() || ('#' == line[0]))
+				{
+					continue;
+				}
+				std::istringstream iss(line);
+				std::string key;
+				Choice choice{ {}, 0u, 0u, 0. };
+				iss >> key >> choice.theKernelName
+					>> choice.theNumThreads >> choice.theChunkSize
+					>> choice.theSeconds;
+				if (iss.fail() || (0u == choice.theNumThreads)
+					|| (0u == choice.theChunkSize))
+				{
+					okay = false;
+				}
+				else
+				{
+					remember(key, choice);
+				}
+			}
+			return okay;
+		}
+
+		//! Save decisions to file: true if successful
+		inline
+		bool
+		saveFile  // Wisdom::
+			( std::string const & path
+			) const
+		{
+			std::ofstream ofs(path);
+			save(ofs);
+			return ofs.good();
+		}
+
+		//! Load decisions from file: true if file exists and was valid
+		inline
+		bool
+		loadFile  // Wisdom::
+			( std::string const & path
+			)
+		{
+			std::ifstream ifs(path);
+			return (ifs.good() && load(ifs));
+		}
+
+	}; // Wisdom
+
+} // [plan]
+
+
+	/*! \brief Transformation of specific problem with autotuned strategy.
+	 *
+	 * Candidates are all combinations of:
+	 * \arg kernels - plan::builtinKernels() plus any supplied by caller
+	 * \arg threads - 1, 2, 4, ... up to maxThreads (but no more than
+	 * one per plan::sMinPntsPerThread points)
+	 * \arg chunk sizes - a few sizes (for multiple threads)
+	 *
+	 * The earth model must outlive the plan.
+	 */
+	class Plan
+	{
+		EarthModel const * theModel{ nullptr };
+		plan::Direction theDirection{ plan::LpaForXyz };
+		plan::Layout theLayout{ plan::Layout::packed() };
+		std::size_t theNumPnts{ 0u };
+		std::vector<plan::Kernel> theKernels{};
+		plan::Choice theChoice{ {}, 1u, 1u, 0. };
+		plan::KernelFunc theFunc{ nullptr };
+		bool theFromWisdom{ false };
+
+		//! Kernel with given name (null if not available for layout)
+		inline
+		plan::KernelFunc
+		kernelFuncFor  // Plan::
+			( std::string const & name
+			) const
+		{
+			plan::KernelFunc func{ nullptr };
+			for (plan::Kernel const & kernel : theKernels)
+			{
+				if ((name == kernel.theName)
+					&& ((! kernel.thePackedOnly) || theLayout.isPacked()))
+				{
+					func = kernel.theFunc;
+					break;
+				}
+			}
+			return func;
+		}
+
+		//! Execute with strategy (func, choice) for numPnts records
+		inline
+		void
+		run  // Plan::
+			( plan::KernelFunc const & func
+			, plan::Choice const & choice
+			, void const * const inBase
+			, std::size_t const & numPnts
+			, void * const outBase
+			) const
+		{
+			unsigned char const * const inBytes
+				{ static_cast<unsigned char const *>(inBase) };
+			unsigned char * const outBytes{ static_cast<unsigned char *>(outBase) };
+			std::size_t const & inStride = theLayout.theInStride;
+			std::size_t const & outStride = theLayout.theOutStride;
+			std::size_t const chunkSize{ choice.theChunkSize };
+			std::size_t const numChunks{ (numPnts + chunkSize - 1u) / chunkSize };
+			std::size_t const numWorth{ numPnts / plan::sMinPntsPerThread };
+			std::size_t const numUse
+				{ std::max
+					( std::size_t{ 1u }
+					, std::min
+						({ choice.theNumThreads, numChunks, numWorth })
+					)
+				};
+			if (1u == numUse)
+			{
+				func(inBase, inStride, numPnts, outBase, outStride, *theModel);
+			}
+			else
+			{
+				std::atomic<std::size_t> nextChunk{ 0u };
+				EarthModel const & earthModel = *theModel;
+				auto const worker
+					{ [&] ()
+						{
+							for (std::size_t nc{ nextChunk.fetch_add(1u) }
+								; nc < numChunks ; nc = nextChunk.fetch_add(1u))
+							{
+								std::size_t const beg{ nc * chunkSize };
+								std::size_t const num
+									{ std::min(chunkSize, numPnts - beg) };
+								func
+									( inBytes + beg*inStride, inStride, num
+									, outBytes + beg*outStride, outStride
+									, earthModel
+									);
+							}
+						}
+					};
+				std::vector<std::thread> threads;
+				threads.reserve(numUse);
+				for (std::size_t nt{1u} ; nt < numUse ; ++nt)
+				{
+					threads.emplace_back(worker);
+				}
+				worker(); // this thread also participates
+				for (std::thread & thread : threads)
+				{
+					thread.join();
+				}
+			}
+		}
+
+		//! Time all candidates on synthetic data and keep fastest
+		inline
+		void
+		autotune  // Plan::
+			( std::size_t const & maxThreads
+			)
+		{
+			// limit number of points used for timing (limits planning cost)
+			std::size_t const maxTimePnts{ 1u << 18u };
+			std::size_t const numTime{ std::min(theNumPnts, maxTimePnts) };
+			std::size_t const numDbl{ sizeof(XYZ) / sizeof(double) };
+
+			// synthetic input records: geodetic (and corresponding XYZ)
+			// locations spread over globe and within +/-10[km] altitude
+			std::vector<double> inData
+				((numTime * theLayout.theInStride) / sizeof(double) + numDbl);
+			std::vector<double> outData
+				((numTime * theLayout.theOutStride) / sizeof(double) + numDbl);
+			unsigned char * const inBytes
+				{ reinterpret_cast<unsigned char *>(inData.data()) };
+			for (std::size_t nn{0u} ; nn < numTime ; ++nn)
+			{
+				double const frac{ (double(nn) + .5) / double(numTime) };
+				LPA const lpa
+					{ (frac - .5) * 6.
+					, (frac - .5) * 3. * std::cos(97. * frac)
+					, 10000. * std::sin(31. * frac)
+					};
+				std::array<double, 3u> value{ lpa };
+				if (plan::LpaForXyz == theDirection)
+				{
+					value = theModel->xyzForLpa(lpa);
+				}
+				std::memcpy
+					( inBytes + nn*theLayout.theInStride
+					, value.data(), sizeof(value)
+					);
+			}
+
+			// candidate numbers of threads (only those that run() would
+			// actually start for the timed number of points)
+			std::size_t const numWorth
+				{ std::max
+					( std::size_t{ 1u }
+					, std::min(maxThreads, numTime / plan::sMinPntsPerThread)
+					)
+				};
+			std::vector<std::size_t> threadCounts;
+			for (std::size_t numThreads{1u} ; numThreads < numWorth
+				; numThreads *= 2u)
+			{
+				threadCounts.push_back(numThreads);
+			}
+			threadCounts.push_back(numWorth);
+
+			bool haveChoice{ false };
+			for (plan::Kernel const & kernel : theKernels)
+			{
+				if (kernel.thePackedOnly && (! theLayout.isPacked()))
+				{
+					continue;
+				}
+				for (std::size_t const & numThreads : threadCounts)
+				{
+					// chunk sizes relative to the timed number of points
+					// (such that the timed strategy is what is executed)
+					std::vector<std::size_t> chunkSizes{ numTime };
+					if (1u < numThreads)
+					{
+						chunkSizes =
+							{ 1024u
+							, 16384u
+							, (numTime + numThreads - 1u) / numThreads
+							};
+					}
+					for (std::size_t const & chunkSize : chunkSizes)
+					{
+						plan::Choice const choice
+							{ kernel.theName
+							, numThreads
+							, std::max(std::size_t{ 1u }, chunkSize)
+							, 0.
+							};
+						// fastest of several trials
+						double bestTime{ std::numeric_limits<double>::max() };
+						for (std::size_t trial{0u} ; trial < 3u ; ++trial)
+						{
+							std::chrono::steady_clock::time_point const t0
+								{ std::chrono::steady_clock::now() };
+							run
+								( kernel.theFunc, choice
+								, inData.data(), numTime, outData.data()
+								);
+							std::chrono::duration<double> const dur
+								{ std::chrono::steady_clock::now() - t0 };
+							bestTime = std::min(bestTime, dur.count());
+						}
+						if ((! haveChoice) || (bestTime < theChoice.theSeconds))
+						{
+							theChoice = choice;
+							theChoice.theSeconds = bestTime;
+							theFunc = kernel.theFunc;
+							haveChoice = true;
+						}
+					}
+				}
+			}
+		}
+
+	public:
+
+		/*! \brief Plan transformation (timing candidates unless wisdom known).
+		 *
+		 * If wisdom is provided, the decision is taken from it when
+		 * available, and otherwise the autotuned decision is added to it.
+		 */
+		inline
+		explicit
+		Plan  // Plan::
+			( EarthModel const & earthModel
+				//!< Ellipsoid for transformation (must outlive plan)
+			, plan::Direction const & direction
+				//!< Which way to transform
+			, std::size_t const & numPnts
+				//!< Number of points transformed by each execute()
+			, plan::Wisdom * const & wisdom = nullptr
+				//!< Optional source (and destination) of decisions
+			, plan::Layout const & layout = plan::Layout::packed()
+				//!< Bytes between records
+			, std::vector<plan::Kernel> const & moreKernels = {}
+				//!< Additional candidate kernels (e.g. peri::dispatch)
+			, std::size_t const & maxThreads
+				= std::thread::hardware_concurrency()
+				//!< Largest number of threads to consider
+			)
+			: theModel{ &earthModel }
+			, theDirection{ direction }
+			, theLayout{ layout }
+			, theNumPnts{ numPnts }
+			, theKernels{ plan::builtinKernels(direction) }
+		{
+			theKernels.insert
+				(theKernels.end(), moreKernels.begin(), moreKernels.end());
+			std::string const keyText{ key() };
+			if (wisdom && wisdom->find(keyText, &theChoice))
+			{
+				theFunc = kernelFuncFor(theChoice.theKernelName);
+				theFromWisdom = (nullptr != theFunc);
+			}
+			if (! theFromWisdom)
+			{
+				autotune(maxThreads);
+				if (wisdom)
+				{
+					wisdom->remember(keyText, theChoice);
+				}
+			}
+		}
+
+		//! Text identifying problem (ref plan::keyFor())
+		inline
+		std::string
+		key  // Plan::
+			() const
+		{
+			return plan::keyFor(*theModel, theDirection, theLayout, theNumPnts);
+		}
+
+		//! Selected execution strategy
+		inline
+		plan::Choice const &
+		choice  // Plan::
+			() const
+		{
+			return theChoice;
+		}
+
+		//! True if strategy was taken from wisdom (rather than timing)
+		inline
+		bool
+		fromWisdom  // Plan::
+			() const
+		{
+			return theFromWisdom;
+		}
+
+		/*! \brief Transform planned number of records from inBase to outBase.
+		 *
+		 * Records are located per plan Layout. Input and output must not
+		 * overlap (unless identical with same layout strides).
+		 */
+		inline
+		void
+		execute  // Plan::
+			( void const * const inBase
+			, void * const outBase
+			) const
+		{
+			PERI_TRACE_SCOPE("peri::Plan::execute", theNumPnts);
+			run(theFunc, theChoice, inBase, theNumPnts, outBase);
+		}
+
+	}; // Plan
+
+} // [peri]
+
+
+#endif // periPlan_INCL_
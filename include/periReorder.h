@@ -0,0 +1,198 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periReorder_INCL_
+#define periReorder_INCL_
+
+
+/*! \file
+ * \brief Locality ordered (Morton key) batch conversion with warm starts.
+ *
+ * When consecutive points are spatially close, the solver may start
+ * from the solution of the previous point (rather than from a sphere
+ * approximation) and converge in fewer iterations. For unordered input,
+ * lpaForXyzReordered() first sorts point indices by Morton (Z-order)
+ * key of the Cartesian location, converts points in key order (each
+ * solution starting from the previous one), and stores results in
+ * the original order.
+ *
+ * Whether reordering pays off depends on the data - ref eval/evalReorder.
+ * Warm starts in the given order help with spatially coherent input
+ * (e.g. scan ordered or small area data). Since the solver is cheap, the
+ * cost of sorting (and of scattered memory access) usually exceeds the
+ * savings for a single pass; reordering is most useful when the order
+ * from mortonOrderFor() is reused (with lpaForXyzWarm()) over several
+ * conversions of the same (or similarly arranged) points.
+ *
+ * \note Unlike periBatch.h functions, lpaForXyzReordered() allocates
+ * (key and index) workspace.
+ */
+
+
+#include "peridetic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace peri
+{
+namespace reorder
+{
+	//! Spread low 21 bits of value to every third bit position
+	inline
+	std::uint64_t
+	spreadBits3
+		( std::uint64_t value
+		)
+	{
+		value &= 0x1fffffu;
+		value = (value | (value << 32u)) & 0x1f00000000ffffu;
+		value = (value | (value << 16u)) & 0x1f0000ff0000ffu;
+		value = (value | (value << 8u)) & 0x100f00f00f00f00fu;
+		value = (value | (value << 4u)) & 0x10c30c30c30c30c3u;
+		value = (value | (value << 2u)) & 0x1249249249249249u;
+		return value;
+	}
+
+	/*! \brief Morton (Z-order) key for Cartesian location.
+	 *
+	 * Each component is quantized to 21 bits over the cube
+	 * [-halfSize, halfSize] (values outside are clamped) and the bits
+	 * are interleaved. The default cube encloses the Earth with cells
+	 * of 8[m].
+	 */
+	inline
+	std::uint64_t
+	mortonKeyFor
+		( XYZ const & xyz
+		, double const & halfSize = 8388608.
+		)
+	{
+		constexpr double maxCell{ double(0x1fffffu) };
+		double const cellPerMeter{ (.5 * (maxCell + 1.)) / halfSize };
+		std::uint64_t key{ 0u };
+		for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+		{
+			double const cell
+				{ std::min
+					(maxCell, std::max(0., (xyz[nc] + halfSize) * cellPerMeter))
+				};
+			key |= (spreadBits3(static_cast<std::uint64_t>(cell)) << nc);
+		}
+		return key;
+	}
+
+	/*! \brief Geodetic for Cartesian locations (each warm started).
+	 *
+	 * Locations are converted in the order given with the solver for
+	 * each point starting from the solution of the previous point (if
+	 * indices is not null, locations are xyzs[indices[nn]] and results
+	 * are stored into lpas[indices[nn]]). Points following an invalid
+	 * (e.g. NaN) location are solved from a cold start.
+	 */
+	inline
+	void
+	lpaForXyzWarm
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, LPA * const lpas
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		, std::size_t const * const indices = nullptr
+			//!< If not null, order in which to access xyzs/lpas
+		)
+	{
+		PERI_TRACE_SCOPE("peri::reorder::lpaForXyzWarm", numPnts);
+		double sigmaNorm{ sNan }; // (first point from sphere approximation)
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			std::size_t const ndx{ indices ? indices[nn] : nn };
+			lpas[ndx] = earthModel.lpaForXyzFrom(xyzs[ndx], &sigmaNorm);
+		}
+	}
+
+	//! Indices of xyzs sorted by Morton key (ref mortonKeyFor())
+	inline
+	std::vector<std::size_t>
+	mortonOrderFor
+		( XYZ const * const xyzs
+		, std::size_t const & numPnts
+		)
+	{
+		std::vector<std::pair<std::uint64_t, std::size_t> > keyNdxs;
+		keyNdxs.reserve(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			keyNdxs.emplace_back(mortonKeyFor(xyzs[nn]), nn);
+		}
+		std::sort(keyNdxs.begin(), keyNdxs.end());
+		std::vector<std::size_t> indices;
+		indices.reserve(numPnts);
+		for (std::pair<std::uint64_t, std::size_t> const & keyNdx : keyNdxs)
+		{
+			indices.emplace_back(keyNdx.second);
+		}
+		return indices;
+	}
+
+	/*! \brief Geodetic for Cartesian locations converted in Morton order.
+	 *
+	 * Results are stored in original order (lpas[nn] for xyzs[nn]).
+	 * Input and output ranges must not overlap.
+	 */
+	inline
+	void
+	lpaForXyzReordered
+		( XYZ const * const xyzs
+			//!< Start of numPnts Cartesian locations
+		, std::size_t const & numPnts
+			//!< Number of locations to transform
+		, LPA * const lpas
+			//!< Start of space for numPnts results
+		, EarthModel const & earthModel = model::WGS84
+		)
+	{
+		PERI_TRACE_SCOPE("peri::reorder::lpaForXyzReordered", numPnts);
+		std::vector<std::size_t> const indices{ mortonOrderFor(xyzs, numPnts) };
+		lpaForXyzWarm(xyzs, numPnts, lpas, earthModel, indices.data());
+	}
+
+} // [reorder]
+} // [peri]
+
+
+#endif // periReorder_INCL_
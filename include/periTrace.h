@@ -0,0 +1,522 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#ifndef periTrace_INCL_
+#define periTrace_INCL_
+
+
+/*! \file
+ * \brief Optional (compile time) trace points for Peridetic hot paths.
+ *
+ * Trace points are expressed via macros that expand to nothing unless
+ * PERIDETIC_TRACE is defined (consistently, e.g. as compile definition
+ * -DPERIDETIC_TRACE, for \b all translation units of a program):
+ * \arg PERI_TRACE_BEG(name, value) - begin of duration (e.g. batch entry)
+ * \arg PERI_TRACE_END(name, value) - end of duration (e.g. batch exit)
+ * \arg PERI_TRACE_MARK(name, value) - instant event (e.g. non-convergence)
+ * \arg PERI_TRACE_SCOPE(name, value) - BEG now and END at scope exit
+ *
+ * Argument 'name' must be a string literal (only the pointer is stored)
+ * and 'value' is an unsigned integer (e.g. number of points in batch).
+ *
+ * When enabled, each thread writes events into its own fixed size ring
+ * buffer (wait-free, no locks, allocated once per thread upon the first
+ * event). Oldest events are overwritten when a ring is full.
+ *
+ * Collected events may be:
+ * \arg Saved to a simple text file via peri::trace::saveRecords() for
+ *   later conversion with the periTraceDump tool.
+ * \arg Written directly as Chrome trace JSON (chrome://tracing, Perfetto)
+ *   via peri::trace::saveChromeJson().
+ *
+ * \note Snapshots are intended to be taken while traced threads are
+ * quiescent. Events overwritten during a snapshot are detected and
+ * dropped, but an event being written concurrently may be incomplete.
+ */
+
+
+#if defined(PERIDETIC_TRACE)
+
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+#if ! defined(PERIDETIC_TRACE_RING_SIZE)
+	//! Number of events retained per thread (must be power of 2)
+#	define PERIDETIC_TRACE_RING_SIZE (1u << 14u)
+#endif
+
+#if ! defined(PERIDETIC_TRACE_MAX_THREADS)
+	//! Maximum number of threads for which events are retained
+#	define PERIDETIC_TRACE_MAX_THREADS 256u
+#endif
+
+
+namespace peri
+{
+//! Event tracing support (active only if PERIDETIC_TRACE is defined)
+namespace trace
+{
+	//! Event kinds (values match Chrome trace "ph" field)
+	enum Phase : char
+	{
+		  Begin = 'B'
+		, End = 'E'
+		, Mark = 'i'
+	};
+
+	//! Raw event as stored in ring buffer (C++11 aggregate: no member init)
+	struct Event
+	{
+		char const * theName; //!< Null for (value initialized) empty slot
+		std::uint64_t theTime; //!< [ns] steady_clock
+		std::uint64_t theValue;
+		char thePhase;
+
+	}; // Event
+
+	//! Number of events held in each per-thread ring
+	constexpr std::size_t sRingSize{ PERIDETIC_TRACE_RING_SIZE };
+
+	static_assert
+		( (0u < sRingSize) && (0u == (sRingSize & (sRingSize - 1u)))
+		, "PERIDETIC_TRACE_RING_SIZE must be a power of 2"
+		);
+
+	//! Maximum number of per-thread rings
+	constexpr std::size_t sMaxThreads{ PERIDETIC_TRACE_MAX_THREADS };
+
+	//! Single producer (owning thread) circular event buffer
+	struct Ring
+	{
+		std::array<Event, sRingSize> theEvents{};
+		std::atomic<std::uint64_t> theHead{ 0u }; //!< total number pushed
+		std::uint32_t theThreadId{ 0u };
+
+		//! Record event (called only by owning thread)
+		inline
+		void
+		push  // Ring::
+			( Event const & event
+			)
+		{
+			std::uint64_t const head{ theHead.load(std::memory_order_relaxed) };
+			theEvents[head & (sRingSize - 1u)] = event;
+			theHead.store(head + 1u, std::memory_order_release);
+		}
+
+	}; // Ring
+
+	//! Collection of all per-thread rings (rings persist for program life)
+	struct Registry
+	{
+		std::array<std::atomic<Ring *>, sMaxThreads> theRings;
+		std::atomic<std::uint32_t> theNumRings;
+		std::atomic<std::uint64_t> theNumDropped;
+
+	}; // Registry
+
+	//! Program-wide registry (static storage: zero initialized)
+	inline
+	Registry &
+	registry
+		()
+	{
+		static Registry sRegistry;
+		return sRegistry;
+	}
+
+	//! Allocate and register a ring for the calling thread
+	inline
+	Ring *
+	newRing
+		()
+	{
+		Ring * ptRing{ nullptr };
+		Registry & reg = registry();
+		std::uint32_t const ndx{ reg.theNumRings.fetch_add(1u) };
+		if (ndx < sMaxThreads)
+		{
+			ptRing = new Ring;
+			ptRing->theThreadId = ndx;
+			reg.theRings[ndx].store(ptRing, std::memory_order_release);
+		}
+		return ptRing;
+	}
+
+	//! Ring owned by the calling thread (null if too many threads)
+	inline
+	Ring *
+	threadRing
+		()
+	{
+		thread_local Ring * const tRing{ newRing() };
+		return tRing;
+	}
+
+	//! Current time in [ns]
+	inline
+	std::uint64_t
+	nowNanoSec
+		()
+	{
+		using namespace std::chrono;
+		return static_cast<std::uint64_t>
+			(duration_cast<nanoseconds>
+				(steady_clock::now().time_since_epoch()).count());
+	}
+
+	//! Record an event for the calling thread
+	inline
+	void
+	record
+		( char const * const name
+		, char const & phase
+		, std::uint64_t const & value
+		)
+	{
+		Ring * const ptRing{ threadRing() };
+		if (ptRing)
+		{
+			ptRing->push(Event{ name, nowNanoSec(), value, phase });
+		}
+		else
+		{
+			registry().theNumDropped.fetch_add(1u, std::memory_order_relaxed);
+		}
+	}
+
+	//! Records Begin event at construction and End event at destruction
+	struct Scope
+	{
+		char const * const theName;
+		std::uint64_t const theValue;
+
+		inline
+		explicit
+		Scope  // Scope::
+			( char const * const name
+			, std::uint64_t const & value
+			)
+			: theName{ name }
+			, theValue{ value }
+		{
+			record(theName, Begin, theValue);
+		}
+
+		inline
+		~Scope  // Scope::
+			()
+		{
+			record(theName, End, theValue);
+		}
+
+		Scope(Scope const &) = delete;
+		Scope & operator=(Scope const &) = delete;
+
+	}; // Scope
+
+	//! Event information in self contained form (e.g. for saving)
+	struct Record
+	{
+		std::string theName;
+		std::uint64_t theTime;
+		std::uint64_t theValue;
+		std::uint32_t theThreadId;
+		char thePhase;
+
+	}; // Record
+
+	//! Snapshot of (complete) events from all threads, ordered by time
+	inline
+	std::vector<Record>
+	records
+		()
+	{
+		std::vector<Record> recs;
+		Registry & reg = registry();
+		std::uint32_t const numRings
+			{ std::min
+				( reg.theNumRings.load(std::memory_order_acquire)
+				, static_cast<std::uint32_t>(sMaxThreads)
+				)
+			};
+		for (std::uint32_t nr{0u} ; nr < numRings ; ++nr)
+		{
+			Ring const * const ptRing
+				{ reg.theRings[nr].load(std::memory_order_acquire) };
+			if (! ptRing)
+			{
+				continue;
+			}
+			std::uint64_t const head
+				{ ptRing->theHead.load(std::memory_order_acquire) };
+			std::uint64_t const beg{ (sRingSize < head) ? (head - sRingSize) : 0u };
+			std::vector<Event> const copies
+				( ptRing->theEvents.cbegin(), ptRing->theEvents.cend() );
+			// discard any events overwritten while being copied
+			std::uint64_t const headAfter
+				{ ptRing->theHead.load(std::memory_order_acquire) };
+			std::uint64_t const valid
+				{ (sRingSize < headAfter) ? (headAfter - sRingSize) : 0u };
+			for (std::uint64_t nn{std::max(beg, valid)} ; nn < head ; ++nn)
+			{
+				Event const & event = copies[nn & (sRingSize - 1u)];
+				if (event.theName)
+				{
+					recs.emplace_back(Record
+						{ event.theName
+						, event.theTime
+						, event.theValue
+						, ptRing->theThreadId
+						, event.thePhase
+						});
+				}
+			}
+		}
+		std::stable_sort
+			( recs.begin(), recs.end()
+			, [] (Record const & recA, Record const & recB)
+				{ return (recA.theTime < recB.theTime); }
+			);
+		return recs;
+	}
+
+	//! Number of events lost due to exceeding sMaxThreads
+	inline
+	std::uint64_t
+	numDropped
+		()
+	{
+		return registry().theNumDropped.load(std::memory_order_relaxed);
+	}
+
+	/*! \brief Save records in simple text form (one record per line).
+	 *
+	 * Each line is "threadId phase timeNanoSec value name".
+	 */
+	inline
+	void
+	saveRecords
+		( std::ostream & ostrm
+		, std::vector<Record> const & recs
+		)
+	{
+		ostrm << "# periTrace 1" << '\n';
+		for (Record const & rec : recs)
+		{
+			ostrm
+				<< rec.theThreadId
+				<< ' ' << rec.thePhase
+				<< ' ' << rec.theTime
+				<< ' ' << rec.theValue
+				<< ' ' << rec.theName
+				<< '\n';
+		}
+	}
+
+	//! True if all of text is an unsigned decimal value (not above maxValue)
+	inline
+	bool
+	parseUnsigned
+		( std::string const & text
+		, std::uint64_t * const & ptValue
+		, std::uint64_t const & maxValue
+			= std::numeric_limits<std::uint64_t>::max()
+		)
+	{
+		bool okay{ false };
+		if ((! text.empty()) && std::isdigit(static_cast<unsigned char>(text[0])))
+		{
+			char * end{ nullptr };
+			errno = 0;
+			unsigned long long const value
+				{ std::strtoull(text.c_str(), &end, 10) };
+			okay =
+				(  (0 == errno)
+				&& (text.c_str() + text.size() == end)
+				&& (value <= maxValue)
+				);
+			if (okay)
+			{
+				*ptValue = static_cast<std::uint64_t>(value);
+			}
+		}
+		return okay;
+	}
+
+	/*! \brief Records from stream in format written by saveRecords()
+	 *
+	 * Malformed lines (e.g. a truncated last line, or values out of
+	 * range) are skipped; their number is returned in ptNumSkipped
+	 * (if provided).
+	 */
+	inline
+	std::vector<Record>
+	loadRecords
+		( std::istream & istrm
+		, std::size_t * const & ptNumSkipped = nullptr
+		)
+	{
+		std::vector<Record> recs;
+		std::size_t numSkipped{ 0u };
+		std::string line;
+		while (std::getline(istrm, line))
+		{
+			if (line.empty() || ('#' == line[0]))
+			{
+				continue;
+			}
+			std::string::size_type pos{ 0u };
+			std::string::size_type end{ line.find(' ', pos) };
+			std::vector<std::string> fields;
+			while ((fields.size() < 4u) && (std::string::npos != end))
+			{
+				fields.emplace_back(line.substr(pos, end - pos));
+				pos = end + 1u;
+				end = line.find(' ', pos);
+			}
+			Record rec{};
+			std::uint64_t threadId{ 0u };
+			bool const okay
+				{  (4u == fields.size())
+				&& (pos < line.size())
+				&& (1u == fields[1].size())
+				&& parseUnsigned
+					( fields[0], &threadId
+					, std::numeric_limits<std::uint32_t>::max()
+					)
+				&& parseUnsigned(fields[2], &rec.theTime)
+				&& parseUnsigned(fields[3], &rec.theValue)
+				};
+			if (okay)
+			{
+				rec.theThreadId = static_cast<std::uint32_t>(threadId);
+				rec.thePhase = fields[1][0];
+				rec.theName = line.substr(pos);
+				recs.emplace_back(rec);
+			}
+			else
+			{
+				++numSkipped;
+			}
+		}
+		if (ptNumSkipped)
+		{
+			*ptNumSkipped = numSkipped;
+		}
+		return recs;
+	}
+
+	//! Write records in Chrome trace event (JSON) format
+	inline
+	void
+	saveChromeJson
+		( std::ostream & ostrm
+		, std::vector<Record> const & recs
+		)
+	{
+		std::uint64_t const time0{ recs.empty() ? 0u : recs.front().theTime };
+		ostrm << "{\"traceEvents\":[";
+		for (std::size_t nn{0u} ; nn < recs.size() ; ++nn)
+		{
+			Record const & rec = recs[nn];
+			std::string name;
+			for (char const & chr : rec.theName)
+			{
+				if (('"' == chr) || ('\\' == chr))
+				{
+					name.push_back('\\');
+				}
+				name.push_back(chr);
+			}
+			// Chrome trace timestamps are in [us]
+			std::uint64_t const relNano{ rec.theTime - time0 };
+			ostrm
+				<< ((0u == nn) ? "\n" : ",\n")
+				<< "{\"name\":\"" << name << "\""
+				<< ",\"cat\":\"peri\""
+				<< ",\"ph\":\"" << rec.thePhase << "\""
+				<< ",\"ts\":" << (relNano / 1000u)
+				<< "." << std::setw(3) << std::setfill('0') << (relNano % 1000u)
+				<< std::setfill(' ')
+				<< ",\"pid\":1"
+				<< ",\"tid\":" << rec.theThreadId;
+			if (Mark == rec.thePhase)
+			{
+				ostrm << ",\"s\":\"t\"";
+			}
+			ostrm
+				<< ",\"args\":{\"value\":" << rec.theValue << "}"
+				<< "}";
+		}
+		ostrm << "\n],\"displayTimeUnit\":\"ns\"}\n";
+	}
+
+} // [trace]
+} // [peri]
+
+
+#	define PERI_TRACE_CAT2_(aa, bb) aa##bb
+#	define PERI_TRACE_CAT_(aa, bb) PERI_TRACE_CAT2_(aa, bb)
+
+#	define PERI_TRACE_BEG(name, value) \
+		peri::trace::record((name), peri::trace::Begin, (value))
+#	define PERI_TRACE_END(name, value) \
+		peri::trace::record((name), peri::trace::End, (value))
+#	define PERI_TRACE_MARK(name, value) \
+		peri::trace::record((name), peri::trace::Mark, (value))
+#	define PERI_TRACE_SCOPE(name, value) \
+		peri::trace::Scope const PERI_TRACE_CAT_(periTraceScope_, __LINE__) \
+			((name), (value))
+
+#else // i.e. ! defined(PERIDETIC_TRACE)
+
+#	define PERI_TRACE_BEG(name, value)
+#	define PERI_TRACE_END(name, value)
+#	define PERI_TRACE_MARK(name, value)
+#	define PERI_TRACE_SCOPE(name, value)
+
+#endif // PERIDETIC_TRACE
+
+
+#endif // periTrace_INCL_
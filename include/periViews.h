@@ -0,0 +1,289 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef periViews_INCL_
+#define periViews_INCL_
+
+
+#if ! (__cplusplus >= 202002L)
+#	error "periViews.h requires C++20 (use peridetic.h or periBatch.h)"
+#endif
+
+
+#include "periBatch.h"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
+
+/*! \brief Lazy range adaptors for transformation (optional, C++20).
+ *
+ * Adaptors compose with standard views so that a pipeline is evaluated
+ * in a single pass without intermediate containers, e.g.:
+ * \code
+ * auto highUps // (not const: iteration updates view state)
+ * 	{ xyzs
+ * 	| std::views::filter(isNearby)
+ * 	| peri::views::lpaForXyz(peri::model::GRS80)
+ * 	| std::views::filter([] (peri::LPA const & lpa) { return 0. < lpa[2]; })
+ * 	};
+ * for (peri::LPA const & lpa : highUps) { ... }
+ * \endcode
+ *
+ * Internally, elements are pulled from the source range into a small
+ * block (sBlockSize elements) that is transformed with the peri::batch
+ * functions, so both working buffers stay cache resident. The resulting
+ * views are input (single pass) ranges with elements of type
+ * std::array<double, 3u> (i.e. LPA or XYZ).
+ *
+ * \note Iterators refer to the view that created them. Once begin() has
+ * been called, the view must not be moved (or copied) while its
+ * iterators are in use (their parent pointer would then dangle).
+ */
+namespace peri::views
+{
+	//! Number of points transformed together
+	constexpr std::size_t sBlockSize{ 64u };
+
+	//! Batch transformation function signature (ref peri::batch)
+	using BatchFunc = void (*)
+		( std::array<double, 3u> const * const
+		, std::size_t const &
+		, std::array<double, 3u> * const
+		, EarthModel const &
+		);
+
+	//! View transforming blocks of elements of underlying view
+	template <std::ranges::input_range BaseView>
+		requires std::ranges::view<BaseView>
+	class BlockXformView
+		: public std::ranges::view_interface<BlockXformView<BaseView> >
+	{
+		using Triple = std::array<double, 3u>;
+
+		BaseView theBase{};
+		BatchFunc theFunc{ nullptr };
+		EarthModel const * thePtModel{ nullptr };
+
+		// state of (single pass) iteration
+		std::ranges::iterator_t<BaseView> theCurr{};
+		std::array<Triple, sBlockSize> theIns{};
+		std::array<Triple, sBlockSize> theOuts{};
+		std::size_t theNumOuts{ 0u };
+		std::size_t theNdx{ 0u };
+
+		//! Pull and transform next block (theNumOuts is 0 at end)
+		inline
+		void
+		fillBlock  // BlockXformView::
+			()
+		{
+			std::size_t num{ 0u };
+			while ((num < sBlockSize) && (theCurr != std::ranges::end(theBase)))
+			{
+				theIns[num++] = *theCurr;
+				++theCurr;
+			}
+			if (0u < num)
+			{
+				theFunc(theIns.data(), num, theOuts.data(), *thePtModel);
+			}
+			theNumOuts = num;
+			theNdx = 0u;
+		}
+
+	public:
+
+		//! Single pass iterator (refers to state within view)
+		class Iterator
+		{
+			BlockXformView * theParent{ nullptr };
+
+		public:
+
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Triple;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator
+				() = default;
+
+			explicit
+			Iterator
+				( BlockXformView * const & parent
+				)
+				: theParent{ parent }
+			{ }
+
+			inline
+			Triple const &
+			operator*
+				() const
+			{
+				return theParent->theOuts[theParent->theNdx];
+			}
+
+			inline
+			Iterator &
+			operator++
+				()
+			{
+				if (theParent->theNumOuts == ++(theParent->theNdx))
+				{
+					theParent->fillBlock();
+				}
+				return *this;
+			}
+
+			inline
+			void
+			operator++
+				(int)
+			{
+				++(*this);
+			}
+
+			//! True after last element
+			inline
+			bool
+			atEnd  // Iterator::
+				() const
+			{
+				return (0u == theParent->theNumOuts);
+			}
+
+			inline
+			friend
+			bool
+			operator==
+				( Iterator const & iter
+				, std::default_sentinel_t
+				)
+			{
+				return iter.atEnd();
+			}
+
+		}; // Iterator
+
+		BlockXformView
+			() = default;
+
+		//! View over base transforming each element with func
+		inline
+		explicit
+		BlockXformView
+			( BaseView base
+			, BatchFunc const & func
+			, EarthModel const & earthModel
+			)
+			: theBase{ std::move(base) }
+			, theFunc{ func }
+			, thePtModel{ &earthModel }
+		{ }
+
+		//! Start iteration (input range: call only once)
+		inline
+		Iterator
+		begin  // BlockXformView::
+			()
+		{
+			theCurr = std::ranges::begin(theBase);
+			fillBlock();
+			return Iterator{ this };
+		}
+
+		inline
+		std::default_sentinel_t
+		end  // BlockXformView::
+			() const
+		{
+			return std::default_sentinel;
+		}
+
+	}; // BlockXformView
+
+	//! Range adaptor closure: (range | adaptor) produces BlockXformView
+	struct BlockXformAdaptor
+	{
+		BatchFunc theFunc{ nullptr };
+		EarthModel const * thePtModel{ nullptr };
+
+		template <std::ranges::viewable_range Range>
+		inline
+		auto
+		operator()
+			( Range && range
+			) const
+		{
+			return BlockXformView<std::views::all_t<Range> >
+				(std::views::all(std::forward<Range>(range)), theFunc, *thePtModel);
+		}
+
+		template <std::ranges::viewable_range Range>
+		inline
+		friend
+		auto
+		operator|
+			( Range && range
+			, BlockXformAdaptor const & adaptor
+			)
+		{
+			return adaptor(std::forward<Range>(range));
+		}
+
+	}; // BlockXformAdaptor
+
+	//! Adaptor producing LPA values for each XYZ element of a range
+	inline
+	BlockXformAdaptor
+	lpaForXyz
+		( EarthModel const & earthModel = model::WGS84
+		)
+	{
+		return BlockXformAdaptor{ &batch::lpaForXyz, &earthModel };
+	}
+
+	//! Adaptor producing XYZ values for each LPA element of a range
+	inline
+	BlockXformAdaptor
+	xyzForLpa
+		( EarthModel const & earthModel = model::WGS84
+		)
+	{
+		return BlockXformAdaptor{ &batch::xyzForLpa, &earthModel };
+	}
+
+} // [peri::views]
+
+
+#endif // periViews_INCL_
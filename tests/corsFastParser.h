@@ -0,0 +1,328 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef cors_FastParser_INCL_
+#define cors_FastParser_INCL_
+
+
+#include "peridetic.h"
+
+#include "periLocal.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace peri::cors
+{
+	//! Coordinates decoded from one CORS/NGS report record
+	struct Station
+	{
+		XYZ theXYZ;
+		LPA theLPA;
+
+	}; // Station
+
+	/*! \brief Allocation free decoding of CORS/NGS coordinate report text.
+	 *
+	 * Same record syntax as DataParser::from() (ref corsDataPairs.h) but
+	 * decodes text in place (string_view over e.g. a file or memory map)
+	 * using std::from_chars and with DMS to radian conversion fused into
+	 * the decoding.
+	 */
+	class FastParser
+	{
+		char const * thePtr{ nullptr };
+		char const * theEnd{ nullptr };
+		char const * theRecBeg{ nullptr }; //!< start of most recent record
+
+		//! True for (ASCII) white space
+		inline
+		static
+		bool
+		isSpace  // FastParser::
+			( char const & chr
+			)
+		{
+			return ((' ' == chr) || ('\t' == chr) || ('\n' == chr)
+				|| ('\r' == chr) || ('\f' == chr) || ('\v' == chr));
+		}
+
+		//! Next white space delimited token (empty at end of text)
+		inline
+		std::string_view
+		token  // FastParser::
+			()
+		{
+			while ((thePtr < theEnd) && isSpace(*thePtr))
+			{
+				++thePtr;
+			}
+			char const * const beg{ thePtr };
+			while ((thePtr < theEnd) && (! isSpace(*thePtr)))
+			{
+				++thePtr;
+			}
+			return std::string_view
+				(beg, static_cast<std::size_t>(thePtr - beg));
+		}
+
+		//! Skip numTokens tokens (true if all were present)
+		inline
+		bool
+		skip  // FastParser::
+			( std::size_t const & numTokens
+			)
+		{
+			bool okay{ true };
+			for (std::size_t nn{0u} ; okay && (nn < numTokens) ; ++nn)
+			{
+				okay = (! token().empty());
+			}
+			return okay;
+		}
+
+		//! Decode entire next token as a number (true on success)
+		inline
+		bool
+		number  // FastParser::
+			( double * const & ptValue
+			)
+		{
+			std::string_view const tok{ token() };
+			char const * const end{ tok.data() + tok.size() };
+			std::from_chars_result const result
+				{ std::from_chars(tok.data(), end, *ptValue) };
+			return ((std::errc{} == result.ec) && (end == result.ptr));
+		}
+
+		//! Signed radian angle from "deg min sec dir" tokens (true on success)
+		inline
+		bool
+		angle  // FastParser::
+			( char const & negDir
+			, char const & posDir
+			, double * const & ptRad
+			)
+		{
+			double deg{}, min{}, sec{};
+			bool okay{ number(&deg) && number(&min) && number(&sec) };
+			if (okay)
+			{
+				std::string_view const dir{ token() };
+				okay =
+					(  (1u == dir.size())
+					&& ((negDir == dir[0]) || (posDir == dir[0]))
+					&& (! (deg < 0.)) && (deg <= 180.)
+					&& (! (min < 0.)) && (min <= 60.)
+					&& (! (sec < 0.)) && (sec <= 60.)
+					);
+				if (okay)
+				{
+					// same arithmetic as radMagFromDMS()
+					double const radMag{ (pi()/180.) * (deg + (min + sec/60.)/60.) };
+					*ptRad = (negDir == dir[0]) ? -radMag : radMag;
+				}
+			}
+			return okay;
+		}
+
+	public:
+
+		//! Attach to text (which must persist while parsing)
+		explicit
+		FastParser
+			( std::string_view const & text
+			)
+			: thePtr{ text.data() }
+			, theEnd{ text.data() + text.size() }
+		{ }
+
+		/*! \brief Decode the next record (false when no more records).
+		 *
+		 * Records start at "X =" and have the form (white space flexible)
+		 * "X = x m latitude = d m s N|S Y = y m longitude = d m s E|W
+		 *  Z = z m ellipsoid height = h m"
+		 *
+		 * A malformed record produces null values (ref isValid()).
+		 */
+		inline
+		bool
+		next  // FastParser::
+			( Station * const & ptStation
+			)
+		{
+			bool found{ false };
+			std::string_view const rest
+				{ thePtr, static_cast<std::size_t>(theEnd - thePtr) };
+			std::string_view::size_type const pos{ rest.find("X =") };
+			if (std::string_view::npos != pos)
+			{
+				found = true;
+				thePtr += pos;
+				theRecBeg = thePtr;
+				XYZ xyz{ xyz::sNull };
+				LPA lpa{ lpa::sNull };
+				bool const okay
+					{  skip(2u) && number(&xyz[0]) && skip(3u)
+					&& angle('S', 'N', &lpa[1])
+					&& skip(2u) && number(&xyz[1]) && skip(3u)
+					&& angle('W', 'E', &lpa[0])
+					&& skip(2u) && number(&xyz[2]) && skip(4u)
+					&& number(&lpa[2]) && skip(1u)
+					};
+				if (okay)
+				{
+					ptStation->theXYZ = xyz;
+					ptStation->theLPA = lpa;
+				}
+				else
+				{
+					ptStation->theXYZ = xyz::sNull;
+					ptStation->theLPA = lpa::sNull;
+					// resume search after the start of the bad record
+					thePtr = std::min(theEnd, rest.data() + pos + 1u);
+				}
+			}
+			else
+			{
+				thePtr = theEnd;
+			}
+			return found;
+		}
+
+		//! Start of text for record most recently decoded by next()
+		inline
+		char const *
+		recordBegin  // FastParser::
+			() const
+		{
+			return theRecBeg;
+		}
+
+		//! Call func(station) for each record in text (returns count)
+		template <typename Func>
+		inline
+		static
+		std::size_t
+		forEachIn  // FastParser::
+			( std::string_view const & text
+			, Func const & func
+			)
+		{
+			std::size_t count{ 0u };
+			FastParser parser(text);
+			Station station;
+			while (parser.next(&station))
+			{
+				func(station);
+				++count;
+			}
+			return count;
+		}
+
+		/*! \brief All records from text decoded in parallel chunks.
+		 *
+		 * Text is partitioned into numThreads portions. Each worker
+		 * decodes records that *start* within its portion (reading past
+		 * the end as needed). Results are returned in text order.
+		 */
+		inline
+		static
+		std::vector<Station>
+		allFrom  // FastParser::
+			( std::string_view const & text
+			, std::size_t const & numThreads = std::thread::hardware_concurrency()
+			)
+		{
+			std::size_t const numParts
+				{ std::max(std::size_t{ 1u }, std::min(numThreads, text.size())) };
+			std::size_t const sizePart{ (text.size() + numParts - 1u) / numParts };
+			std::vector<std::vector<Station> > partStations(numParts);
+			auto const work
+				{ [&text, &sizePart, &partStations] (std::size_t const & np)
+					{
+						std::size_t const beg{ std::min(text.size(), np * sizePart) };
+						std::size_t const end
+							{ std::min(text.size(), beg + sizePart) };
+						FastParser parser(text.substr(beg));
+						std::vector<Station> & stations = partStations[np];
+						stations.reserve((end - beg) / 256u + 1u);
+						Station station;
+						while (parser.next(&station))
+						{
+							// records beginning in next portion are not ours
+							std::size_t const at
+								{ static_cast<std::size_t>
+									(parser.recordBegin() - text.data())
+								};
+							if (! (at < end))
+							{
+								break;
+							}
+							stations.emplace_back(station);
+						}
+					}
+				};
+			std::vector<std::thread> threads;
+			for (std::size_t np{1u} ; np < numParts ; ++np)
+			{
+				threads.emplace_back(work, np);
+			}
+			work(0u);
+			for (std::thread & thread : threads)
+			{
+				thread.join();
+			}
+
+			std::size_t numAll{ 0u };
+			for (std::vector<Station> const & stations : partStations)
+			{
+				numAll += stations.size();
+			}
+			std::vector<Station> all;
+			all.reserve(numAll);
+			for (std::vector<Station> const & stations : partStations)
+			{
+				all.insert(all.end(), stations.cbegin(), stations.cend());
+			}
+			return all;
+		}
+
+	}; // FastParser
+
+} // [peri::cors]
+
+
+#endif // cors_FastParser_INCL_
@@ -35,8 +35,11 @@
 
 #include "periLocal.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -292,6 +295,285 @@ namespace peri::sim
 		return comboSamplesLpa(lonSamps, parSamps, altSamps);
 	}
 
+	//
+	// Lazy (index addressable) sample generators
+	//
+	// Each generator provides:
+	//  - value_type : type of generated samples (LPA or XYZ)
+	//  - size() : total number of samples
+	//  - valueAt(ndx) : sample for index (independent of any other)
+	// so that samples may be produced in chunks on demand (constant
+	// memory) and in parallel partitions (ref forEachChunk(),
+	// forEachChunkParallel()) with results independent of chunking.
+	//
+
+	//! Cartesian product of lon/par/alt values (same order as comboSamplesLpa)
+	struct GridGen
+	{
+		using value_type = LPA;
+
+		std::vector<double> theLons{};
+		std::vector<double> thePars{};
+		std::vector<double> theAlts{};
+
+		//! Generator matching bulkSamplesLpa() (without materializing it)
+		inline
+		static
+		GridGen
+		bulk  // GridGen::
+			( std::size_t const lonBulk = 8u
+			, std::size_t const parBulk = 8u
+			, std::size_t const altBulk = 8u
+			)
+		{
+			return GridGen
+				{ bulkSamplesLon(lonBulk)
+				, bulkSamplesPar(parBulk)
+				, bulkSamplesAlt(altBulk)
+				};
+		}
+
+		inline
+		std::size_t
+		size  // GridGen::
+			() const
+		{
+			return (theLons.size() * thePars.size() * theAlts.size());
+		}
+
+		inline
+		value_type
+		valueAt  // GridGen::
+			( std::size_t const & ndx
+			) const
+		{
+			std::size_t const numAlt{ theAlts.size() };
+			std::size_t const numPar{ thePars.size() };
+			std::size_t const ndxAlt{ ndx % numAlt };
+			std::size_t const ndxPar{ (ndx / numAlt) % numPar };
+			std::size_t const ndxLon{ ndx / (numAlt * numPar) };
+			return LPA{ theLons[ndxLon], thePars[ndxPar], theAlts[ndxAlt] };
+		}
+
+	}; // GridGen
+
+	//! Samples in meridian plane (same order as meridianPlaneSamples())
+	struct MeridianPlaneGen
+	{
+		using value_type = XYZ;
+
+		SampleSpec theRadSpec;
+		SampleSpec theParSpec;
+		double theLonVal{ .25*pi() };
+
+		inline
+		std::size_t
+		size  // MeridianPlaneGen::
+			() const
+		{
+			return (theParSpec.size() * theRadSpec.size());
+		}
+
+		inline
+		value_type
+		valueAt  // MeridianPlaneGen::
+			( std::size_t const & ndx
+			) const
+		{
+			std::size_t const numRad{ theRadSpec.size() };
+			double const parVal{ theParSpec.valueAtIndex(ndx / numRad) };
+			double const radVal{ theRadSpec.valueAtIndex(ndx % numRad) };
+			XYZ const xyzDir
+				{ std::cos(parVal) * std::cos(theLonVal)
+				, std::cos(parVal) * std::sin(theLonVal)
+				, std::sin(parVal)
+				};
+			return (radVal * xyzDir);
+		}
+
+	}; // MeridianPlaneGen
+
+	//! Pseudo random (uniform in lon/par/alt ranges, reproducible by index)
+	struct RandomGen
+	{
+		using value_type = LPA;
+
+		std::size_t theNumSamps{ 0u };
+		std::uint64_t theSeed{ 0u };
+		Range theLonRange{ sRangeLon };
+		Range theParRange{ sRangePar };
+		Range theAltRange{ -1.e+5, 1.e+5 };
+
+		//! Well mixed 64-bit value for key (SplitMix64 finalizer)
+		inline
+		static
+		std::uint64_t
+		mix  // RandomGen::
+			( std::uint64_t key
+			)
+		{
+			key += 0x9e3779b97f4a7c15u;
+			key = (key ^ (key >> 30u)) * 0xbf58476d1ce4e5b9u;
+			key = (key ^ (key >> 27u)) * 0x94d049bb133111ebu;
+			return (key ^ (key >> 31u));
+		}
+
+		//! Value in range for (ndx, component) pair
+		inline
+		double
+		valueIn  // RandomGen::
+			( Range const & range
+			, std::size_t const & ndx
+			, std::uint64_t const & comp
+			) const
+		{
+			std::uint64_t const bits
+				{ mix(theSeed ^ mix((std::uint64_t(ndx) << 2u) | comp)) };
+			// 53 random bits as fraction in [0,1)
+			double const frac{ double(bits >> 11u) * (1. / 9007199254740992.) };
+			return (range.first + frac * (range.second - range.first));
+		}
+
+		inline
+		std::size_t
+		size  // RandomGen::
+			() const
+		{
+			return theNumSamps;
+		}
+
+		inline
+		value_type
+		valueAt  // RandomGen::
+			( std::size_t const & ndx
+			) const
+		{
+			return LPA
+				{ valueIn(theLonRange, ndx, 0u)
+				, valueIn(theParRange, ndx, 1u)
+				, valueIn(theAltRange, ndx, 2u)
+				};
+		}
+
+	}; // RandomGen
+
+	//! Nearly uniform distribution over sphere (Fibonacci lattice)
+	struct FibonacciGen
+	{
+		using value_type = LPA;
+
+		std::size_t theNumSamps{ 0u };
+		double theAlt{ 0. };
+
+		inline
+		std::size_t
+		size  // FibonacciGen::
+			() const
+		{
+			return theNumSamps;
+		}
+
+		inline
+		value_type
+		valueAt  // FibonacciGen::
+			( std::size_t const & ndx
+			) const
+		{
+			// golden angle increment in longitude, equal area bands in z
+			double const goldenAngle{ pi() * (3. - std::sqrt(5.)) };
+			double const dNdx{ static_cast<double>(ndx) };
+			double const zVal
+				{ 1. - (2.*dNdx + 1.) / static_cast<double>(theNumSamps) };
+			double const par{ std::asin(zVal) };
+			double const lon{ principalAngle(goldenAngle * dNdx) };
+			return LPA{ lon, par, theAlt };
+		}
+
+	}; // FibonacciGen
+
+	//! Index range [first,second) for part (of numParts) of numSamps
+	inline
+	std::pair<std::size_t, std::size_t>
+	partition
+		( std::size_t const & numSamps
+		, std::size_t const & numParts
+		, std::size_t const & part
+		)
+	{
+		std::size_t const numPer{ numSamps / numParts };
+		std::size_t const numExtra{ numSamps % numParts };
+		// first numExtra parts have one extra element
+		std::size_t const beg{ part*numPer + std::min(part, numExtra) };
+		std::size_t const end{ beg + numPer + ((part < numExtra) ? 1u : 0u) };
+		return { beg, end };
+	}
+
+	/*! \brief Call func(samps, num, begNdx) for chunks of [beg,end) samples.
+	 *
+	 * Samples are generated into a (reused) buffer of chunkSize elements,
+	 * so memory use is constant regardless of generator size.
+	 */
+	template <typename Gen, typename Func>
+	inline
+	void
+	forEachChunk
+		( Gen const & gen
+		, std::size_t const & chunkSize
+		, Func const & func
+		, std::size_t const & beg = 0u
+		, std::size_t const & end = std::numeric_limits<std::size_t>::max()
+		)
+	{
+		using Value = typename Gen::value_type;
+		std::size_t const useEnd{ std::min(end, gen.size()) };
+		std::vector<Value> buf(std::max(std::size_t{ 1u }, chunkSize));
+		for (std::size_t chunkBeg{beg} ; chunkBeg < useEnd ; chunkBeg += buf.size())
+		{
+			std::size_t const num{ std::min(buf.size(), useEnd - chunkBeg) };
+			for (std::size_t nn{0u} ; nn < num ; ++nn)
+			{
+				buf[nn] = gen.valueAt(chunkBeg + nn);
+			}
+			func(buf.data(), num, chunkBeg);
+		}
+	}
+
+	/*! \brief Chunked generation over numThreads parallel partitions.
+	 *
+	 * Each thread processes a contiguous partition (ref partition()) in
+	 * chunks. Note func() is called concurrently from multiple threads.
+	 */
+	template <typename Gen, typename Func>
+	inline
+	void
+	forEachChunkParallel
+		( Gen const & gen
+		, std::size_t const & chunkSize
+		, std::size_t const & numThreads
+		, Func const & func
+		)
+	{
+		std::size_t const numParts{ std::max(std::size_t{ 1u }, numThreads) };
+		std::vector<std::thread> threads;
+		threads.reserve(numParts);
+		for (std::size_t part{0u} ; part < numParts ; ++part)
+		{
+			std::pair<std::size_t, std::size_t> const begEnd
+				{ partition(gen.size(), numParts, part) };
+			threads.emplace_back
+				( [&gen, &chunkSize, &func, begEnd] ()
+					{
+						forEachChunk
+							(gen, chunkSize, func, begEnd.first, begEnd.second);
+					}
+				);
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+	}
+
 } // [peri::sim]
 
 #endif // peri_Sim_INCL_
@@ -0,0 +1,595 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periBatch.h"
+#include "periBounds.h"
+#include "periCache.h"
+#include "periIncrement.h"
+#include "periInterval.h"
+#include "periPipeline.h"
+#include "periReorder.h"
+
+#if defined(PERIDETIC_HAVE_DISPATCH)
+#	include "periDispatch.h"
+#endif
+
+#include "corsDataPairs.h"
+#include "corsDataParser.h"
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Number of calls to (any form of) global operator new
+	std::atomic<std::size_t> sNumAllocs{ 0u };
+
+	//! Allocate with counting - used by all the replacement operators
+	void *
+	countedAlloc
+		( std::size_t const & size
+		, std::size_t const & align = 0u
+		)
+	{
+		sNumAllocs.fetch_add(1u, std::memory_order_relaxed);
+		std::size_t const useSize{ (0u < size) ? size : 1u };
+		void * ptr{ nullptr };
+		if (0u < align)
+		{
+			// aligned_alloc requires size to be a multiple of alignment
+			std::size_t const fullSize{ ((useSize + align - 1u) / align) * align };
+			ptr = std::aligned_alloc(align, fullSize);
+		}
+		else
+		{
+			ptr = std::malloc(useSize);
+		}
+		if (! ptr)
+		{
+			throw std::bad_alloc{};
+		}
+		return ptr;
+	}
+
+} // [annon]
+
+
+// Replacements for global allocation functions (array and nothrow forms
+// forward to these by default, so all are counted).
+
+void *
+operator new
+	( std::size_t size
+	)
+{
+	return countedAlloc(size);
+}
+
+void *
+operator new
+	( std::size_t size
+	, std::align_val_t align
+	)
+{
+	return countedAlloc(size, static_cast<std::size_t>(align));
+}
+
+void
+operator delete
+	( void * ptr
+	) noexcept
+{
+	std::free(ptr);
+}
+
+void
+operator delete
+	( void * ptr
+	, std::size_t // size
+	) noexcept
+{
+	std::free(ptr);
+}
+
+void
+operator delete
+	( void * ptr
+	, std::align_val_t // align
+	) noexcept
+{
+	std::free(ptr);
+}
+
+void
+operator delete
+	( void * ptr
+	, std::size_t // size
+	, std::align_val_t // align
+	) noexcept
+{
+	std::free(ptr);
+}
+
+
+namespace
+{
+	//! Number of allocations made while performing func()
+	template <typename Func>
+	inline
+	std::size_t
+	allocsDuring
+		( Func const & func
+		)
+	{
+		std::size_t const beg{ sNumAllocs.load() };
+		func();
+		std::size_t const end{ sNumAllocs.load() };
+		return (end - beg);
+	}
+
+	//! Report allocation count (and number per item) for a utility
+	inline
+	void
+	report
+		( std::string const & name
+		, std::size_t const & numAllocs
+		, std::size_t const & numItems
+		)
+	{
+		std::cout
+			<< std::setw(32) << name
+			<< " numItems: " << std::setw(8) << numItems
+			<< " numAllocs: " << std::setw(8) << numAllocs
+			<< " perItem: " << std::fixed << std::setprecision(2)
+				<< std::setw(8)
+				<< (double(numAllocs) / double(std::max(numItems, std::size_t{ 1u })))
+			<< '\n';
+	}
+
+	//! Check that the counting mechanism itself is active
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		std::size_t const gotAllocs
+			{ allocsDuring
+				( [] ()
+					{
+						std::vector<double> const values(1024u, 0.);
+						std::string const text(1024u, 'x');
+						if (! (values.size() == text.size()))
+						{
+							std::cerr << "Unexpected size mismatch" << '\n';
+						}
+					}
+				)
+			};
+		if (! (2u == gotAllocs))
+		{
+			std::cerr << "Failure of allocation counting test" << '\n';
+			std::cerr << "exp: " << 2u << '\n';
+			std::cerr << "got: " << gotAllocs << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check that transformation functions perform no allocations
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		// (allocations here are outside of the measured code)
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(31u, 37u, 11u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<peri::XYZ> xyzs(numPnts);
+		std::vector<peri::LPA> gotLPAs(numPnts);
+		std::vector<peri::EarthModel const *> const earthPtrs
+			{ &peri::model::WGS84, &peri::model::GRS80 };
+
+		// polar axis (longitude fallback) and earth center cases
+		std::vector<peri::XYZ> const xyzSpecials
+			{ { 0., 0., 6400000. }
+			, { 0., 0., -6300000. }
+			, { 0., 0., 0. }
+			};
+
+		// workspace for variations of batch functions
+		using peri::batch::FixedScale;
+		FixedScale const lpaFix{ FixedScale::lpaDegE7Mm() };
+		FixedScale const xyzFix{ FixedScale::xyzMm() };
+		// (int64 since Cartesian [mm] values exceed int32 range)
+		std::vector<std::int64_t> lpaInts(3u * numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				lpaInts[3u*nn + nc] = static_cast<std::int64_t>
+					(std::round(lpas[nn][nc] / lpaFix.theScales[nc]));
+			}
+		}
+		std::vector<std::int64_t> xyzInts(3u * numPnts);
+		std::vector<std::int64_t> gotInts(3u * numPnts);
+		std::vector<peri::LPA> gotOthers(numPnts);
+		std::vector<float> highs(3u * numPnts);
+		std::vector<float> lows(3u * numPnts);
+		peri::XYZ const origin{ -1288000., -4720000., 4080000. };
+
+		struct Check
+		{
+			std::string const theName;
+			std::size_t const theNumAllocs;
+		};
+		std::vector<Check> checks;
+		checks.reserve(32u);
+
+		checks.emplace_back(Check{ "peri::xyzForLpa/lpaForXyz", allocsDuring
+			( [&] ()
+				{
+					for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+					{
+						xyzs[nn] = peri::xyzForLpa(lpas[nn]);
+						gotLPAs[nn] = peri::lpaForXyz(xyzs[nn]);
+					}
+					for (peri::XYZ const & xyzSpecial : xyzSpecials)
+					{
+						gotLPAs[0] = peri::lpaForXyz(xyzSpecial);
+					}
+				}
+			) } );
+
+		for (peri::EarthModel const * const & ptEarth : earthPtrs)
+		{
+			checks.emplace_back(Check{ "EarthModel::xyzForLpa/lpaForXyz"
+				, allocsDuring
+				( [&] ()
+					{
+						for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+						{
+							xyzs[nn] = ptEarth->xyzForLpa(lpas[nn]);
+							gotLPAs[nn] = ptEarth->lpaForXyz(xyzs[nn]);
+						}
+					}
+				) } );
+
+			checks.emplace_back(Check{ "batch::xyzForLpa/lpaForXyz"
+				, allocsDuring
+				( [&] ()
+					{
+						peri::batch::xyzForLpa
+							(lpas.data(), numPnts, xyzs.data(), *ptEarth);
+						peri::batch::lpaForXyz
+							(xyzs.data(), numPnts, gotLPAs.data(), *ptEarth);
+						peri::batch::lpaForXyz
+							( xyzSpecials.data(), xyzSpecials.size()
+							, gotLPAs.data(), *ptEarth
+							);
+					}
+				) } );
+
+			checks.emplace_back(Check{ "batch::*Strided"
+				, allocsDuring
+				( [&] ()
+					{
+						peri::batch::xyzForLpaStrided
+							( lpas.data(), sizeof(peri::LPA), numPnts
+							, xyzs.data(), sizeof(peri::XYZ), *ptEarth
+							);
+						peri::batch::lpaForXyzStrided
+							( xyzs.data(), sizeof(peri::XYZ), numPnts
+							, gotLPAs.data(), sizeof(peri::LPA), *ptEarth
+							);
+					}
+				) } );
+
+			checks.emplace_back(Check{ "batch::*Fixed"
+				, allocsDuring
+				( [&] ()
+					{
+						peri::batch::xyzForLpaFixed
+							( lpaInts.data(), lpaFix, numPnts
+							, xyzInts.data(), xyzFix, *ptEarth
+							);
+						peri::batch::lpaForXyzFixed
+							( xyzInts.data(), xyzFix, numPnts
+							, gotInts.data(), lpaFix, *ptEarth
+							);
+					}
+				) } );
+
+			checks.emplace_back(Check{ "batch::xyzForLpaRelative*"
+				, allocsDuring
+				( [&] ()
+					{
+						peri::batch::xyzForLpaRelative
+							(lpas.data(), numPnts, origin, highs.data(), *ptEarth);
+						peri::batch::xyzForLpaRelativeSplit
+							( lpas.data(), numPnts, origin
+							, highs.data(), lows.data(), *ptEarth
+							);
+					}
+				) } );
+
+			checks.emplace_back(Check{ "batch::lpaForXyzPair"
+				, allocsDuring
+				( [&] ()
+					{
+						peri::batch::lpaForXyzPair
+							( xyzs.data(), numPnts, gotLPAs.data(), gotOthers.data()
+							, *ptEarth, peri::model::GRS80
+							);
+					}
+				) } );
+		}
+
+		// pipeline stages constructed outside of measured code
+		using namespace peri::pipeline;
+		auto const pipe
+			{ make
+				( Geodetic(peri::model::WGS84)
+				, Offset(Triple{{ 1., .5, 0. }})
+				, Quantize<std::int32_t>(lpaFix)
+				)
+			};
+		std::vector<std::array<std::int32_t, 3u> > pipeInts(numPnts);
+		checks.emplace_back(Check{ "pipeline::Pipeline::run"
+			, allocsDuring
+			( [&] ()
+				{
+					pipe.run(xyzs.data(), numPnts, pipeInts.data());
+				}
+			) } );
+
+		// incremental updates (states created outside of measured code)
+		peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data());
+		std::vector<peri::increment::State> states;
+		states.reserve(numPnts);
+		for (peri::XYZ const & xyz : xyzs)
+		{
+			states.emplace_back(peri::increment::stateFor(xyz));
+		}
+		std::vector<peri::XYZ> xyzMoves(xyzs);
+		for (peri::XYZ & xyzMove : xyzMoves)
+		{
+			xyzMove[0] += .125;
+		}
+		checks.emplace_back(Check{ "increment::lpaForXyz"
+			, allocsDuring
+			( [&] ()
+				{
+					peri::increment::lpaForXyz
+						( states.data(), xyzMoves.data(), numPnts
+						, gotLPAs.data()
+						);
+				}
+			) } );
+
+		// warm started conversion (Morton order computed outside)
+		std::vector<std::size_t> const order
+			{ peri::reorder::mortonOrderFor(xyzs.data(), numPnts) };
+		checks.emplace_back(Check{ "reorder::lpaForXyzWarm"
+			, allocsDuring
+			( [&] ()
+				{
+					peri::reorder::lpaForXyzWarm
+						(xyzs.data(), numPnts, gotLPAs.data());
+					peri::reorder::lpaForXyzWarm
+						( xyzs.data(), numPnts, gotLPAs.data()
+						, peri::model::WGS84, order.data()
+						);
+				}
+			) } );
+
+		// cache lookups (tables allocated at construction)
+		peri::cache::Memo memo(256u);
+		checks.emplace_back(Check{ "cache::Memo::*For*"
+			, allocsDuring
+			( [&] ()
+				{
+					// (more points than entries: both hits and misses)
+					for (std::size_t pass{0u} ; pass < 2u ; ++pass)
+					{
+						for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+						{
+							xyzs[nn] = memo.xyzForLpa(lpas[nn]);
+							gotLPAs[nn] = memo.lpaForXyz(xyzs[nn]);
+						}
+					}
+				}
+			) } );
+
+		// box transformations (including boxes containing earth center)
+		using peri::interval::Box;
+		std::vector<Box> const xyzBoxes
+			{ Box{{ { 1.e+6, 1.1e+6 }, { -5.e+6, -4.9e+6 }, { 3.e+6, 4.e+6 } }}
+			, Box{{ { -1.e+3, 2.e+3 }, { -2.e+3, 1.e+3 }, { 6.35e+6, 6.36e+6 } }}
+			, Box{{ { -7.e+6, 7.e+6 }, { -7.e+6, 7.e+6 }, { -7.e+6, 7.e+6 } }}
+			};
+		std::vector<Box> lpaCells(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::LPA const & lpa = lpas[nn];
+			lpaCells[nn] = Box
+				{{ { lpa[0], lpa[0] + .01 }
+				,  { lpa[1] - .01, lpa[1] }
+				,  { lpa[2], lpa[2] + 100. }
+				}};
+		}
+		std::vector<Box> gotBoxes(numPnts);
+		checks.emplace_back(Check{ "interval::*BoxFor*Box"
+			, allocsDuring
+			( [&] ()
+				{
+					for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+					{
+						gotBoxes[nn] = peri::interval::xyzBoxForLpaBox
+							(lpaCells[nn]);
+					}
+					for (Box const & xyzBox : xyzBoxes)
+					{
+						gotBoxes[0] = peri::interval::lpaBoxForXyzBox(xyzBox);
+					}
+				}
+			) } );
+		checks.emplace_back(Check{ "bounds::xyzBoxFor/xyzBoxesFor"
+			, allocsDuring
+			( [&] ()
+				{
+					gotBoxes[0] = peri::bounds::xyzBoxFor(lpaCells[0]);
+					peri::bounds::xyzBoxesFor
+						(lpaCells.data(), numPnts, gotBoxes.data());
+				}
+			) } );
+
+#		if defined(PERIDETIC_HAVE_DISPATCH)
+		checks.emplace_back(Check{ "dispatch::xyzForLpa/lpaForXyz"
+			, allocsDuring
+			( [&] ()
+				{
+					peri::dispatch::xyzForLpa(lpas.data(), numPnts, xyzs.data());
+					peri::dispatch::lpaForXyz
+						(xyzs.data(), numPnts, gotLPAs.data());
+				}
+			) } );
+#		endif
+
+		// Not checked (these allocate or create threads by design):
+		// - reorder::lpaForXyzReordered() - allocates the Morton order
+		// - bounds::lpaBoxFor() - parallel reduction (threads)
+		// - Plan::execute() - may run in parallel (threads)
+
+		for (Check const & check : checks)
+		{
+			report(check.theName, check.theNumAllocs, numPnts);
+			if (! (0u == check.theNumAllocs))
+			{
+				std::cerr << "Failure of zero allocation test" << '\n';
+				std::cerr << "  function: " << check.theName << '\n';
+				std::cerr << " numAllocs: " << check.theNumAllocs << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Report allocations by test/development utilities (informational)
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::LPA> lpas;
+		std::size_t const numSim{ allocsDuring
+			( [&lpas] ()
+				{ lpas = peri::sim::bulkSamplesLpa(31u, 37u, 11u); }
+			) };
+		report("peri::sim::bulkSamplesLpa", numSim, lpas.size());
+
+		std::vector<peri::XYZ> xyzs;
+		std::size_t const numMer{ allocsDuring
+			( [&xyzs] ()
+				{
+					using namespace peri::sim;
+					SampleSpec const radSpec{ 32u, Range{ 6.3e6, 6.4e6 } };
+					SampleSpec const parSpec
+						{ 32u, Range{ -.5*peri::pi(), .5*peri::pi() } };
+					xyzs = meridianPlaneSamples(radSpec, parSpec);
+				}
+			) };
+		report("peri::sim::meridianPlaneSamples", numMer, xyzs.size());
+
+		std::size_t numChars{ 0u };
+		std::size_t const numInfo{ allocsDuring
+			( [&lpas, &numChars] ()
+				{
+					for (peri::LPA const & lpa : lpas)
+					{
+						numChars += peri::lpa::infoString(lpa, "lpa").size();
+					}
+				}
+			) };
+		report("peri::lpa::infoString", numInfo, lpas.size());
+
+		std::vector<std::string> const & texts = peri::cors::sStationTexts;
+		double sumAlt{ 0. };
+		std::size_t const numParse{ allocsDuring
+			( [&texts, &sumAlt] ()
+				{
+					for (std::string const & text : texts)
+					{
+						sumAlt += peri::cors::DataParser::from(text).theLPA[2];
+					}
+				}
+			) };
+		report("peri::cors::DataParser::from", numParse, texts.size());
+
+		// sanity check that work was done (and was not optimized away)
+		if (! ((0u < numChars) && (0. < sumAlt)))
+		{
+			std::cerr << "Failure of utility work check" << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+}
+
+
+//! Check heap allocation behavior (counted via replacement operator new)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // counting is active
+	errCount += test1(); // transforms allocate nothing
+	errCount += test2(); // report utility allocations
+	return errCount;
+}
@@ -0,0 +1,401 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periBatch.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+	//! Check batch transformations produce same values as scalar ones
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		std::vector<peri::LPA> const expLPAs
+			{ peri::sim::bulkSamplesLpa(17u, 19u, 23u) };
+		std::size_t const numPnts{ expLPAs.size() };
+
+		std::vector<peri::XYZ> gotXYZs(numPnts);
+		peri::batch::xyzForLpa
+			(expLPAs.data(), numPnts, gotXYZs.data(), earth);
+		std::vector<peri::LPA> gotLPAs(numPnts);
+		peri::batch::lpaForXyz
+			(gotXYZs.data(), numPnts, gotLPAs.data(), earth);
+
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::XYZ const expXYZ{ peri::xyzForLpa(expLPAs[nn], earth) };
+			peri::LPA const expLPA{ peri::lpaForXyz(expXYZ, earth) };
+			// batch evaluation should be identical to scalar
+			if (! ((gotXYZs[nn] == expXYZ) && (gotLPAs[nn] == expLPA)))
+			{
+				std::cerr << "Failure of batch/scalar test" << '\n';
+				std::cerr << peri::xyz::infoString(expXYZ, "expXYZ") << '\n';
+				std::cerr << peri::xyz::infoString(gotXYZs[nn], "gotXYZ") << '\n';
+				std::cerr << peri::lpa::infoString(expLPA, "expLPA") << '\n';
+				std::cerr << peri::lpa::infoString(gotLPAs[nn], "gotLPA") << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check in-place batch transformation (output same as input)
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::LPA> const expLPAs
+			{ peri::sim::bulkSamplesLpa(7u, 11u, 5u) };
+		std::vector<std::array<double, 3u> > values(expLPAs);
+		peri::batch::xyzForLpa(values.data(), values.size(), values.data());
+		peri::batch::lpaForXyz(values.data(), values.size(), values.data());
+
+		for (std::size_t nn{0u} ; nn < values.size() ; ++nn)
+		{
+			peri::LPA const expLPA
+				{ peri::lpaForXyz(peri::xyzForLpa(expLPAs[nn])) };
+			if (! (values[nn] == expLPA))
+			{
+				std::cerr << "Failure of in-place batch test" << '\n';
+				std::cerr << peri::lpa::infoString(expLPA, "expLPA") << '\n';
+				std::cerr << peri::lpa::infoString(values[nn], "gotLPA") << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		// zero size should be a no-op (with null pointers)
+		peri::batch::lpaForXyz(nullptr, 0u, nullptr);
+		peri::batch::xyzForLpa(nullptr, 0u, nullptr);
+
+		return errCount;
+	}
+
+	//! Check strided transformation of fields within (40-byte) records
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		// packed 40-byte record (with XYZ at unaligned offset 4)
+#		pragma pack(push, 1)
+		struct Record
+		{
+			float theIntensity;
+			double theLoc[3];
+			double theTime;
+			std::uint8_t theClass[4];
+		};
+#		pragma pack(pop)
+		static_assert(40u == sizeof(Record), "unexpected Record size");
+
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(11u, 7u, 5u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<Record> recs(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			Record & rec = recs[nn];
+			rec.theIntensity = static_cast<float>(nn);
+			std::memcpy(rec.theLoc, lpas[nn].data(), sizeof(rec.theLoc));
+			rec.theTime = -static_cast<double>(nn);
+			rec.theClass[0] = rec.theClass[3] = 0x5a;
+		}
+
+		// from contiguous LPA into records, then in place within records
+		peri::batch::xyzForLpaStrided
+			( lpas.data(), sizeof(peri::LPA), numPnts
+			, &(recs[0].theLoc), sizeof(Record)
+			);
+		peri::batch::lpaForXyzStrided
+			( &(recs[0].theLoc), sizeof(Record), numPnts
+			, &(recs[0].theLoc), sizeof(Record)
+			);
+
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			Record const & rec = recs[nn];
+			peri::LPA const expLPA
+				{ peri::lpaForXyz(peri::xyzForLpa(lpas[nn])) };
+			peri::LPA gotLPA;
+			std::memcpy(gotLPA.data(), rec.theLoc, sizeof(gotLPA));
+			bool const okayOther
+				{  (static_cast<float>(nn) == rec.theIntensity)
+				&& (-static_cast<double>(nn) == rec.theTime)
+				&& (0x5a == rec.theClass[0])
+				&& (0x5a == rec.theClass[3])
+				};
+			if (! ((expLPA == gotLPA) && okayOther))
+			{
+				std::cerr << "Failure of strided batch test" << '\n';
+				std::cerr << peri::lpa::infoString(expLPA, "expLPA") << '\n';
+				std::cerr << peri::lpa::infoString(gotLPA, "gotLPA") << '\n';
+				std::cerr << "okayOther: " << okayOther << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check fixed point (scaled integer) transformations
+	int
+	test3
+		()
+	{
+		int errCount{ 0 };
+
+		using peri::batch::FixedScale;
+		FixedScale const lpaFix{ FixedScale::lpaDegE7Mm() };
+		peri::XYZ const origin{ -1288000., -4720000., 4080000. };
+		FixedScale const xyzFix{ FixedScale::xyzMm(origin) };
+
+		// int32 lon/lat [1e-7 deg] and alt [mm] near origin
+		std::vector<std::int32_t> lpaInts;
+		for (std::int32_t nn{0} ; nn < 1000 ; ++nn)
+		{
+			lpaInts.emplace_back(-1052700000 + 37*nn);
+			lpaInts.emplace_back(  400100000 - 53*nn);
+			lpaInts.emplace_back(    1600000 + 7919*nn);
+		}
+		std::size_t const numPnts{ lpaInts.size() / 3u };
+
+		// expected values: by way of double values and scalar functions
+		auto const valueFor
+			{ [] (FixedScale const & fix, std::int32_t const * ints)
+				{
+					return std::array<double, 3u>
+						{ fix.theOffsets[0] + fix.theScales[0] * double(ints[0])
+						, fix.theOffsets[1] + fix.theScales[1] * double(ints[1])
+						, fix.theOffsets[2] + fix.theScales[2] * double(ints[2])
+						};
+				}
+			};
+
+		std::vector<std::int32_t> xyzInts(3u * numPnts);
+		peri::batch::xyzForLpaFixed
+			(lpaInts.data(), lpaFix, numPnts, xyzInts.data(), xyzFix);
+		std::vector<std::int32_t> gotInts(3u * numPnts);
+		peri::batch::lpaForXyzFixed
+			(xyzInts.data(), xyzFix, numPnts, gotInts.data(), lpaFix);
+
+		// results within 1/2 integer step of double precision evaluation
+		std::size_t numClose{ 0u };
+		std::size_t numBad{ 0u };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::XYZ const xyz
+				{ peri::xyzForLpa(valueFor(lpaFix, lpaInts.data() + 3u*nn)) };
+			peri::LPA const lpa
+				{ peri::lpaForXyz(valueFor(xyzFix, xyzInts.data() + 3u*nn)) };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				std::size_t const ndx{ 3u*nn + nc };
+				double const expX{ (xyz[nc] - origin[nc]) / xyzFix.theScales[nc] };
+				double const expL{ lpa[nc] / lpaFix.theScales[nc] };
+				double const errX{ std::abs(double(xyzInts[ndx]) - expX) };
+				double const errL{ std::abs(double(gotInts[ndx]) - expL) };
+				if ((.5 + 1.e-6 < errX) || (.5 + 1.e-6 < errL))
+				{
+					++numBad;
+				}
+				// round trip to input values (within mm quantization)
+				if (std::abs(lpaInts[ndx] - gotInts[ndx]) < 2)
+				{
+					++numClose;
+				}
+			}
+		}
+
+		if (! ((0u == numBad) && ((3u * numPnts) == numClose)))
+		{
+			std::cerr << "Failure of fixed point transform test" << '\n';
+			std::cerr << "numBad: " << numBad << '\n';
+			std::cerr << "numClose: " << numClose
+				<< " of " << (3u * numPnts) << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check relative-to-center float output
+	int
+	test4
+		()
+	{
+		int errCount{ 0 };
+
+		// tile of about 10 [km] near 40N 105W
+		peri::LPA const lpaCenter
+			{ peri::radForDeg(-105.), peri::radForDeg(40.), 1600. };
+		peri::XYZ const origin{ peri::xyzForLpa(lpaCenter) };
+		std::vector<peri::LPA> lpas;
+		for (std::size_t nn{0u} ; nn < 500u ; ++nn)
+		{
+			double const frac{ double(nn) / 500. - .5 };
+			lpas.emplace_back(peri::LPA
+				{ lpaCenter[0] + 1.e-3 * frac
+				, lpaCenter[1] - 7.e-4 * frac
+				, lpaCenter[2] + 300. * frac
+				});
+		}
+		std::size_t const numPnts{ lpas.size() };
+
+		std::vector<float> rels(3u * numPnts);
+		peri::batch::xyzForLpaRelative
+			(lpas.data(), numPnts, origin, rels.data());
+		std::vector<float> highs(3u * numPnts);
+		std::vector<float> lows(3u * numPnts);
+		peri::batch::xyzForLpaRelativeSplit
+			(lpas.data(), numPnts, origin, highs.data(), lows.data());
+
+		double maxErrRel{ 0. };
+		double maxErrSplit{ 0. };
+		bool sameHigh{ true };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::XYZ const xyz{ peri::xyzForLpa(lpas[nn]) };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				std::size_t const ndx{ 3u*nn + nc };
+				double const expOffset{ xyz[nc] - origin[nc] };
+				double const errRel{ std::abs(double(rels[ndx]) - expOffset) };
+				double const gotSplit{ double(highs[ndx]) + double(lows[ndx]) };
+				double const errSplit{ std::abs(gotSplit - expOffset) };
+				maxErrRel = std::max(maxErrRel, errRel);
+				maxErrSplit = std::max(maxErrSplit, errSplit);
+				sameHigh = sameHigh && (rels[ndx] == highs[ndx]);
+			}
+		}
+
+		// float precision on ~5 [km] offsets vs ~ 1e-9 for split pairs
+		constexpr double tolRel{ 5.e-4 };
+		constexpr double tolSplit{ 1.e-9 };
+		if (! ((maxErrRel < tolRel) && (maxErrSplit < tolSplit) && sameHigh))
+		{
+			std::cerr << "Failure of relative-to-center float test" << '\n';
+			std::cerr << "maxErrRel: " << maxErrRel << '\n';
+			std::cerr << "maxErrSplit: " << maxErrSplit << '\n';
+			std::cerr << "sameHigh: " << sameHigh << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check single pass conversion for two Earth models
+	int
+	test5
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earthA = peri::model::WGS84;
+		peri::EarthModel const & earthB = peri::model::GRS80;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(16u, 16u, 8u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<peri::XYZ> xyzs(numPnts);
+		peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data(), earthA);
+
+		std::vector<peri::LPA> gotAs(numPnts);
+		std::vector<peri::LPA> gotBs(numPnts);
+		peri::batch::lpaForXyzPair
+			(xyzs.data(), numPnts, gotAs.data(), gotBs.data(), earthA, earthB);
+
+		std::size_t numBad{ 0u };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::LPA const expA{ peri::lpaForXyz(xyzs[nn], earthA) };
+			peri::LPA const expB{ peri::lpaForXyz(xyzs[nn], earthB) };
+			bool const okay
+				{  peri::lpa::sameEnough(gotAs[nn], expA, 1.e-14, 1.e-8)
+				&& peri::lpa::sameEnough(gotBs[nn], expB, 1.e-14, 1.e-8)
+				};
+			if (! okay)
+			{
+				if (0u == numBad)
+				{
+					std::cerr << "Failure of two model batch test" << '\n';
+					std::cerr << "expA: " << peri::lpa::infoString(expA) << '\n';
+					std::cerr << "gotA: " << peri::lpa::infoString(gotAs[nn]) << '\n';
+					std::cerr << "expB: " << peri::lpa::infoString(expB) << '\n';
+					std::cerr << "gotB: " << peri::lpa::infoString(gotBs[nn]) << '\n';
+				}
+				++numBad;
+			}
+		}
+		if (0u < numBad)
+		{
+			std::cerr << "numBad: " << numBad << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+}
+
+
+//! Check batch transformation functions
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // batch same as scalar
+	errCount += test1(); // in-place batch operation
+	errCount += test2(); // strided records
+	errCount += test3(); // fixed point integer data
+	errCount += test4(); // relative-to-center float output
+	errCount += test5(); // single pass for two Earth models
+	return errCount;
+}
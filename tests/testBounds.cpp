@@ -0,0 +1,329 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periBounds.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+
+namespace
+{
+	using peri::interval::Box;
+	using peri::interval::Interval;
+
+	//! Extremes found by converting every point (lon range in [-pi,pi))
+	inline
+	Box
+	bruteLpaBox
+		( std::vector<peri::XYZ> const & xyzs
+		, peri::EarthModel const & earth
+		, bool const & wrapLon
+		)
+	{
+		double const big{ std::numeric_limits<double>::max() };
+		Box box
+			{{ Interval{ big, -big }
+			,  Interval{ big, -big }
+			,  Interval{ big, -big }
+			}};
+		for (peri::XYZ const & xyz : xyzs)
+		{
+			peri::LPA lpa{ earth.lpaForXyz(xyz) };
+			if (wrapLon && (lpa[0] < 0.))
+			{
+				lpa[0] += peri::sTwoPi;
+			}
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				box[nc].theMin = std::min(box[nc].theMin, lpa[nc]);
+				box[nc].theMax = std::max(box[nc].theMax, lpa[nc]);
+			}
+		}
+		return box;
+	}
+
+	//! True if boxes are identical
+	inline
+	bool
+	sameBox
+		( Box const & boxA
+		, Box const & boxB
+		)
+	{
+		bool same{ true };
+		for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+		{
+			same &= (boxA[nc].theMin == boxB[nc].theMin);
+			same &= (boxA[nc].theMax == boxB[nc].theMax);
+		}
+		return same;
+	}
+
+	//! Report box values
+	inline
+	void
+	showBox
+		( Box const & box
+		, std::string const & title
+		)
+	{
+		std::cerr << title << '\n';
+		std::cerr.precision(17);
+		for (Interval const & range : box)
+		{
+			std::cerr << "  " << range.theMin << ' ' << range.theMax << '\n';
+		}
+	}
+
+	//! Check extremes agree with brute force (and that points are pruned)
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		struct Case
+		{
+			peri::sim::RandomGen theGen;
+			bool theWrapLon;
+		};
+		std::vector<Case> const cases
+			{ // regional cloud (e.g. a survey tile)
+			  { peri::sim::RandomGen
+				{ 100000u, 41u, { .5, .6 }, { .7, .75 }, { -100., 900. } }
+			  , false
+			  }
+			, // cloud straddling the anti-meridian
+			  { peri::sim::RandomGen
+				{ 100000u, 43u, { 3.1, 3.2 }, { -.3, -.2 }, { -50., 50. } }
+			  , true
+			  }
+			, // entire Earth
+			  { peri::sim::RandomGen{ 100000u, 47u }
+			  , false
+			  }
+			};
+
+		for (Case const & aCase : cases)
+		{
+			peri::sim::RandomGen const & gen = aCase.theGen;
+			std::vector<peri::XYZ> xyzs;
+			xyzs.reserve(gen.size());
+			for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+			{
+				xyzs.emplace_back(earth.xyzForLpa(gen.valueAt(nn)));
+			}
+
+			Box expBox{ bruteLpaBox(xyzs, earth, aCase.theWrapLon) };
+			if (peri::sPi <= expBox[0].theMin)
+			{
+				expBox[0].theMin -= peri::sTwoPi;
+				expBox[0].theMax -= peri::sTwoPi;
+			}
+
+			peri::bounds::Extremes const extremes1
+				{ peri::bounds::lpaBoxFor(xyzs.data(), xyzs.size(), earth, 1u) };
+			peri::bounds::Extremes const extremes4
+				{ peri::bounds::lpaBoxFor(xyzs.data(), xyzs.size(), earth, 4u) };
+			Box const gotBox1{ extremes1.lpaBox() };
+			Box const gotBox4{ extremes4.lpaBox() };
+
+			if (! (sameBox(gotBox1, expBox) && sameBox(gotBox4, expBox)))
+			{
+				std::cerr << "Failure of bounds value test" << '\n';
+				showBox(expBox, "expBox");
+				showBox(gotBox1, "gotBox1");
+				showBox(gotBox4, "gotBox4");
+				++errCount;
+			}
+
+			// most points should be pruned (not converted)
+			std::size_t const numPnts{ xyzs.size() };
+			if (! (  (numPnts == extremes1.numPoints())
+				  && (numPnts == extremes4.numPoints())
+				  && (extremes1.numConverted() < (numPnts / 20u))
+				  ))
+			{
+				std::cerr << "Failure of bounds pruning test" << '\n';
+				std::cerr << "numPnts: " << numPnts << '\n';
+				std::cerr << "numConverted: " << extremes1.numConverted() << '\n';
+				++errCount;
+			}
+		}
+
+		// no points
+		Box const nullBox
+			{ peri::bounds::lpaBoxFor(nullptr, 0u, earth).lpaBox() };
+		if (! std::isnan(nullBox[0].theMin))
+		{
+			std::cerr << "Failure of empty bounds test" << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check Cartesian boxes for geodetic cells (contain and are tight)
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		double const pi{ peri::sPi };
+		std::vector<Box> cells
+			{ // spanning lon=0 and equator
+			  Box{{ { -.1, .2 }, { -.3, .1 }, { -100., 2000. } }}
+			, // spanning lon=90[deg] in southern hemisphere
+			  Box{{ { 1.5, 1.6 }, { -.8, -.7 }, { 0., 10. } }}
+			, // spanning anti-meridian (lon=180[deg])
+			  Box{{ { pi - .01, pi + .02 }, { .7, .71 }, { -10., 10. } }}
+			, // polar cap
+			  Box{{ { -pi, pi }, { 1.5, .5*pi }, { 0., 0. } }}
+			};
+		peri::sim::RandomGen const gen{ 300u, 53u };
+		for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+		{
+			peri::LPA const lpa{ gen.valueAt(nn) };
+			double const ang{ std::pow(10., -double(nn % 6u)) };
+			double const parBeg{ std::max(-.5*pi, lpa[1] - ang) };
+			cells.emplace_back
+				( Box
+					{{ Interval{ lpa[0], lpa[0] + ang }
+					,  Interval{ parBeg, std::min(.5*pi, parBeg + .5*ang) }
+					,  Interval{ lpa[2], lpa[2] + 1.e+5*ang }
+					}}
+				);
+		}
+
+		std::vector<Box> gotBoxes(cells.size());
+		peri::bounds::xyzBoxesFor
+			(cells.data(), cells.size(), gotBoxes.data(), earth);
+
+		for (std::size_t nc{0u} ; nc < cells.size() ; ++nc)
+		{
+			Box const & cell = cells[nc];
+			Box const & gotBox = gotBoxes[nc];
+			Box const conBox{ peri::interval::xyzBoxForLpaBox(cell, earth) };
+
+			// sample cell: including all faces and interior extrema
+			std::vector<double> lons;
+			std::vector<double> pars;
+			std::vector<double> alts;
+			for (std::size_t ns{0u} ; ns <= 8u ; ++ns)
+			{
+				double const frac{ double(ns) / 8. };
+				lons.emplace_back(cell[0].theMin + frac*cell[0].magnitude());
+				pars.emplace_back(cell[1].theMin + frac*cell[1].magnitude());
+				alts.emplace_back(cell[2].theMin + frac*cell[2].magnitude());
+			}
+			for (int nq{-4} ; nq <= 4 ; ++nq)
+			{
+				double const lonQ{ double(nq) * .5 * pi };
+				if (cell[0].contains(lonQ))
+				{
+					lons.emplace_back(lonQ);
+				}
+			}
+			if (cell[1].contains(0.))
+			{
+				pars.emplace_back(0.);
+			}
+
+			double const big{ std::numeric_limits<double>::max() };
+			Box expBox
+				{{ Interval{ big, -big }
+				,  Interval{ big, -big }
+				,  Interval{ big, -big }
+				}};
+			bool okay{ true };
+			for (double const & lon : lons)
+			{
+				for (double const & par : pars)
+				{
+					for (double const & alt : alts)
+					{
+						peri::XYZ const xyz
+							{ earth.xyzForLpa(peri::LPA{ lon, par, alt }) };
+						for (std::size_t nk{0u} ; nk < 3u ; ++nk)
+						{
+							expBox[nk].theMin = std::min(expBox[nk].theMin, xyz[nk]);
+							expBox[nk].theMax = std::max(expBox[nk].theMax, xyz[nk]);
+							okay &= gotBox[nk].contains(xyz[nk]);
+						}
+					}
+				}
+			}
+
+			// sampled extremes (incl. interior extrema) match exact box
+			double const tol{ 2. * peri::interval::sPadLinear };
+			for (std::size_t nk{0u} ; nk < 3u ; ++nk)
+			{
+				okay &= (std::abs(gotBox[nk].theMin - expBox[nk].theMin) < tol);
+				okay &= (std::abs(gotBox[nk].theMax - expBox[nk].theMax) < tol);
+				okay &= (conBox[nk].theMin <= gotBox[nk].theMin + tol);
+				okay &= (gotBox[nk].theMax - tol <= conBox[nk].theMax);
+			}
+
+			if (! okay)
+			{
+				std::cerr << "Failure of xyzBox for cell test" << '\n';
+				showBox(cell, "cell");
+				showBox(expBox, "expBox");
+				showBox(gotBox, "gotBox");
+				showBox(conBox, "conBox");
+				++errCount;
+				break;
+			}
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check geodetic/Cartesian bounds (periBounds.h)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // extremes with pruning
+	errCount += test1(); // xyz boxes for geodetic cells
+	return errCount;
+}
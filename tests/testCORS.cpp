@@ -30,10 +30,13 @@
 
 #include "corsDataParser.h"
 #include "corsDataPairs.h"
+#include "corsFastParser.h"
 
 #include "periLocal.h"
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 
 namespace
@@ -94,6 +97,104 @@ namespace
 		return errCount;
 	}
 
+	//! Check fast parser (cors::FastParser) against cors::DataParser
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		using peri::cors::Station;
+		std::vector<std::string> const & texts = peri::cors::sStationTexts;
+
+		// expected values from original parser
+		std::vector<Station> expStations;
+		for (std::string const & text : texts)
+		{
+			peri::cors::DataParser const parser
+				{ peri::cors::DataParser::from(text) };
+			expStations.emplace_back(Station{ parser.theXYZ, parser.theLPA });
+		}
+
+		// a combined "file" of many copies of all stations
+		constexpr std::size_t numCopies{ 50u };
+		std::string allText;
+		std::vector<Station> expAlls;
+		for (std::size_t nc{0u} ; nc < numCopies ; ++nc)
+		{
+			for (std::size_t nt{0u} ; nt < texts.size() ; ++nt)
+			{
+				allText += texts[nt] + '\n';
+				expAlls.emplace_back(expStations[nt]);
+			}
+		}
+
+		auto const same
+			{ [] (Station const & staA, Station const & staB)
+				{
+					return
+						(  (staA.theXYZ == staB.theXYZ)
+						&& (staA.theLPA == staB.theLPA)
+						);
+				}
+			};
+
+		// single records
+		for (std::size_t nt{0u} ; nt < texts.size() ; ++nt)
+		{
+			peri::cors::FastParser parser(texts[nt]);
+			Station got{};
+			if (! (parser.next(&got) && same(got, expStations[nt])))
+			{
+				std::cerr << "Failure of fast parser record test" << '\n';
+				std::cerr << texts[nt] << '\n';
+				std::cerr << peri::xyz::infoString(got.theXYZ, "gotXYZ") << '\n';
+				std::cerr << peri::lpa::infoString(got.theLPA, "gotLPA") << '\n';
+				++errCount;
+			}
+		}
+
+		// whole text - sequentially and with several parallel partitions
+		for (std::size_t const numThreads : { 1u, 2u, 3u, 7u, 64u })
+		{
+			std::vector<Station> const gotAlls
+				{ peri::cors::FastParser::allFrom(allText, numThreads) };
+			bool okay{ expAlls.size() == gotAlls.size() };
+			for (std::size_t nn{0u} ; okay && (nn < gotAlls.size()) ; ++nn)
+			{
+				okay = same(gotAlls[nn], expAlls[nn]);
+			}
+			if (! okay)
+			{
+				std::cerr << "Failure of parallel fast parser test" << '\n';
+				std::cerr << "numThreads: " << numThreads << '\n';
+				std::cerr << "exp size: " << expAlls.size() << '\n';
+				std::cerr << "got size: " << gotAlls.size() << '\n';
+				++errCount;
+			}
+		}
+
+		// malformed record is reported (as null) and parsing continues
+		std::string const badText
+			{ "X = 1. m latitude = 01 02 03 Q Y = 2. m"
+			+ texts[0]
+			};
+		std::vector<Station> gots;
+		peri::cors::FastParser::forEachIn
+			(badText, [&gots] (Station const & sta) { gots.emplace_back(sta); });
+		if (! ( (2u == gots.size())
+			 && (! peri::isValid(gots[0].theXYZ))
+			 && same(gots[1], expStations[0])
+			  ))
+		{
+			std::cerr << "Failure of malformed record test" << '\n';
+			std::cerr << "gots.size(): " << gots.size() << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
 }
 
 
@@ -104,7 +205,7 @@ main
 {
 	int errCount{ 0 };
 	errCount += test0();
-	// errCount += test1();
+	errCount += test1();
 	return errCount;
 }
 
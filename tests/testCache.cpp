@@ -0,0 +1,245 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Check bounded thread-safe memoization of transformation results.
+ */
+
+
+#include "periCache.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	//! True if each component has identical bit pattern
+	inline
+	bool
+	sameBits
+		( std::array<double, 3u> const & valA
+		, std::array<double, 3u> const & valB
+		)
+	{
+		return
+			(  (peri::cache::bitsOf(valA[0]) == peri::cache::bitsOf(valB[0]))
+			&& (peri::cache::bitsOf(valA[1]) == peri::cache::bitsOf(valB[1]))
+			&& (peri::cache::bitsOf(valA[2]) == peri::cache::bitsOf(valB[2]))
+			);
+	}
+
+	//! Check hits, misses and model identity for single thread use
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::cache::Memo memo(64u);
+		peri::XYZ const xyz{{ 1234567., -4567890., 4123456. }};
+		peri::LPA const lpa{{ 1.25, -.75, 123.5 }};
+
+		peri::LPA const expW{ peri::lpaForXyz(xyz, peri::model::WGS84) };
+		peri::LPA const expG{ peri::lpaForXyz(xyz, peri::model::GRS80) };
+		peri::XYZ const expX{ peri::xyzForLpa(lpa, peri::model::WGS84) };
+
+		// miss, hit, miss (other model), hit, miss (other direction)
+		peri::LPA const got1{ memo.lpaForXyz(xyz, peri::model::WGS84) };
+		peri::LPA const got2{ memo.lpaForXyz(xyz, peri::model::WGS84) };
+		peri::LPA const got3{ memo.lpaForXyz(xyz, peri::model::GRS80) };
+		peri::LPA const got4{ memo.lpaForXyz(xyz, peri::model::GRS80) };
+		peri::XYZ const got5{ memo.xyzForLpa(lpa, peri::model::WGS84) };
+
+		// a one bit input change is a different entry
+		peri::XYZ const xyzNext
+			{{ std::nextafter(xyz[0], 0.), xyz[1], xyz[2] }};
+		peri::LPA const got6{ memo.lpaForXyz(xyzNext, peri::model::WGS84) };
+		peri::LPA const exp6{ peri::lpaForXyz(xyzNext, peri::model::WGS84) };
+
+		peri::cache::Stats const stats{ memo.stats() };
+		bool const okayVals
+			{  sameBits(got1, expW) && sameBits(got2, expW)
+			&& sameBits(got3, expG) && sameBits(got4, expG)
+			&& sameBits(got5, expX) && sameBits(got6, exp6)
+			};
+		bool const okayStats
+			{ (2u == stats.theNumHits) && (4u == stats.theNumMisses) };
+		if (! (okayVals && okayStats))
+		{
+			std::cerr << "Failure of single thread memo test\n";
+			std::cerr << "okayVals: " << okayVals << '\n';
+			std::cerr << "hits: " << stats.theNumHits << '\n';
+			std::cerr << "misses: " << stats.theNumMisses << '\n';
+			++errCount;
+		}
+
+		memo.resetStats();
+		if (! (0u == (memo.stats().theNumHits + memo.stats().theNumMisses)))
+		{
+			std::cerr << "Failure of resetStats test\n";
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check bounded capacity remains correct under eviction
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		peri::cache::Memo memo(16u);
+		peri::sim::RandomGen const gen
+			{ 1000u, 67u, peri::sim::sRangeLon, peri::sim::sRangePar };
+		std::size_t numBad{ 0u };
+		for (std::size_t pass{0u} ; pass < 2u ; ++pass)
+		{
+			for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+			{
+				peri::LPA const lpa{ gen.valueAt(nn) };
+				peri::XYZ const got{ memo.xyzForLpa(lpa) };
+				if (! sameBits(got, peri::xyzForLpa(lpa)))
+				{
+					++numBad;
+				}
+			}
+		}
+
+		peri::cache::Stats const stats{ memo.stats() };
+		if (! ((0u == numBad) && (16u == memo.capacity())
+			&& ((2u * gen.size()) == (stats.theNumHits + stats.theNumMisses))
+			&& (stats.theNumHits < 16u)))
+		{
+			std::cerr << "Failure of bounded capacity test\n";
+			std::cerr << "numBad: " << numBad << '\n';
+			std::cerr << "capacity: " << memo.capacity() << '\n';
+			std::cerr << "hits: " << stats.theNumHits << '\n';
+			std::cerr << "misses: " << stats.theNumMisses << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check concurrent use with repeated stations among unique points
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		peri::cache::Memo memo(1024u);
+		peri::sim::RandomGen const genSta
+			{ 16u, 71u, peri::sim::sRangeLon, peri::sim::sRangePar };
+		peri::sim::RandomGen const genRov
+			{ 4000u, 73u, peri::sim::sRangeLon, peri::sim::sRangePar };
+		std::vector<peri::XYZ> staXyzs(genSta.size());
+		for (std::size_t ns{0u} ; ns < genSta.size() ; ++ns)
+		{
+			staXyzs[ns] = peri::xyzForLpa(genSta.valueAt(ns));
+		}
+
+		constexpr std::size_t numThreads{ 4u };
+		std::vector<std::size_t> numBads(numThreads, 0u);
+		std::vector<std::thread> threads;
+		for (std::size_t nt{0u} ; nt < numThreads ; ++nt)
+		{
+			threads.emplace_back
+				( [&memo, &staXyzs, &genRov, &numBads, nt] ()
+				{
+					for (std::size_t nn{0u} ; nn < genRov.size() ; ++nn)
+					{
+						// alternate station and rover locations
+						peri::XYZ const xyz
+							{ (0u == (nn % 2u))
+							? staXyzs[(nn / 2u + nt) % staXyzs.size()]
+							: peri::xyzForLpa(genRov.valueAt(nn))
+							};
+						peri::LPA const got{ memo.lpaForXyz(xyz) };
+						if (! sameBits(got, peri::lpaForXyz(xyz)))
+						{
+							++numBads[nt];
+						}
+					}
+				}
+				);
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+
+		std::size_t numBad{ 0u };
+		for (std::size_t const & nb : numBads)
+		{
+			numBad += nb;
+		}
+		peri::cache::Stats const stats{ memo.stats() };
+		std::size_t const numCalls{ numThreads * genRov.size() };
+		// most station lookups should hit (rovers may evict a few)
+		bool const okayStats
+			{  (numCalls == (stats.theNumHits + stats.theNumMisses))
+			&& ((9u * (numCalls / 2u)) < (10u * stats.theNumHits))
+			};
+		if (! ((0u == numBad) && okayStats))
+		{
+			std::cerr << "Failure of concurrent memo test\n";
+			std::cerr << "numBad: " << numBad << '\n';
+			std::cerr << "hits: " << stats.theNumHits << '\n';
+			std::cerr << "misses: " << stats.theNumMisses << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+
+//! Check bounded thread-safe memoization of transformation results
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // hits, misses, and model identity
+	errCount += test1(); // eviction with bounded capacity
+	errCount += test2(); // concurrent use with repeated stations
+	return errCount;
+}
+
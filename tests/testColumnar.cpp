@@ -0,0 +1,429 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periColumnar.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using peri::columnar::Triple;
+
+	//! All points (and chunk headers) from columnar stream
+	inline
+	std::vector<Triple>
+	allPointsFrom
+		( std::istream & istrm
+		, std::vector<peri::columnar::ChunkHeader> * const & ptHdrs = nullptr
+		)
+	{
+		std::vector<Triple> all;
+		peri::columnar::Reader reader(istrm);
+		peri::columnar::ChunkHeader hdr{};
+		std::vector<Triple> pnts;
+		while (reader.nextChunk(&hdr) && reader.readChunk(hdr, &pnts))
+		{
+			all.insert(all.end(), pnts.cbegin(), pnts.cend());
+			if (ptHdrs)
+			{
+				ptHdrs->emplace_back(hdr);
+			}
+		}
+		return all;
+	}
+
+	//! Check full precision write/read and chunk metadata
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::columnar;
+		std::vector<peri::LPA> const expLPAs
+			{ peri::sim::bulkSamplesLpa(11u, 7u, 5u) };
+		constexpr std::size_t chunkSize{ 100u };
+
+		std::stringstream strm;
+		Writer writer(strm, KindLPA, ModelGRS80, Float64, {}, chunkSize);
+		writer.write(expLPAs.data(), expLPAs.size());
+
+		std::vector<ChunkHeader> hdrs;
+		std::vector<Triple> const gotLPAs{ allPointsFrom(strm, &hdrs) };
+
+		std::size_t const expNumChunks
+			{ (expLPAs.size() + chunkSize - 1u) / chunkSize };
+		if (! ((expLPAs == gotLPAs) && (expNumChunks == hdrs.size())))
+		{
+			std::cerr << "Failure of float64 write/read test" << '\n';
+			std::cerr << "exp size: " << expLPAs.size() << '\n';
+			std::cerr << "got size: " << gotLPAs.size() << '\n';
+			std::cerr << "expNumChunks: " << expNumChunks << '\n';
+			std::cerr << "gotNumChunks: " << hdrs.size() << '\n';
+			++errCount;
+		}
+		else
+		{
+			// check metadata of second chunk
+			ChunkHeader const & hdr = hdrs[1];
+			double mins[3], maxs[3];
+			peri::columnar::boundsOf
+				(expLPAs.data() + chunkSize, chunkSize, mins, maxs);
+			bool okay
+				{  (chunkSize == hdr.theCount)
+				&& (ModelGRS80 == hdr.theModelId)
+				&& (Float64 == hdr.theEncoding)
+				&& (0u == (hdr.theColumnStride % sAlign))
+				};
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				okay = okay
+					&& (mins[nc] == hdr.theMins[nc])
+					&& (maxs[nc] == hdr.theMaxs[nc])
+					&& (mins[nc] == hdr.theLpaMins[nc])
+					&& (maxs[nc] == hdr.theLpaMaxs[nc]);
+			}
+			if (! okay)
+			{
+				std::cerr << "Failure of chunk metadata test" << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check quantized (Fixed32) encoding accuracy
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::columnar;
+		// local cluster (quantized) followed by global samples (not)
+		std::vector<peri::LPA> lpas;
+		for (std::size_t nn{0u} ; nn < 256u ; ++nn)
+		{
+			double const frac{ double(nn) / 256. };
+			lpas.emplace_back(peri::LPA
+				{ peri::radForDeg(-105.) + 1.e-4 * frac
+				, peri::radForDeg(  40.) + 3.e-4 * (1. - frac)
+				, 1600. + 100. * frac
+				});
+		}
+		std::vector<peri::LPA> const bulks
+			{ peri::sim::bulkSamplesLpa(11u, 7u, 5u) };
+		lpas.insert(lpas.end(), bulks.cbegin(), bulks.cend());
+		std::vector<peri::XYZ> expXYZs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), expXYZs.data());
+
+		// fine steps: chunks of wide range fall back to float64
+		Triple const steps{ 1.e-3, 1.e-3, 1.e-3 };
+		std::stringstream strm;
+		Writer writer(strm, KindXYZ, ModelWGS84, Fixed32, steps, 64u);
+		writer.write(expXYZs.data(), expXYZs.size());
+
+		std::vector<ChunkHeader> hdrs;
+		std::vector<Triple> const gotXYZs{ allPointsFrom(strm, &hdrs) };
+
+		double maxErr{ 0. };
+		for (std::size_t nn{0u} ; nn < gotXYZs.size() ; ++nn)
+		{
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				double const err{ std::abs(gotXYZs[nn][nc] - expXYZs[nn][nc]) };
+				maxErr = std::max(maxErr, err);
+			}
+		}
+		std::size_t numFixed{ 0u };
+		for (ChunkHeader const & hdr : hdrs)
+		{
+			if (Fixed32 == hdr.theEncoding)
+			{
+				++numFixed;
+			}
+		}
+		constexpr std::size_t expNumFixed{ 256u / 64u };
+
+		// half step plus a little for arithmetic
+		double const tolErr{ .5 * steps[0] + 1.e-8 };
+		if (! ((expXYZs.size() == gotXYZs.size()) && (maxErr < tolErr)))
+		{
+			std::cerr << "Failure of Fixed32 accuracy test" << '\n';
+			std::cerr << "maxErr: " << maxErr << '\n';
+			std::cerr << "tolErr: " << tolErr << '\n';
+			++errCount;
+		}
+		if (! (expNumFixed == numFixed))
+		{
+			std::cerr << "Failure of Fixed32 encoding use test" << '\n';
+			std::cerr << "expNumFixed: " << expNumFixed << '\n';
+			std::cerr << "numFixed: " << numFixed << '\n';
+			++errCount;
+		}
+
+		// quantization levels at (and just beyond) uint32 capacity
+		constexpr double maxQuant
+			{ double(std::numeric_limits<std::uint32_t>::max()) };
+		std::vector<Triple> const edgePnts
+			{ { 0., 0., 0. }, { maxQuant - 1., 0., 0. } // fits: Fixed32
+			, { 0., 0., 0. }, { maxQuant - .5, 0., 0. } // not: Float64
+			, { 0., 0., 0. }, { maxQuant + 9., 0., 0. } // not: Float64
+			};
+		std::stringstream edgeStrm;
+		Writer edgeWriter
+			(edgeStrm, KindXYZ, ModelWGS84, Fixed32, { 1., 1., 1. }, 2u);
+		edgeWriter.write(edgePnts.data(), edgePnts.size());
+		std::vector<ChunkHeader> edgeHdrs;
+		std::vector<Triple> const gotEdges{ allPointsFrom(edgeStrm, &edgeHdrs) };
+		if (! (  (3u == edgeHdrs.size())
+			  && (Fixed32 == edgeHdrs[0].theEncoding)
+			  && (Float64 == edgeHdrs[1].theEncoding)
+			  && (Float64 == edgeHdrs[2].theEncoding)
+			  && (edgePnts == gotEdges)
+			  ))
+		{
+			std::cerr << "Failure of Fixed32 capacity test" << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check transformation with chunk skipping by geodetic window
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::columnar;
+		using peri::radForDeg;
+
+		// chunks (in order) of different longitude bands
+		constexpr std::size_t numPer{ 20u };
+		std::vector<double> const lonDegs{ -170., -60., 0., 60., 170. };
+		std::vector<peri::XYZ> xyzs;
+		for (double const & lonDeg : lonDegs)
+		{
+			for (std::size_t nn{0u} ; nn < numPer ; ++nn)
+			{
+				peri::LPA const lpa
+					{ radForDeg(lonDeg + .1*double(nn))
+					, radForDeg(-45. + 4.*double(nn))
+					, 100.*double(nn)
+					};
+				xyzs.emplace_back(peri::xyzForLpa(lpa, peri::model::GRS80));
+			}
+		}
+		std::stringstream inStrm;
+		Writer writer(inStrm, KindXYZ, ModelGRS80, Float64, {}, numPer);
+		writer.write(xyzs.data(), xyzs.size());
+
+		struct Check
+		{
+			Window const theWindow;
+			std::vector<std::size_t> const theExpChunks;
+		};
+		std::vector<Check> const checks
+			{ { Window{}, { 0u, 1u, 2u, 3u, 4u } }
+			, { Window
+				{ { radForDeg(-10.), radForDeg(-90.), -1000. }
+				, { radForDeg( 70.), radForDeg( 90.),  1000. }
+				}
+			  , { 2u, 3u }
+			  }
+			// across anti-meridian (min lon > max lon)
+			, { Window
+				{ { radForDeg( 100.), radForDeg(-90.), -1000. }
+				, { radForDeg(-100.), radForDeg( 90.),  1.e4 }
+				}
+			  , { 0u, 4u }
+			  }
+			// altitude excludes all
+			, { Window
+				{ { -10., -10., 1.e5 }
+				, {  10.,  10., 2.e5 }
+				}
+			  , {}
+			  }
+			};
+
+		for (Check const & check : checks)
+		{
+			std::stringstream srcStrm(inStrm.str());
+			std::stringstream outStrm;
+			Stats const stats{ transformFile(srcStrm, outStrm, check.theWindow) };
+
+			std::vector<Triple> expLPAs;
+			for (std::size_t const & nc : check.theExpChunks)
+			{
+				for (std::size_t nn{0u} ; nn < numPer ; ++nn)
+				{
+					expLPAs.emplace_back
+						(peri::lpaForXyz(xyzs[nc*numPer + nn], peri::model::GRS80));
+				}
+			}
+			std::vector<ChunkHeader> hdrs;
+			std::vector<Triple> const gotLPAs{ allPointsFrom(outStrm, &hdrs) };
+
+			std::size_t const expSkip
+				{ lonDegs.size() - check.theExpChunks.size() };
+			bool const okay
+				{  stats.theIsValid
+				&& (lonDegs.size() == stats.theNumChunks)
+				&& (expSkip == stats.theNumSkipped)
+				&& (expLPAs.size() == stats.theNumPnts)
+				&& (expLPAs == gotLPAs)
+				&& std::all_of
+					( hdrs.cbegin(), hdrs.cend()
+					, [] (ChunkHeader const & hdr)
+						{ return (ModelGRS80 == hdr.theModelId); }
+					)
+				};
+			if (! okay)
+			{
+				std::cerr << "Failure of windowed transform test" << '\n';
+				std::cerr << "  theNumChunks: " << stats.theNumChunks << '\n';
+				std::cerr << "       expSkip: " << expSkip << '\n';
+				std::cerr << " theNumSkipped: " << stats.theNumSkipped << '\n';
+				std::cerr << "    theNumPnts: " << stats.theNumPnts << '\n';
+				std::cerr << "   gotLPA size: " << gotLPAs.size() << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check truncated input is reported as an error
+	int
+	test3
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::columnar;
+
+		constexpr std::size_t numPer{ 16u };
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(4u, 4u, 2u) };
+		std::vector<peri::XYZ> xyzs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), xyzs.data());
+		std::stringstream fullStrm;
+		Writer writer(fullStrm, KindXYZ, ModelWGS84, Float64, {}, numPer);
+		writer.write(xyzs.data(), xyzs.size());
+		std::string const full{ fullStrm.str() };
+
+		// window that excludes (and hence skips) every chunk
+		Window const skipAll{ { -10., -10., 1.e5 }, { 10., 10., 2.e5 } };
+		std::size_t const sizeFile{ sizeof(FileHeader) };
+		std::size_t const sizeChunk{ sizeof(ChunkHeader) };
+
+		struct Check
+		{
+			std::string const theName;
+			std::size_t const theSize;
+			Window const theWindow;
+			bool const theExpValid;
+		};
+		std::vector<Check> const checks
+			{ { "complete", full.size(), Window{}, true }
+			, { "complete(skip)", full.size(), skipAll, true }
+			, { "in chunk header", sizeFile + sizeChunk/2u, Window{}, false }
+			, { "in chunk data", full.size() - 8u, Window{}, false }
+			, { "in skipped data", full.size() - 8u, skipAll, false }
+			};
+
+		for (Check const & check : checks)
+		{
+			std::string const content{ full.substr(0u, check.theSize) };
+
+			// both string streams and file streams (which can seek past end)
+			std::stringstream srcStrm(content);
+			std::stringstream outStrm;
+			Stats const stats{ transformFile(srcStrm, outStrm, check.theWindow) };
+
+			std::string const path{ "testColumnarTrunc.bin" };
+			{
+				std::ofstream ofs(path, std::ios::binary);
+				ofs.write(content.data(), std::streamsize(content.size()));
+			}
+			std::ifstream srcFile(path, std::ios::binary);
+			std::stringstream outFile;
+			Stats const statsFile
+				{ transformFile(srcFile, outFile, check.theWindow) };
+			srcFile.close();
+			std::remove(path.c_str());
+
+			if (! (  (check.theExpValid == stats.theIsValid)
+				  && (check.theExpValid == statsFile.theIsValid)
+				  ))
+			{
+				std::cerr << "Failure of truncated input test" << '\n';
+				std::cerr << "      case: " << check.theName << '\n';
+				std::cerr << "  expValid: " << check.theExpValid << '\n';
+				std::cerr << "  gotValid: " << stats.theIsValid << '\n';
+				std::cerr << " fileValid: " << statsFile.theIsValid << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+}
+
+
+//! Check columnar file format read/write/transform
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // float64 write/read
+	errCount += test1(); // fixed32 quantization
+	errCount += test2(); // windowed transformation
+	errCount += test3(); // truncated input
+	return errCount;
+}
@@ -0,0 +1,118 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periDispatch.h"
+
+#include "periBatch.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Check dispatched kernels agree with header-only batch functions
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		std::string const isa{ peri::dispatch::isaName() };
+		if (! (  ("avx512f" == isa)
+			  || ("avx2" == isa)
+			  || ("default" == isa)
+			  ))
+		{
+			std::cerr << "Failure of isaName test" << '\n';
+			std::cerr << "got: '" << isa << "'" << '\n';
+			++errCount;
+		}
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(17u, 19u, 23u) };
+		std::size_t const numPnts{ lpas.size() };
+
+		std::vector<peri::XYZ> expXYZs(numPnts);
+		peri::batch::xyzForLpa(lpas.data(), numPnts, expXYZs.data(), earth);
+		std::vector<peri::LPA> expLPAs(numPnts);
+		peri::batch::lpaForXyz(expXYZs.data(), numPnts, expLPAs.data(), earth);
+
+		std::vector<peri::XYZ> gotXYZs(numPnts);
+		peri::dispatch::xyzForLpa(lpas.data(), numPnts, gotXYZs.data(), earth);
+		std::vector<peri::LPA> gotLPAs(numPnts);
+		peri::dispatch::lpaForXyz
+			(expXYZs.data(), numPnts, gotLPAs.data(), earth);
+
+		// identical unless this test (i.e. peri::batch) is compiled with
+		// fused multiply-add contraction (allow a few ulp at Earth radius)
+		constexpr double tolLin{ 1.e-8 };
+		constexpr double tolAng{ 1.e-15 };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			if (! (  peri::xyz::sameEnough(gotXYZs[nn], expXYZs[nn], tolLin)
+				  && peri::lpa::sameEnough
+					(gotLPAs[nn], expLPAs[nn], tolAng, tolLin)
+				  ))
+			{
+				std::cerr << "Failure of dispatch/batch test"
+					<< " isa: " << isa << '\n';
+				std::cerr << peri::xyz::infoString(expXYZs[nn], "expXYZ") << '\n';
+				std::cerr << peri::xyz::infoString(gotXYZs[nn], "gotXYZ") << '\n';
+				std::cerr << peri::lpa::infoString(expLPAs[nn], "expLPA") << '\n';
+				std::cerr << peri::lpa::infoString(gotLPAs[nn], "gotLPA") << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		// zero size should be a no-op (with null pointers)
+		peri::dispatch::lpaForXyz(nullptr, 0u, nullptr);
+		peri::dispatch::xyzForLpa(nullptr, 0u, nullptr);
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check operation of (optional) CPU dispatched batch library
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // dispatched kernels same as header-only batch
+	return errCount;
+}
@@ -0,0 +1,211 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periFormat.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Text produced by encoding function (empty if buffer too small)
+	template <typename EncodeFunc>
+	inline
+	std::string
+	textFrom
+		( EncodeFunc const & encode
+		, std::size_t const & bufSize = 256u
+		)
+	{
+		std::vector<char> buf(bufSize);
+		char * const end{ encode(buf.data(), buf.data() + buf.size()) };
+		std::string text;
+		if (end)
+		{
+			text = std::string(buf.data(), end);
+		}
+		return text;
+	}
+
+	//! Check fixed and shortest value encoding
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::format;
+		peri::LPA const lpa{ peri::radForDeg(-75.25), peri::radForDeg(40.5), 123.4567 };
+
+		struct Check
+		{
+			std::string const theExp;
+			std::string const theGot;
+		};
+		Spec const specDeg{ 6, 2, true, ' ' };
+		Spec const specRad{ 3, 0, false, ',' };
+		std::vector<Check> const checks
+			{ { "1.500000"
+			  , textFrom
+				( [] (char * beg, char * end)
+					{ return valueChars(beg, end, 1.5, 6); }
+				)
+			  }
+			, { "0.1"
+			  , textFrom
+				( [] (char * beg, char * end)
+					{ return valueChars(beg, end, .1, -1); }
+				)
+			  }
+			, { "-75.250000 40.500000 123.46\n"
+			  , textFrom
+				( [&] (char * beg, char * end)
+					{ return lpaChars(beg, end, lpa, specDeg); }
+				)
+			  }
+			, { "-1.313,0.707,123\n"
+			  , textFrom
+				( [&] (char * beg, char * end)
+					{ return lpaChars(beg, end, lpa, specRad); }
+				)
+			  }
+			, { "1,-2.5,3e+06\n"
+			  , textFrom
+				( [] (char * beg, char * end)
+					{ return xyzChars(beg, end, { 1., -2.5, 3.e6 }); }
+				)
+			  }
+			// buffer too small produces null (empty text here)
+			, { ""
+			  , textFrom
+				( [] (char * beg, char * end)
+					{ return xyzChars(beg, end, { 1., -2.5, 3.e6 }); }
+				, 12u
+				)
+			  }
+			};
+
+		for (Check const & check : checks)
+		{
+			if (! (check.theExp == check.theGot))
+			{
+				std::cerr << "Failure of value encoding test" << '\n';
+				std::cerr << "exp: '" << check.theExp << "'" << '\n';
+				std::cerr << "got: '" << check.theGot << "'" << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check page encoding (shortest form decodes exactly)
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::format;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(13u, 11u, 7u) };
+		std::size_t const numPnts{ lpas.size() };
+
+		// encode with small pages (many page breaks)
+		std::vector<char> page(1000u);
+		std::string allText;
+		std::size_t numDone{ 0u };
+		while (numDone < numPnts)
+		{
+			std::size_t numPage{ 0u };
+			std::size_t const numBytes
+				{ lpaPage
+					( lpas.data() + numDone, numPnts - numDone, Spec{}
+					, page.data(), page.size(), &numPage
+					)
+				};
+			if (0u == numPage)
+			{
+				std::cerr << "Failure of page progress test" << '\n';
+				++errCount;
+				break;
+			}
+			allText.append(page.data(), numBytes);
+			numDone += numPage;
+		}
+
+		// decode and compare
+		char const * ptr{ allText.data() };
+		char const * const end{ allText.data() + allText.size() };
+		std::size_t numSame{ 0u };
+		for (peri::LPA const & expLPA : lpas)
+		{
+			peri::LPA gotLPA{};
+			for (double & value : gotLPA)
+			{
+				std::from_chars_result const result
+					{ std::from_chars(ptr, end, value) };
+				ptr = result.ptr + 1; // skip separator
+			}
+			if (expLPA == gotLPA)
+			{
+				++numSame;
+			}
+		}
+		if (! ((numPnts == numSame) && (end == ptr)))
+		{
+			std::cerr << "Failure of page encoding round trip test" << '\n';
+			std::cerr << "numPnts: " << numPnts << '\n';
+			std::cerr << "numSame: " << numSame << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+}
+
+
+//! Check text encoding of coordinate values
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // individual values and records
+	errCount += test1(); // page encoding
+	return errCount;
+}
@@ -0,0 +1,226 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periIncrement.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+	//! Error [m] of lpa relative to expLpa (angles as arc length)
+	inline
+	double
+	linearError
+		( peri::LPA const & gotLpa
+		, peri::LPA const & expLpa
+		)
+	{
+		constexpr double radEarth{ 6.4e+6 };
+		double dLon{ std::abs(gotLpa[0] - expLpa[0]) };
+		dLon = std::min(dLon, std::abs(dLon - 2.*peri::pi()));
+		return std::max
+			( { radEarth * std::cos(expLpa[1]) * dLon
+			  , radEarth * std::abs(gotLpa[1] - expLpa[1])
+			  , std::abs(gotLpa[2] - expLpa[2])
+			  }
+			);
+	}
+
+	//! Check updates are within tolerance and use expected methods
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		double const tol{ 1.e-6 };
+		peri::sim::RandomGen const gen
+			{ 500u, 59u, peri::sim::sRangeLon, { -1.5, 1.5 } };
+		struct Case
+		{
+			double theDist; //!< Size of location change [m]
+			char theDir; //!< Move 'E'ast, 'U'p (else arbitrary direction)
+			peri::increment::Method theExpMethod;
+		};
+		// (sigma changes little with horizontal moves: Newton step okay)
+		std::vector<Case> const cases
+			{ { .001, 'A', peri::increment::FirstOrder }
+			, { .1, 'A', peri::increment::FirstOrder }
+			, { 100., 'E', peri::increment::NewtonStep }
+			, { 100., 'U', peri::increment::FullSolve }
+			, { 10000., 'E', peri::increment::FullSolve }
+			};
+
+		for (Case const & aCase : cases)
+		{
+			for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+			{
+				peri::XYZ const xyz0{ earth.xyzForLpa(gen.valueAt(nn)) };
+				peri::increment::State state
+					{ peri::increment::stateFor(xyz0, earth) };
+				// initial state is a full conversion
+				if (! (peri::lpaForXyz(xyz0, earth) == state.theLpa))
+				{
+					std::cerr << "Failure of initial state test" << '\n';
+					++errCount;
+					break;
+				}
+
+				// move east, up or in arbitrary direction (fixed per point)
+				peri::LPA const lpa0{ gen.valueAt(nn) };
+				peri::XYZ dir
+					{ peri::unit(peri::XYZ{ 1., -2. + double(nn % 5u), .5 }) };
+				if ('E' == aCase.theDir)
+				{
+					dir = peri::XYZ{ -std::sin(lpa0[0]), std::cos(lpa0[0]), 0. };
+				}
+				else
+				if ('U' == aCase.theDir)
+				{
+					dir = peri::upDirAtLpa(lpa0);
+				}
+				peri::XYZ const xyz1
+					{ xyz0[0] + aCase.theDist * dir[0]
+					, xyz0[1] + aCase.theDist * dir[1]
+					, xyz0[2] + aCase.theDist * dir[2]
+					};
+				peri::increment::Method method{};
+				peri::LPA const gotLpa
+					{ peri::increment::lpaForXyz
+						(&state, xyz1, earth, tol, &method)
+					};
+				peri::LPA const expLpa{ peri::lpaForXyz(xyz1, earth) };
+				double const err{ linearError(gotLpa, expLpa) };
+				if (! ((err < tol) && (aCase.theExpMethod == method)))
+				{
+					std::cerr << "Failure of incremental update test" << '\n';
+					std::cerr << "dist: " << aCase.theDist
+						<< " method: " << method
+						<< " expMethod: " << aCase.theExpMethod
+						<< " err: " << err << '\n';
+					std::cerr << peri::lpa::infoString(expLpa, "expLpa") << '\n';
+					std::cerr << peri::lpa::infoString(gotLpa, "gotLpa") << '\n';
+					++errCount;
+					break;
+				}
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check batch updates over a sequence of small moves
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(7u, 11u, 5u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<peri::XYZ> xyzs(numPnts);
+		std::vector<peri::increment::State> states;
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			xyzs[nn] = earth.xyzForLpa(lpas[nn]);
+			states.emplace_back(peri::increment::stateFor(xyzs[nn], earth));
+		}
+
+		// points drift by 1[mm] per iteration
+		std::array<std::size_t, 3u> sumCounts{{ 0u, 0u, 0u }};
+		std::vector<peri::LPA> gotLpas(numPnts);
+		for (std::size_t iter{0u} ; iter < 50u ; ++iter)
+		{
+			for (peri::XYZ & xyz : xyzs)
+			{
+				xyz[0] += .001;
+			}
+			std::array<std::size_t, 3u> const counts
+				{ peri::increment::lpaForXyz
+					( states.data(), xyzs.data(), numPnts, gotLpas.data()
+					, earth
+					)
+				};
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				sumCounts[nc] += counts[nc];
+			}
+			for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+			{
+				peri::LPA const expLpa{ peri::lpaForXyz(xyzs[nn], earth) };
+				double const err{ linearError(gotLpas[nn], expLpa) };
+				if (! (err < 1.e-6))
+				{
+					std::cerr << "Failure of batch increment test" << '\n';
+					std::cerr << "iter: " << iter << " err: " << err << '\n';
+					++errCount;
+					break;
+				}
+			}
+		}
+
+		// linearization should suffice for most updates (other than near
+		// the poles) and full solutions should not be needed
+		std::size_t const numTotal{ 50u * numPnts };
+		if (! (  ((sumCounts[0] + sumCounts[1] + sumCounts[2]) == numTotal)
+			  && (numTotal < (2u * sumCounts[0]))
+			  && (0u == sumCounts[2])
+			  ))
+		{
+			std::cerr << "Failure of batch increment count test" << '\n';
+			std::cerr << "counts: " << sumCounts[0] << ' ' << sumCounts[1]
+				<< ' ' << sumCounts[2] << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check incremental geodetic updates (periIncrement.h)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // single point updates
+	errCount += test1(); // batch updates of drifting points
+	return errCount;
+}
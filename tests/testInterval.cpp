@@ -0,0 +1,340 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periInterval.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+	using peri::interval::Box;
+	using peri::interval::Interval;
+
+	//! Locations on a (numPer^3) grid spanning box (including faces)
+	inline
+	std::vector<std::array<double, 3u> >
+	gridIn
+		( Box const & box
+		, std::size_t const & numPer = 7u
+		)
+	{
+		std::vector<std::array<double, 3u> > locs;
+		double const den{ double(numPer - 1u) };
+		for (std::size_t n0{0u} ; n0 < numPer ; ++n0)
+		{
+			for (std::size_t n1{0u} ; n1 < numPer ; ++n1)
+			{
+				for (std::size_t n2{0u} ; n2 < numPer ; ++n2)
+				{
+					locs.emplace_back
+						( std::array<double, 3u>
+							{ box[0].theMin + (double(n0)/den)*box[0].magnitude()
+							, box[1].theMin + (double(n1)/den)*box[1].magnitude()
+							, box[2].theMin + (double(n2)/den)*box[2].magnitude()
+							}
+						);
+				}
+			}
+		}
+		return locs;
+	}
+
+	//! True if all lpa values are within lpaBox
+	inline
+	bool
+	lpaBoxContains
+		( Box const & lpaBox
+		, peri::LPA const & lpa
+		)
+	{
+		return
+			(  peri::interval::lonContains(lpaBox[0], lpa[0])
+			&& lpaBox[1].contains(lpa[1])
+			&& lpaBox[2].contains(lpa[2])
+			);
+	}
+
+	//! True if all xyz values are within xyzBox
+	inline
+	bool
+	xyzBoxContains
+		( Box const & xyzBox
+		, peri::XYZ const & xyz
+		)
+	{
+		return
+			(  xyzBox[0].contains(xyz[0])
+			&& xyzBox[1].contains(xyz[1])
+			&& xyzBox[2].contains(xyz[2])
+			);
+	}
+
+	//! Check geodetic intervals contain (and are tight around) box points
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		peri::sim::RandomGen const gen{ 200u, 31u };
+		std::vector<double> const halfSizes{ 1., 1.e+3, 1.e+5 };
+		std::vector<Box> xyzBoxes;
+		for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+		{
+			peri::XYZ const xyz{ earth.xyzForLpa(gen.valueAt(nn)) };
+			double const & half = halfSizes[nn % halfSizes.size()];
+			xyzBoxes.emplace_back
+				( Box
+					{{ Interval{ xyz[0] - half, xyz[0] + .5*half }
+					,  Interval{ xyz[1] - .5*half, xyz[1] + half }
+					,  Interval{ xyz[2] - half, xyz[2] + half }
+					}}
+				);
+		}
+		// straddling anti-meridian and enclosing the north polar axis
+		xyzBoxes.emplace_back
+			( Box
+				{{ Interval{ -6378.e+3, -6370.e+3 }
+				,  Interval{ -1.e+3, 2.e+3 }
+				,  Interval{ -1.e+3, 1.e+3 }
+				}}
+			);
+		xyzBoxes.emplace_back
+			( Box
+				{{ Interval{ -1.e+3, 2.e+3 }
+				,  Interval{ -2.e+3, 1.e+3 }
+				,  Interval{ 6350.e+3, 6360.e+3 }
+				}}
+			);
+
+		for (Box const & xyzBox : xyzBoxes)
+		{
+			Box const lpaBox{ peri::interval::lpaBoxForXyzBox(xyzBox, earth) };
+			Interval gotPar{ 1.e+9, -1.e+9 };
+			Interval gotAlt{ 1.e+9, -1.e+9 };
+			for (peri::XYZ const & xyz : gridIn(xyzBox))
+			{
+				peri::LPA const lpa{ earth.lpaForXyz(xyz) };
+				gotPar = Interval
+					{ std::min(gotPar.theMin, lpa[1])
+					, std::max(gotPar.theMax, lpa[1])
+					};
+				gotAlt = Interval
+					{ std::min(gotAlt.theMin, lpa[2])
+					, std::max(gotAlt.theMax, lpa[2])
+					};
+				if (! lpaBoxContains(lpaBox, lpa))
+				{
+					std::cerr << "Failure of lpaBox containment test" << '\n';
+					std::cerr << peri::xyz::infoString(xyz, "xyz") << '\n';
+					std::cerr << peri::lpa::infoString(lpa, "lpa") << '\n';
+					std::cerr << "lonBox: " << lpaBox[0].theMin
+						<< ' ' << lpaBox[0].theMax << '\n';
+					std::cerr << "parBox: " << lpaBox[1].theMin
+						<< ' ' << lpaBox[1].theMax << '\n';
+					std::cerr << "altBox: " << lpaBox[2].theMin
+						<< ' ' << lpaBox[2].theMax << '\n';
+					++errCount;
+					break;
+				}
+			}
+			// grid (7^3 points) samples near all but polar axis extrema
+			double const boxSize{ xyzBox[2].magnitude() };
+			double const tolAlt{ .1 * boxSize + 1.e-3 };
+			double const tolPar{ tolAlt / 6.e+6 };
+			if (! (  (lpaBox[1].magnitude() < gotPar.magnitude() + tolPar)
+				  && (lpaBox[2].magnitude() < gotAlt.magnitude() + tolAlt)
+				  ))
+			{
+				std::cerr << "Failure of lpaBox tightness test" << '\n';
+				std::cerr << "parBox: " << lpaBox[1].magnitude()
+					<< " gotPar: " << gotPar.magnitude() << '\n';
+				std::cerr << "altBox: " << lpaBox[2].magnitude()
+					<< " gotAlt: " << gotAlt.magnitude() << '\n';
+				++errCount;
+			}
+		}
+
+		// anti-meridian wrap and polar axis special cases
+		Box const & boxWrap = xyzBoxes[xyzBoxes.size() - 2u];
+		Box const & boxPole = xyzBoxes[xyzBoxes.size() - 1u];
+		Box const lpaWrap{ peri::interval::lpaBoxForXyzBox(boxWrap, earth) };
+		Box const lpaPole{ peri::interval::lpaBoxForXyzBox(boxPole, earth) };
+		double const pi{ peri::sPi };
+		if (! (  (lpaWrap[0].theMax > pi) && (lpaWrap[0].magnitude() < .001)
+			  && (2.*pi <= lpaPole[0].magnitude())
+			  && (.5*pi <= lpaPole[1].theMax)
+			  ))
+		{
+			std::cerr << "Failure of wrap/pole lon test" << '\n';
+			std::cerr << "lonWrap: " << lpaWrap[0].theMin
+				<< ' ' << lpaWrap[0].theMax << '\n';
+			std::cerr << "lonPole: " << lpaPole[0].theMin
+				<< ' ' << lpaPole[0].theMax << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check Cartesian box contains all points in geodetic cells
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		peri::sim::RandomGen const gen{ 200u, 37u };
+		std::vector<double> const angSizes{ 1.e-7, 1.e-3, .5 };
+		for (std::size_t nn{0u} ; nn < gen.size() ; ++nn)
+		{
+			peri::LPA const lpa{ gen.valueAt(nn) };
+			double const & ang = angSizes[nn % angSizes.size()];
+			Box const lpaBox
+				{{ Interval{ lpa[0], lpa[0] + ang }
+				,  Interval{ lpa[1] - .5*ang, lpa[1] }
+				,  Interval{ lpa[2], lpa[2] + 1.e+7 * ang }
+				}};
+			Box const xyzBox{ peri::interval::xyzBoxForLpaBox(lpaBox, earth) };
+			for (peri::LPA const & lpaIn : gridIn(lpaBox))
+			{
+				peri::XYZ const xyz{ earth.xyzForLpa(lpaIn) };
+				if (! xyzBoxContains(xyzBox, xyz))
+				{
+					std::cerr << "Failure of xyzBox containment test" << '\n';
+					std::cerr << peri::lpa::infoString(lpaIn, "lpa") << '\n';
+					std::cerr << peri::xyz::infoString(xyz, "xyz") << '\n';
+					++errCount;
+					break;
+				}
+			}
+		}
+
+		// interval functions
+		double const pi{ peri::sPi };
+		Interval const cosA{ peri::interval::cosOf(Interval{ -.5, 7. }) };
+		Interval const sinA{ peri::interval::sinOf(Interval{ 2., 2.5 }) };
+		if (! (  (-1. == cosA.theMin) && (1. == cosA.theMax)
+			  && (std::sin(2.5) == sinA.theMin)
+			  && (std::sin(2.) == sinA.theMax)
+			  && peri::interval::lonContains(Interval{ 3., 3.5 }, -pi + .1)
+			  && (! peri::interval::lonContains(Interval{ 3., 3.5 }, -pi + .5))
+			  && peri::interval::lonOverlaps
+			  	(Interval{ 3., 3.5 }, Interval{ -3., -2.9 })
+			  ))
+		{
+			std::cerr << "Failure of interval function test" << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check boxes containing (or near) Earth center have valid bounds
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		double const radA{ earth.theEllip.theShapeOrig.theRadA };
+		double const pi{ peri::sPi };
+		std::vector<Box> const xyzBoxes
+			{ Box{{ { -7.e+6, 7.e+6 }, { -7.e+6, 7.e+6 }, { -7.e+6, 7.e+6 } }}
+			, Box{{ { 0., 7.e+6 }, { 0., 7.e+6 }, { 0., 7.e+6 } }}
+			, Box{{ { -7.e+6, 0. }, { 0., 7.e+6 }, { -7.e+6, 0. } }}
+			, Box{{ { -1.e+3, 1.e+3 }, { -1.e+3, 1.e+3 }, { -1.e+3, 1.e+3 } }}
+			, Box{{ { 1.e+5, 2.e+6 }, { -5.e+5, 5.e+5 }, { 3.e+4, 7.e+6 } }}
+			};
+
+		for (Box const & xyzBox : xyzBoxes)
+		{
+			Box const lpaBox{ peri::interval::lpaBoxForXyzBox(xyzBox, earth) };
+			bool okay
+				{  std::isfinite(lpaBox[1].theMin)
+				&& std::isfinite(lpaBox[1].theMax)
+				&& std::isfinite(lpaBox[2].theMin)
+				&& std::isfinite(lpaBox[2].theMax)
+				};
+			for (peri::XYZ const & xyz : gridIn(xyzBox, 9u))
+			{
+				peri::LPA const lpa{ earth.lpaForXyz(xyz) };
+				// (geodetic values are undefined at the center itself)
+				if (std::isfinite(lpa[1]) && (! lpaBoxContains(lpaBox, lpa)))
+				{
+					std::cerr << peri::lpa::infoString(lpa, "lpa") << '\n';
+					okay = false;
+				}
+			}
+			// boxes with the center span all latitudes and reach below -a
+			if ( xyzBox[0].contains(0.) && xyzBox[1].contains(0.)
+			  && xyzBox[2].contains(0.)
+			   )
+			{
+				okay = okay
+					&& lpaBox[1].contains(-.5*pi) && lpaBox[1].contains(.5*pi)
+					&& (lpaBox[2].theMin <= -radA);
+			}
+			if (! okay)
+			{
+				std::cerr << "Failure of earth center box test" << '\n';
+				std::cerr << "parBox: " << lpaBox[1].theMin
+					<< ' ' << lpaBox[1].theMax << '\n';
+				std::cerr << "altBox: " << lpaBox[2].theMin
+					<< ' ' << lpaBox[2].theMax << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check conservative transformation of coordinate intervals
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // lpa intervals for xyz box
+	errCount += test1(); // xyz box for lpa intervals
+	errCount += test2(); // boxes containing earth center
+	return errCount;
+}
@@ -30,6 +30,9 @@
 #include "peridetic.h"
 
 #include "periLocal.h"
+#include "periSim.h"
+
+#include <vector>
 
 
 namespace
@@ -124,6 +127,111 @@ namespace
 		return errCount;
 	}
 
+	//! Check lazy sample generators (periSim) and chunked iteration
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::sim;
+
+		// grid generator matches materialized samples
+		GridGen const gridGen{ GridGen::bulk(5u, 7u, 3u) };
+		std::vector<peri::LPA> const expLPAs{ bulkSamplesLpa(5u, 7u, 3u) };
+		std::vector<peri::LPA> gotLPAs;
+		forEachChunk
+			( gridGen, 17u
+			, [&gotLPAs] (peri::LPA const * lpas, std::size_t num, std::size_t)
+				{ gotLPAs.insert(gotLPAs.end(), lpas, lpas + num); }
+			);
+		if (! (expLPAs == gotLPAs))
+		{
+			std::cerr << "Failure of GridGen test" << std::endl;
+			std::cerr << "exp size: " << expLPAs.size() << std::endl;
+			std::cerr << "got size: " << gotLPAs.size() << std::endl;
+			++errCount;
+		}
+
+		// meridian plane generator matches materialized samples
+		SampleSpec const radSpec{ 9u, Range{ 6.3e6, 6.4e6 } };
+		SampleSpec const parSpec{ 11u, sRangePar };
+		MeridianPlaneGen const merGen{ radSpec, parSpec };
+		std::vector<peri::XYZ> const expXYZs
+			{ meridianPlaneSamples(radSpec, parSpec) };
+		bool sameMer{ expXYZs.size() == merGen.size() };
+		for (std::size_t nn{0u} ; sameMer && (nn < expXYZs.size()) ; ++nn)
+		{
+			sameMer = (expXYZs[nn] == merGen.valueAt(nn));
+		}
+		if (! sameMer)
+		{
+			std::cerr << "Failure of MeridianPlaneGen test" << std::endl;
+			++errCount;
+		}
+
+		// parallel partitions visit each index once with same values
+		RandomGen const randGen{ 10007u, 42u };
+		std::vector<peri::LPA> parLPAs(randGen.size());
+		std::vector<int> visits(randGen.size(), 0);
+		forEachChunkParallel
+			( randGen, 64u, 3u
+			, [&parLPAs, &visits]
+				(peri::LPA const * lpas, std::size_t num, std::size_t beg)
+				{
+					for (std::size_t nn{0u} ; nn < num ; ++nn)
+					{
+						parLPAs[beg + nn] = lpas[nn];
+						++visits[beg + nn];
+					}
+				}
+			);
+		std::size_t numBad{ 0u };
+		for (std::size_t nn{0u} ; nn < randGen.size() ; ++nn)
+		{
+			peri::LPA const & lpa = parLPAs[nn];
+			bool const okay
+				{  (1 == visits[nn])
+				&& (lpa == randGen.valueAt(nn))
+				&& (randGen.theLonRange.first <= lpa[0])
+				&& (lpa[0] <= randGen.theLonRange.second)
+				&& (randGen.theParRange.first <= lpa[1])
+				&& (lpa[1] <= randGen.theParRange.second)
+				&& (randGen.theAltRange.first <= lpa[2])
+				&& (lpa[2] <= randGen.theAltRange.second)
+				};
+			if (! okay)
+			{
+				++numBad;
+			}
+		}
+		if (! (0u == numBad))
+		{
+			std::cerr << "Failure of RandomGen parallel test" << std::endl;
+			std::cerr << "numBad: " << numBad << std::endl;
+			++errCount;
+		}
+
+		// Fibonacci samples are balanced between hemispheres
+		FibonacciGen const fibGen{ 1000u, 0. };
+		std::size_t numNorth{ 0u };
+		for (std::size_t nn{0u} ; nn < fibGen.size() ; ++nn)
+		{
+			if (0. < fibGen.valueAt(nn)[1])
+			{
+				++numNorth;
+			}
+		}
+		if (! ((fibGen.size() / 2u) == numNorth))
+		{
+			std::cerr << "Failure of FibonacciGen balance test" << std::endl;
+			std::cerr << "numNorth: " << numNorth << std::endl;
+			++errCount;
+		}
+
+		return errCount;
+	}
+
 }
 
 
@@ -135,6 +243,7 @@ main
 	int errCount{ 0 };
 	errCount += test0();
 	errCount += test1();
+	errCount += test2();
 	return errCount;
 }
 
@@ -0,0 +1,267 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periMapFile.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Put records into (binary) file
+	inline
+	void
+	saveRecords
+		( std::string const & path
+		, std::vector<peri::mapped::Triple> const & recs
+		, std::size_t const & numExtraBytes = 0u
+		)
+	{
+		std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+		ofs.write
+			( reinterpret_cast<char const *>(recs.data())
+			, static_cast<std::streamsize>(recs.size() * sizeof(recs[0]))
+			);
+		for (std::size_t nn{0u} ; nn < numExtraBytes ; ++nn)
+		{
+			ofs.put('\0');
+		}
+	}
+
+	//! Records from (binary) file
+	inline
+	std::vector<peri::mapped::Triple>
+	loadRecords
+		( std::string const & path
+		)
+	{
+		std::vector<peri::mapped::Triple> recs;
+		std::ifstream ifs(path, std::ios::binary);
+		peri::mapped::Triple rec;
+		while (ifs.read(reinterpret_cast<char *>(&rec), sizeof(rec)))
+		{
+			recs.emplace_back(rec);
+		}
+		return recs;
+	}
+
+	//! Check mapped file conversion (to new file and in-place)
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(17u, 13u, 7u) };
+		std::vector<peri::XYZ> expXYZs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), expXYZs.data());
+		std::vector<peri::LPA> expLPAs(lpas.size());
+		peri::batch::lpaForXyz(expXYZs.data(), lpas.size(), expLPAs.data());
+
+		std::string const pathA{ "testMapFileA.bin" };
+		std::string const pathB{ "testMapFileB.bin" };
+		saveRecords(pathA, lpas);
+
+		// to new file (with small chunks via several threads)
+		using namespace peri::mapped;
+		constexpr std::size_t numThreads{ 4u };
+		constexpr std::size_t numPerChunk{ 100u };
+		std::string const errA
+			{ convertFile
+				( XyzForLpa, pathA, pathB, peri::model::WGS84
+				, numThreads, numPerChunk
+				)
+			};
+		std::vector<peri::XYZ> const gotXYZs{ loadRecords(pathB) };
+
+		// in place (output overwrites input)
+		std::string const errB{ convertFile(LpaForXyz, pathB) };
+		std::vector<peri::LPA> const gotLPAs{ loadRecords(pathB) };
+
+		if (! (errA.empty() && errB.empty()))
+		{
+			std::cerr << "Failure of mapped conversion status test" << '\n';
+			std::cerr << "errA: " << errA << '\n';
+			std::cerr << "errB: " << errB << '\n';
+			++errCount;
+		}
+		else
+		if (! ((expXYZs == gotXYZs) && (expLPAs == gotLPAs)))
+		{
+			std::cerr << "Failure of mapped conversion values test" << '\n';
+			std::cerr << "exp size: " << expXYZs.size() << '\n';
+			std::cerr << "got sizes: " << gotXYZs.size()
+				<< ", " << gotLPAs.size() << '\n';
+			++errCount;
+		}
+
+		// direct use of parallel chunking (more threads than chunks)
+		std::vector<peri::XYZ> chunkXYZs(lpas.size());
+		convertRecords
+			(XyzForLpa, lpas.data(), lpas.size(), chunkXYZs.data()
+			, peri::model::WGS84, 8u, 100u
+			);
+		if (! (expXYZs == chunkXYZs))
+		{
+			std::cerr << "Failure of chunked conversion test" << '\n';
+			++errCount;
+		}
+
+		// zero chunk size (treated as single record chunks)
+		std::vector<peri::XYZ> zeroXYZs(lpas.size());
+		convertRecords
+			(XyzForLpa, lpas.data(), lpas.size(), zeroXYZs.data()
+			, peri::model::WGS84, 2u, 0u
+			);
+		if (! (expXYZs == zeroXYZs))
+		{
+			std::cerr << "Failure of zero chunk size test" << '\n';
+			++errCount;
+		}
+
+		std::remove(pathA.c_str());
+		std::remove(pathB.c_str());
+		return errCount;
+	}
+
+	//! Check handling of empty, missing, and malformed files
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::mapped;
+		std::string const pathA{ "testMapFileEmpty.bin" };
+		std::string const pathB{ "testMapFileOut.bin" };
+		std::string const pathC{ "testMapFileBad.bin" };
+		saveRecords(pathA, {});
+		saveRecords(pathC, { { 1., 2., 3. } }, 5u);
+
+		std::string const errEmpty{ convertFile(LpaForXyz, pathA, pathB) };
+		std::string const errMissing
+			{ convertFile(LpaForXyz, "testMapFileNotThere.bin", pathB) };
+		std::string const errBad{ convertFile(LpaForXyz, pathC, pathB) };
+
+		if (! errEmpty.empty())
+		{
+			std::cerr << "Failure of empty file test" << '\n';
+			std::cerr << "errEmpty: " << errEmpty << '\n';
+			++errCount;
+		}
+		if (errMissing.empty() || errBad.empty())
+		{
+			std::cerr << "Failure of bad file detection test" << '\n';
+			std::cerr << "errMissing: " << errMissing << '\n';
+			std::cerr << "errBad: " << errBad << '\n';
+			++errCount;
+		}
+
+		std::remove(pathA.c_str());
+		std::remove(pathB.c_str());
+		std::remove(pathC.c_str());
+		return errCount;
+	}
+
+	//! Check output paths aliasing the input are converted in place
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(7u, 5u, 3u) };
+		std::vector<peri::XYZ> expXYZs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), expXYZs.data());
+		std::vector<peri::LPA> expLPAs(lpas.size());
+		peri::batch::lpaForXyz(expXYZs.data(), lpas.size(), expLPAs.data());
+
+		std::string const pathA{ "testMapFileAlias.bin" };
+		std::string const pathDot{ "./" + pathA };
+		std::string const pathLink{ "testMapFileAliasLink.bin" };
+		saveRecords(pathA, lpas);
+		std::remove(pathLink.c_str());
+		bool const okayLink{ 0 == ::symlink(pathA.c_str(), pathLink.c_str()) };
+
+		// same file via different spelling
+		using namespace peri::mapped;
+		std::string const errDot{ convertFile(XyzForLpa, pathA, pathDot) };
+		std::vector<peri::XYZ> const gotXYZs{ loadRecords(pathA) };
+
+		// same file via symbolic link
+		std::string const errLink{ convertFile(LpaForXyz, pathA, pathLink) };
+		std::vector<peri::LPA> const gotLPAs{ loadRecords(pathA) };
+
+		if (! (okayLink && errDot.empty() && errLink.empty()))
+		{
+			std::cerr << "Failure of aliased path status test" << '\n';
+			std::cerr << "okayLink: " << okayLink << '\n';
+			std::cerr << "errDot: " << errDot << '\n';
+			std::cerr << "errLink: " << errLink << '\n';
+			++errCount;
+		}
+		else
+		if (! ((expXYZs == gotXYZs) && (expLPAs == gotLPAs)))
+		{
+			std::cerr << "Failure of aliased path values test" << '\n';
+			std::cerr << "exp size: " << expXYZs.size() << '\n';
+			std::cerr << "got sizes: " << gotXYZs.size()
+				<< ", " << gotLPAs.size() << '\n';
+			++errCount;
+		}
+
+		std::remove(pathLink.c_str());
+		std::remove(pathA.c_str());
+		return errCount;
+	}
+
+}
+
+
+//! Check memory mapped file conversion
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // conversion to new file and in place
+	errCount += test1(); // special files
+	errCount += test2(); // output path aliasing input file
+	return errCount;
+}
@@ -0,0 +1,155 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periPipeline.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+	//! Check fused pipeline agrees with stage by stage evaluation
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::pipeline;
+		peri::EarthModel const & earth = peri::model::WGS84;
+
+		// arbitrary (but typical magnitude) datum shift
+		Helmert const datum
+			( Triple{{ -0.991, 1.9072, 0.5129 }}
+			, Triple{{ 1.25033e-7, 4.6785e-8, 5.6529e-8 }}
+			, 0.
+			);
+		Geodetic const geodetic(earth);
+		// tile with origin at (1,.5)[rad] and 1e-7[deg] angle units
+		peri::batch::FixedScale const fixScale
+			{ peri::batch::FixedScale::lpaDegE7Mm() };
+		Offset const tile(Triple{{ 1., .5, 0. }});
+		Quantize<std::int32_t> const quantize(fixScale);
+
+		auto const pipe{ make(datum, geodetic, tile).then(quantize) };
+
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(7u, 11u, 5u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<peri::XYZ> xyzs(numPnts);
+		peri::batch::xyzForLpa(lpas.data(), numPnts, xyzs.data(), earth);
+
+		std::vector<std::array<std::int32_t, 3u> > gotInts(numPnts);
+		pipe.run(xyzs.data(), numPnts, gotInts.data());
+
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			std::array<std::int32_t, 3u> const expInts
+				{ quantize(tile(geodetic(datum(xyzs[nn])))) };
+			if (! ((expInts == gotInts[nn]) && (expInts == pipe(xyzs[nn]))))
+			{
+				std::cerr << "Failure of fused pipeline test" << '\n';
+				std::cerr << "exp: " << expInts[0] << ' ' << expInts[1]
+					<< ' ' << expInts[2] << '\n';
+				std::cerr << "got: " << gotInts[nn][0] << ' ' << gotInts[nn][1]
+					<< ' ' << gotInts[nn][2] << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check individual stage values
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		using namespace peri::pipeline;
+		peri::EarthModel const & earth = peri::model::WGS84;
+
+		// pure translation and pure scale
+		Triple const xyz{{ 1000., 2000., 3000. }};
+		Triple const expShift{{ 1001., 2002., 3003. }};
+		Triple const gotShift{ Helmert(Triple{{ 1., 2., 3. }})(xyz) };
+		Triple const expScale{{ 1000.001, 2000.002, 3000.003 }};
+		Triple const gotScale
+			{ Helmert(Triple{{ 0., 0., 0. }}, Triple{{ 0., 0., 0. }}, 1.)(xyz) };
+		if (! (  peri::xyz::sameEnough(gotShift, expShift)
+			  && peri::xyz::sameEnough(gotScale, expScale)
+			  ))
+		{
+			std::cerr << "Failure of Helmert stage test" << '\n';
+			std::cerr << peri::xyz::infoString(gotShift, "gotShift") << '\n';
+			std::cerr << peri::xyz::infoString(gotScale, "gotScale") << '\n';
+			++errCount;
+		}
+
+		// local frame: above, east and north of origin
+		peri::LPA const origin{ 1., .5, 0. };
+		auto const enuOf{ make(Cartesian(earth), LocalEnu(origin, earth)) };
+		Triple const gotUp{ enuOf(peri::LPA{ 1., .5, 100. }) };
+		Triple const gotEast{ enuOf(peri::LPA{ 1.000001, .5, 0. }) };
+		Triple const gotNorth{ enuOf(peri::LPA{ 1., .500001, 0. }) };
+		if (! (  peri::xyz::sameEnough(gotUp, Triple{{ 0., 0., 100. }})
+			  && (0. < gotEast[0]) && (std::abs(gotEast[1]) < 1.e-3)
+			  && (0. < gotNorth[1]) && (std::abs(gotNorth[0]) < 1.e-9)
+			  ))
+		{
+			std::cerr << "Failure of LocalEnu stage test" << '\n';
+			std::cerr << peri::xyz::infoString(gotUp, "gotUp") << '\n';
+			std::cerr << peri::xyz::infoString(gotEast, "gotEast") << '\n';
+			std::cerr << peri::xyz::infoString(gotNorth, "gotNorth") << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check fused pipeline composition (periPipeline.h)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // fused same as stage by stage
+	errCount += test1(); // stage values
+	return errCount;
+}
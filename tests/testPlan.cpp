@@ -0,0 +1,223 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periPlan.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	//! Check planned execution produces same values as batch functions
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		std::vector<peri::LPA> const expLPAs
+			{ peri::sim::bulkSamplesLpa(17u, 19u, 23u) };
+		std::size_t const numPnts{ expLPAs.size() };
+		std::vector<peri::XYZ> expXYZs(numPnts);
+		peri::batch::xyzForLpa(expLPAs.data(), numPnts, expXYZs.data(), earth);
+
+		peri::Plan const planXyz(earth, peri::plan::XyzForLpa, numPnts);
+		peri::Plan const planLpa(earth, peri::plan::LpaForXyz, numPnts);
+		std::vector<peri::XYZ> gotXYZs(numPnts);
+		planXyz.execute(expLPAs.data(), gotXYZs.data());
+		std::vector<peri::LPA> gotLPAs(numPnts);
+		planLpa.execute(gotXYZs.data(), gotLPAs.data());
+
+		std::vector<peri::LPA> expRoundLPAs(numPnts);
+		peri::batch::lpaForXyz
+			(expXYZs.data(), numPnts, expRoundLPAs.data(), earth);
+		if (! ((gotXYZs == expXYZs) && (gotLPAs == expRoundLPAs)))
+		{
+			std::cerr << "Failure of plan execution test" << '\n';
+			std::cerr << "planXyz: " << planXyz.choice().theKernelName
+				<< " threads: " << planXyz.choice().theNumThreads << '\n';
+			std::cerr << "planLpa: " << planLpa.choice().theKernelName
+				<< " threads: " << planLpa.choice().theNumThreads << '\n';
+			++errCount;
+		}
+
+		if (planXyz.fromWisdom() || (! (0u < planXyz.choice().theNumThreads)))
+		{
+			std::cerr << "Failure of plan choice test" << '\n';
+			++errCount;
+		}
+
+		// small problems are not worth starting threads
+		std::size_t const numSmall{ peri::plan::sMinPntsPerThread - 1u };
+		peri::Plan const planSmall
+			( earth, peri::plan::XyzForLpa, numSmall, nullptr
+			, peri::plan::Layout::packed(), {}, 4u
+			);
+		if (! (1u == planSmall.choice().theNumThreads))
+		{
+			std::cerr << "Failure of small plan serial test" << '\n';
+			std::cerr << "threads: " << planSmall.choice().theNumThreads << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check wisdom persistence and use for strided records
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		// record with location between other fields
+		struct Record
+		{
+			double theTime;
+			double theLoc[3];
+		};
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(11u, 7u, 5u) };
+		std::size_t const numPnts{ lpas.size() };
+		std::vector<Record> recs(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::XYZ const xyz{ peri::xyzForLpa(lpas[nn], earth) };
+			recs[nn].theTime = double(nn);
+			std::memcpy(recs[nn].theLoc, xyz.data(), sizeof(xyz));
+		}
+		peri::plan::Layout const layout{ sizeof(Record), sizeof(Record) };
+
+		// plan adds its decision to wisdom...
+		peri::plan::Wisdom wisdom;
+		peri::Plan const plan1
+			(earth, peri::plan::LpaForXyz, numPnts, &wisdom, layout);
+		std::ostringstream oss;
+		wisdom.save(oss);
+
+		// ... that is restored and used by subsequent plan
+		peri::plan::Wisdom wisdom2;
+		std::istringstream iss(oss.str());
+		bool const okayLoad{ wisdom2.load(iss) };
+		peri::Plan const plan2
+			(earth, peri::plan::LpaForXyz, numPnts, &wisdom2, layout);
+		if (! ( okayLoad
+			  && (1u == wisdom.size())
+			  && (1u == wisdom2.size())
+			  && (! plan1.fromWisdom())
+			  && plan2.fromWisdom()
+			  && (plan2.choice().theKernelName == plan1.choice().theKernelName)
+			  && (plan2.choice().theNumThreads == plan1.choice().theNumThreads)
+			  && (plan2.choice().theChunkSize == plan1.choice().theChunkSize)
+			  ))
+		{
+			std::cerr << "Failure of wisdom persistence test" << '\n';
+			std::cerr << "wisdom:\n" << oss.str() << '\n';
+			++errCount;
+		}
+
+		// wisdom (e.g. edited) may select any valid strategy
+		std::ostringstream ossForce;
+		ossForce << "# forced choice\n"
+			<< plan1.key() << " strided 3 100 0.\n";
+		peri::plan::Wisdom wisdom3;
+		std::istringstream issForce(ossForce.str());
+		wisdom3.load(issForce);
+		peri::Plan const plan3
+			(earth, peri::plan::LpaForXyz, numPnts, &wisdom3, layout);
+		plan3.execute(recs.data()->theLoc, recs.data()->theLoc);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			peri::LPA gotLPA;
+			std::memcpy(gotLPA.data(), recs[nn].theLoc, sizeof(gotLPA));
+			peri::LPA const expLPA
+				{ peri::lpaForXyz(peri::xyzForLpa(lpas[nn], earth), earth) };
+			if (! ((expLPA == gotLPA) && (double(nn) == recs[nn].theTime)))
+			{
+				std::cerr << "Failure of forced wisdom strided test" << '\n';
+				std::cerr << peri::lpa::infoString(expLPA, "expLPA") << '\n';
+				std::cerr << peri::lpa::infoString(gotLPA, "gotLPA") << '\n';
+				++errCount;
+				break;
+			}
+		}
+		if (! (plan3.fromWisdom() && (3u == plan3.choice().theNumThreads)))
+		{
+			std::cerr << "Failure of forced wisdom choice test" << '\n';
+			++errCount;
+		}
+
+		// packed-only kernel is not valid for strided layout (so retune)
+		std::ostringstream ossBad;
+		ossBad << plan1.key() << " packed 1 100 0.\n";
+		peri::plan::Wisdom wisdom4;
+		std::istringstream issBad(ossBad.str());
+		wisdom4.load(issBad);
+		peri::Plan const plan4
+			(earth, peri::plan::LpaForXyz, numPnts, &wisdom4, layout);
+		if (plan4.fromWisdom() || ("strided" != plan4.choice().theKernelName))
+		{
+			std::cerr << "Failure of invalid wisdom test" << '\n';
+			++errCount;
+		}
+
+		// malformed wisdom is reported
+		std::istringstream issJunk("some junk\n");
+		if (wisdom4.load(issJunk))
+		{
+			std::cerr << "Failure of malformed wisdom test" << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+//! Check behavior of transformation plans (periPlan.h)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // plan execution same as batch
+	errCount += test1(); // wisdom save/load and strided layout
+	return errCount;
+}
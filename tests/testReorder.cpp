@@ -0,0 +1,251 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+/*! \file
+ * \brief Check locality ordered (Morton key) batch conversion.
+ */
+
+
+#include "periReorder.h"
+
+#include "periBatch.h"
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+
+namespace
+{
+	//! Check Morton key bit interleaving and ordering
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		// key for cube center has high bit of each component set
+		std::uint64_t const gotMid{ peri::reorder::mortonKeyFor({{ 0., 0., 0. }}) };
+		std::uint64_t const expMid{ std::uint64_t(7u) << 60u };
+		if (! (expMid == gotMid))
+		{
+			std::cerr << "Failure of mortonKeyFor center test\n";
+			std::cerr << "exp: " << std::hex << expMid << '\n';
+			std::cerr << "got: " << std::hex << gotMid << std::dec << '\n';
+			++errCount;
+		}
+
+		// clamped corners are extreme keys
+		std::uint64_t const gotMin
+			{ peri::reorder::mortonKeyFor({{ -1.e+9, -1.e+9, -1.e+9 }}) };
+		std::uint64_t const gotMax
+			{ peri::reorder::mortonKeyFor({{ 1.e+9, 1.e+9, 1.e+9 }}) };
+		std::uint64_t const expMax{ (std::uint64_t(1u) << 63u) - 1u };
+		if (! ((0u == gotMin) && (expMax == gotMax)))
+		{
+			std::cerr << "Failure of mortonKeyFor clamp test\n";
+			std::cerr << "gotMin: " << std::hex << gotMin << '\n';
+			std::cerr << "gotMax: " << std::hex << gotMax << std::dec << '\n';
+			++errCount;
+		}
+
+		// order is a permutation with non-decreasing keys
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(16u, 8u, 4u) };
+		std::vector<peri::XYZ> xyzs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), xyzs.data());
+		std::vector<std::size_t> const order
+			{ peri::reorder::mortonOrderFor(xyzs.data(), xyzs.size()) };
+		std::vector<std::size_t> sorted(order);
+		std::sort(sorted.begin(), sorted.end());
+		bool okayPerm{ (sorted.size() == xyzs.size()) };
+		for (std::size_t nn{0u} ; okayPerm && (nn < sorted.size()) ; ++nn)
+		{
+			okayPerm = (nn == sorted[nn]);
+		}
+		bool okayKeys{ true };
+		for (std::size_t nn{1u} ; okayPerm && (nn < order.size()) ; ++nn)
+		{
+			okayKeys &= ! (peri::reorder::mortonKeyFor(xyzs[order[nn]])
+				< peri::reorder::mortonKeyFor(xyzs[order[nn-1u]]));
+		}
+		if (! (okayPerm && okayKeys))
+		{
+			std::cerr << "Failure of mortonOrderFor test\n";
+			std::cerr << "okayPerm: " << okayPerm << '\n';
+			std::cerr << "okayKeys: " << okayKeys << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check reordered conversion agrees with batch conversion
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		peri::sim::RandomGen const gen
+			{ 10000u, 61u, peri::sim::sRangeLon, peri::sim::sRangePar };
+		std::size_t const numPnts{ gen.size() };
+		std::vector<peri::LPA> lpaIns(numPnts);
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			lpaIns[nn] = gen.valueAt(nn);
+		}
+		std::vector<peri::XYZ> xyzs(numPnts);
+		peri::batch::xyzForLpa(lpaIns.data(), numPnts, xyzs.data(), earth);
+
+		std::vector<peri::LPA> expLpas(numPnts);
+		peri::batch::lpaForXyz(xyzs.data(), numPnts, expLpas.data(), earth);
+
+		// both in Morton order and (unordered) as given
+		std::vector<peri::LPA> gotReords(numPnts);
+		peri::reorder::lpaForXyzReordered
+			(xyzs.data(), numPnts, gotReords.data(), earth);
+		std::vector<peri::LPA> gotWarms(numPnts);
+		peri::reorder::lpaForXyzWarm
+			(xyzs.data(), numPnts, gotWarms.data(), earth);
+
+		std::size_t numBad{ 0u };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			bool const okay
+				{  peri::lpa::sameEnough(gotReords[nn], expLpas[nn], 1.e-12, 1.e-6)
+				&& peri::lpa::sameEnough(gotWarms[nn], expLpas[nn], 1.e-12, 1.e-6)
+				};
+			if (! okay)
+			{
+				if (0u == numBad)
+				{
+					std::cerr << "Failure of reordered conversion test\n";
+					std::cerr << "exp: " << peri::lpa::infoString(expLpas[nn]) << '\n';
+					std::cerr << "reo: " << peri::lpa::infoString(gotReords[nn]) << '\n';
+					std::cerr << "wrm: " << peri::lpa::infoString(gotWarms[nn]) << '\n';
+				}
+				++numBad;
+			}
+		}
+		if (0u < numBad)
+		{
+			std::cerr << "numBad: " << numBad << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check invalid records do not affect results for later records
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::WGS84;
+		std::vector<peri::LPA> const lpaIns
+			{ peri::sim::bulkSamplesLpa(8u, 8u, 4u) };
+		std::size_t const numPnts{ lpaIns.size() };
+		std::vector<peri::XYZ> xyzs(numPnts);
+		peri::batch::xyzForLpa(lpaIns.data(), numPnts, xyzs.data(), earth);
+		// invalid and distant records mid-stream
+		std::size_t const ndxNan{ numPnts / 3u };
+		std::size_t const ndxInf{ numPnts / 2u };
+		std::size_t const ndxFar{ (2u * numPnts) / 3u };
+		double const nan{ std::numeric_limits<double>::quiet_NaN() };
+		double const inf{ std::numeric_limits<double>::infinity() };
+		xyzs[ndxNan] = peri::XYZ{ nan, 1.e+6, 6.e+6 };
+		xyzs[ndxInf] = peri::XYZ{ 1.e+6, inf, 6.e+6 };
+		xyzs[ndxFar] = peri::XYZ{ 1.e+11, -1.e+11, 1.e+11 };
+
+		std::vector<peri::LPA> expLpas(numPnts);
+		peri::batch::lpaForXyz(xyzs.data(), numPnts, expLpas.data(), earth);
+		std::vector<peri::LPA> gotWarms(numPnts);
+		peri::reorder::lpaForXyzWarm
+			(xyzs.data(), numPnts, gotWarms.data(), earth);
+		std::vector<peri::LPA> gotReords(numPnts);
+		peri::reorder::lpaForXyzReordered
+			(xyzs.data(), numPnts, gotReords.data(), earth);
+
+		std::size_t numBad{ 0u };
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			if ((ndxNan == nn) || (ndxInf == nn))
+			{
+				continue;
+			}
+			bool const okay
+				{  peri::lpa::sameEnough(gotWarms[nn], expLpas[nn], 1.e-12, 1.e-6)
+				&& peri::lpa::sameEnough(gotReords[nn], expLpas[nn], 1.e-12, 1.e-6)
+				};
+			if (! okay)
+			{
+				if (0u == numBad)
+				{
+					std::cerr << "Failure of invalid record test\n";
+					std::cerr << "nn: " << nn << '\n';
+					std::cerr << "exp: " << peri::lpa::infoString(expLpas[nn]) << '\n';
+					std::cerr << "wrm: " << peri::lpa::infoString(gotWarms[nn]) << '\n';
+					std::cerr << "reo: " << peri::lpa::infoString(gotReords[nn]) << '\n';
+				}
+				++numBad;
+			}
+		}
+		if (0u < numBad)
+		{
+			std::cerr << "numBad: " << numBad << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+} // [annon]
+
+
+//! Check locality ordered (Morton key) batch conversion
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // Morton key values and ordering
+	errCount += test1(); // reordered conversion vs batch conversion
+	errCount += test2(); // invalid records within the input stream
+	return errCount;
+}
+
@@ -0,0 +1,257 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#define PERIDETIC_TRACE // enable trace points (for this test program)
+#include "periBatch.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	//! Number of records with phase and name
+	std::size_t
+	countOf
+		( std::vector<peri::trace::Record> const & recs
+		, char const & phase
+		, std::string const & name
+		)
+	{
+		std::size_t count{ 0u };
+		for (peri::trace::Record const & rec : recs)
+		{
+			if ((phase == rec.thePhase) && (name == rec.theName))
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+
+	//! Check trace events recorded from batch calls on several threads
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::LPA> const lpas{ peri::sim::bulkSamplesLpa(5u, 5u, 5u) };
+		constexpr std::size_t numThreads{ 4u };
+		constexpr std::size_t numCalls{ 3u };
+		std::vector<std::thread> threads;
+		for (std::size_t nt{0u} ; nt < numThreads ; ++nt)
+		{
+			threads.emplace_back
+				( [&lpas] ()
+					{
+						std::vector<peri::XYZ> xyzs(lpas.size());
+						for (std::size_t nc{0u} ; nc < numCalls ; ++nc)
+						{
+							peri::batch::xyzForLpa
+								(lpas.data(), lpas.size(), xyzs.data());
+						}
+					}
+				);
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+
+		// polar axis location exercises longitude fallback trace point
+		peri::XYZ const xyzPole{ 0., 0., 6400000. };
+		peri::LPA lpaPole{};
+		peri::batch::lpaForXyz(&xyzPole, 1u, &lpaPole);
+
+		std::vector<peri::trace::Record> const recs{ peri::trace::records() };
+
+		std::string const nameXyz{ "peri::batch::xyzForLpa" };
+		std::size_t const expCount{ numThreads * numCalls };
+		std::size_t const gotBegs{ countOf(recs, 'B', nameXyz) };
+		std::size_t const gotEnds{ countOf(recs, 'E', nameXyz) };
+		if (! ((expCount == gotBegs) && (expCount == gotEnds)))
+		{
+			std::cerr << "Failure of batch begin/end trace count test" << '\n';
+			std::cerr << "expCount: " << expCount << '\n';
+			std::cerr << "gotBegs: " << gotBegs << '\n';
+			std::cerr << "gotEnds: " << gotEnds << '\n';
+			++errCount;
+		}
+
+		std::string const namePole{ "peri::anglesLonParOf:polarAxis" };
+		if (! (0u < countOf(recs, 'i', namePole)))
+		{
+			std::cerr << "Failure of polar axis mark trace test" << '\n';
+			++errCount;
+		}
+
+		// records should be in time order
+		for (std::size_t nn{1u} ; nn < recs.size() ; ++nn)
+		{
+			if (recs[nn].theTime < recs[nn-1u].theTime)
+			{
+				std::cerr << "Failure of record time order test" << '\n';
+				++errCount;
+				break;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check save/load of records and Chrome JSON output
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::trace::Record> const expRecs
+			{ { "some name", 1000u, 7u, 0u, 'B' }
+			, { "some name", 3500u, 7u, 0u, 'E' }
+			, { "mark \"quoted\"", 4000u, 8u, 1u, 'i' }
+			};
+
+		std::stringstream strm;
+		peri::trace::saveRecords(strm, expRecs);
+		std::vector<peri::trace::Record> const gotRecs
+			{ peri::trace::loadRecords(strm) };
+
+		bool same{ expRecs.size() == gotRecs.size() };
+		for (std::size_t nn{0u} ; same && (nn < gotRecs.size()) ; ++nn)
+		{
+			peri::trace::Record const & exp = expRecs[nn];
+			peri::trace::Record const & got = gotRecs[nn];
+			same =
+				(  (exp.theName == got.theName)
+				&& (exp.theTime == got.theTime)
+				&& (exp.theValue == got.theValue)
+				&& (exp.theThreadId == got.theThreadId)
+				&& (exp.thePhase == got.thePhase)
+				);
+		}
+		if (! same)
+		{
+			std::cerr << "Failure of record save/load test" << '\n';
+			++errCount;
+		}
+
+		std::ostringstream oss;
+		peri::trace::saveChromeJson(oss, gotRecs);
+		std::string const json{ oss.str() };
+		std::vector<std::string> const expParts
+			{ "{\"traceEvents\":["
+			, "\"ph\":\"B\",\"ts\":0.000,"
+			, "\"ph\":\"E\",\"ts\":2.500,"
+			, "\"name\":\"mark \\\"quoted\\\"\""
+			, "\"s\":\"t\""
+			};
+		for (std::string const & expPart : expParts)
+		{
+			if (std::string::npos == json.find(expPart))
+			{
+				std::cerr << "Failure of Chrome JSON content test" << '\n';
+				std::cerr << "expPart: " << expPart << '\n';
+				std::cerr << "json:\n" << json << '\n';
+				++errCount;
+			}
+		}
+
+		return errCount;
+	}
+
+	//! Check loading of truncated and malformed record files
+	int
+	test2
+		()
+	{
+		int errCount{ 0 };
+
+		std::vector<peri::trace::Record> const expRecs
+			{ { "first", 1000u, 7u, 0u, 'B' }
+			, { "second", 3500u, 7u, 0u, 'E' }
+			, { "third", 4000u, 8u, 1u, 'i' }
+			};
+		std::ostringstream oss;
+		peri::trace::saveRecords(oss, expRecs);
+		std::string const text{ oss.str() };
+
+		// file with bad values and a truncated (e.g. interrupted) last line
+		std::string const path{ "testTraceTruncated.trace" };
+		{
+			std::ofstream ofs(path);
+			ofs << "7 B 12x34 0 bad time\n";
+			ofs << "4294967296 B 100 0 bad thread id\n";
+			ofs << "7 B 99999999999999999999999 0 overflow time\n";
+			ofs << text.substr(0u, text.size() - 12u);
+		}
+		std::ifstream ifs(path);
+		std::size_t numSkipped{ 0u };
+		std::vector<peri::trace::Record> const gotRecs
+			{ peri::trace::loadRecords(ifs, &numSkipped) };
+		if (! (  (2u == gotRecs.size())
+			  && (4u == numSkipped)
+			  && (expRecs[0].theName == gotRecs[0].theName)
+			  && (expRecs[1].theTime == gotRecs[1].theTime)
+			  ))
+		{
+			std::cerr << "Failure of truncated record file test" << '\n';
+			std::cerr << "gotRecs.size: " << gotRecs.size() << '\n';
+			std::cerr << "numSkipped: " << numSkipped << '\n';
+			++errCount;
+		}
+		std::remove(path.c_str());
+
+		return errCount;
+	}
+
+}
+
+
+//! Check trace point recording (with PERIDETIC_TRACE enabled)
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // recording from (multi-threaded) batch calls
+	errCount += test1(); // record save/load and JSON export
+	errCount += test2(); // truncated and malformed record files
+	return errCount;
+}
@@ -0,0 +1,162 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periViews.h"
+
+#include "periLocal.h"
+#include "periSim.h"
+
+#include <iostream>
+#include <ranges>
+#include <vector>
+
+
+namespace
+{
+	//! Check views produce same values as batch functions
+	int
+	test0
+		()
+	{
+		int errCount{ 0 };
+
+		peri::EarthModel const & earth = peri::model::GRS80;
+		std::vector<peri::LPA> const lpas
+			{ peri::sim::bulkSamplesLpa(13u, 11u, 7u) };
+		std::vector<peri::XYZ> expXYZs(lpas.size());
+		peri::batch::xyzForLpa(lpas.data(), lpas.size(), expXYZs.data(), earth);
+		std::vector<peri::LPA> expLPAs(lpas.size());
+		peri::batch::lpaForXyz
+			(expXYZs.data(), lpas.size(), expLPAs.data(), earth);
+
+		// round trip as one lazy pipeline
+		std::vector<peri::XYZ> gotXYZs;
+		std::vector<peri::LPA> gotLPAs;
+		for (peri::LPA const & lpa
+			: lpas
+			| peri::views::xyzForLpa(earth)
+			| std::views::transform
+				( [&gotXYZs] (peri::XYZ const & xyz)
+					{
+						gotXYZs.emplace_back(xyz);
+						return xyz;
+					}
+				)
+			| peri::views::lpaForXyz(earth)
+			)
+		{
+			gotLPAs.emplace_back(lpa);
+		}
+
+		if (! ((expXYZs == gotXYZs) && (expLPAs == gotLPAs)))
+		{
+			std::cerr << "Failure of view pipeline test" << '\n';
+			std::cerr << "exp size: " << expLPAs.size() << '\n';
+			std::cerr << "got sizes: " << gotXYZs.size()
+				<< ", " << gotLPAs.size() << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+	//! Check composition with filter/take and generated (lazy) sources
+	int
+	test1
+		()
+	{
+		int errCount{ 0 };
+
+		// generated meridian of locations (no source container)
+		auto const lpaAt
+			{ [] (int const & ndx)
+				{
+					return peri::LPA{ .5, peri::radForDeg(-89.5 + ndx), 100. };
+				}
+			};
+		auto const isNorth
+			{ [] (peri::XYZ const & xyz) { return (0. < xyz[2]); } };
+
+		// empty source
+		std::vector<peri::XYZ> const empty;
+		std::size_t numEmpty{ 0u };
+		for ([[maybe_unused]] peri::LPA const & lpa
+			: empty | peri::views::lpaForXyz())
+		{
+			++numEmpty;
+		}
+
+		// filtered and truncated pipeline (partial final block)
+		constexpr std::size_t numTake{ 77u };
+		std::size_t numGot{ 0u };
+		std::size_t numBad{ 0u };
+		int ndx{ 90 }; // northern results start after equator
+		for (peri::LPA const & lpa
+			: std::views::iota(0, 180)
+			| std::views::transform(lpaAt)
+			| peri::views::xyzForLpa()
+			| std::views::filter(isNorth)
+			| peri::views::lpaForXyz()
+			| std::views::take(numTake)
+			)
+		{
+			peri::LPA const expLPA{ lpaAt(ndx++) };
+			if (! peri::lpa::sameEnough(lpa, expLPA, 1.e-12, 1.e-6))
+			{
+				++numBad;
+			}
+			++numGot;
+		}
+
+		if (! ((0u == numEmpty) && (numTake == numGot) && (0u == numBad)))
+		{
+			std::cerr << "Failure of view composition test" << '\n';
+			std::cerr << "numEmpty: " << numEmpty << '\n';
+			std::cerr << "numGot: " << numGot << '\n';
+			std::cerr << "numBad: " << numBad << '\n';
+			++errCount;
+		}
+
+		return errCount;
+	}
+
+}
+
+
+//! Check (C++20) range view adaptors
+int
+main
+	()
+{
+	int errCount{ 0 };
+	errCount += test0(); // same as batch
+	errCount += test1(); // composition
+	return errCount;
+}
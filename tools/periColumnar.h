@@ -0,0 +1,647 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef peri_Columnar_INCL_
+#define peri_Columnar_INCL_
+
+
+/*! \file
+ * \brief Chunked columnar binary file format for XYZ or LPA point data.
+ *
+ * Layout (all values native little-endian, all sections 64-byte aligned
+ * relative to file start so memory mapped columns support SIMD loads):
+ * \verbatim
+ * FileHeader (64 bytes) : magic "periCol1", version, kind (XYZ/LPA)
+ * { // repeated for each chunk
+ *   ChunkHeader (192 bytes) : count, model id, encoding,
+ *     min/max of stored values, min/max of geodetic (LPA) values,
+ *     quantization step, column stride (bytes)
+ *   column[0] (count values, padded to column stride)
+ *   column[1] (ditto)
+ *   column[2] (ditto)
+ * }
+ * \endverbatim
+ *
+ * Column values are either float64 or (optionally) quantized as uint32
+ * steps from the chunk minimum: value = min + step*quant. Chunks with a
+ * range too large for quantization are stored as float64.
+ *
+ * Every chunk records geodetic bounds (computed on write for XYZ data)
+ * so readers may skip chunks outside of a lon/lat/alt window without
+ * reading (or transforming) chunk content.
+ */
+
+
+#include "periBatch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+
+namespace peri::columnar
+{
+	//! Values for one location (either XYZ or LPA)
+	using Triple = std::array<double, 3u>;
+
+	//! Alignment (bytes) of all file sections
+	constexpr std::size_t sAlign{ 64u };
+
+	//! Kind of coordinates stored in file
+	enum Kind : std::uint32_t
+	{
+		  KindXYZ = 1u
+		, KindLPA = 2u
+	};
+
+	//! Encoding of column values
+	enum Encoding : std::uint32_t
+	{
+		  Float64 = 1u //!< full precision
+		, Fixed32 = 2u //!< uint32 multiples of quantization step
+	};
+
+	//! Identification of earth model associated with chunk
+	enum ModelId : std::uint32_t
+	{
+		  ModelUnknown = 0u
+		, ModelWGS84 = 1u
+		, ModelGRS80 = 2u
+	};
+
+	//! Earth model for id (WGS84 if unknown)
+	inline
+	EarthModel const &
+	modelFor
+		( ModelId const & modelId
+		)
+	{
+		return (ModelGRS80 == modelId) ? model::GRS80 : model::WGS84;
+	}
+
+	//! Leading section of file
+	struct FileHeader
+	{
+		char theMagic[8];
+		std::uint32_t theVersion;
+		std::uint32_t theKind;
+		std::uint8_t thePad[48];
+
+	}; // FileHeader
+
+	static_assert(sAlign == sizeof(FileHeader), "FileHeader size");
+
+	//! Leading section of each chunk
+	struct ChunkHeader
+	{
+		char theTag[4];
+		std::uint32_t theEncoding;
+		std::uint32_t theModelId;
+		std::uint32_t theReserved;
+		std::uint64_t theCount; //!< number of points in chunk
+		std::uint64_t theColumnStride; //!< bytes per (padded) column
+		double theMins[3]; //!< minimum stored (XYZ or LPA) values
+		double theMaxs[3]; //!< maximum stored (XYZ or LPA) values
+		double theLpaMins[3]; //!< minimum geodetic values
+		double theLpaMaxs[3]; //!< maximum geodetic values
+		double theSteps[3]; //!< quantization step (if Fixed32)
+		std::uint8_t thePad[40];
+
+		//! Number of bytes of column data following header
+		inline
+		std::uint64_t
+		payloadSize  // ChunkHeader::
+			() const
+		{
+			return (3u * theColumnStride);
+		}
+
+	}; // ChunkHeader
+
+	static_assert(3u*sAlign == sizeof(ChunkHeader), "ChunkHeader size");
+
+	//! Geodetic region of interest (lon range may wrap if min > max)
+	struct Window
+	{
+		LPA theMins
+			{ -std::numeric_limits<double>::infinity()
+			, -std::numeric_limits<double>::infinity()
+			, -std::numeric_limits<double>::infinity()
+			};
+		LPA theMaxs
+			{ std::numeric_limits<double>::infinity()
+			, std::numeric_limits<double>::infinity()
+			, std::numeric_limits<double>::infinity()
+			};
+
+		//! True if (closed) range [minA,maxA] overlaps [minB,maxB]
+		inline
+		static
+		bool
+		overlap  // Window::
+			( double const & minA
+			, double const & maxA
+			, double const & minB
+			, double const & maxB
+			)
+		{
+			return (! ((maxA < minB) || (maxB < minA)));
+		}
+
+		//! True if chunk geodetic bounds might contain points in window
+		inline
+		bool
+		mayContain  // Window::
+			( ChunkHeader const & hdr
+			) const
+		{
+			double const * const mins{ hdr.theLpaMins };
+			double const * const maxs{ hdr.theLpaMaxs };
+			bool const lonOkay
+				{ (theMins[0] <= theMaxs[0])
+					? overlap(mins[0], maxs[0], theMins[0], theMaxs[0])
+					// across anti-meridian: [min,+inf] or [-inf,max]
+					: (  (theMins[0] <= maxs[0])
+					  || (mins[0] <= theMaxs[0])
+					  )
+				};
+			return
+				(  lonOkay
+				&& overlap(mins[1], maxs[1], theMins[1], theMaxs[1])
+				&& overlap(mins[2], maxs[2], theMins[2], theMaxs[2])
+				);
+		}
+
+	}; // Window
+
+	//! Smallest multiple of sAlign not less than numBytes
+	inline
+	std::uint64_t
+	alignedSize
+		( std::uint64_t const & numBytes
+		)
+	{
+		return ((numBytes + sAlign - 1u) / sAlign) * sAlign;
+	}
+
+	//! Per component min/max of points
+	inline
+	void
+	boundsOf
+		( Triple const * const & pnts
+		, std::size_t const & numPnts
+		, double * const & mins
+		, double * const & maxs
+		)
+	{
+		for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+		{
+			mins[nc] = std::numeric_limits<double>::infinity();
+			maxs[nc] = -std::numeric_limits<double>::infinity();
+		}
+		for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+		{
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				mins[nc] = std::min(mins[nc], pnts[nn][nc]);
+				maxs[nc] = std::max(maxs[nc], pnts[nn][nc]);
+			}
+		}
+	}
+
+	//! Composes columnar file chunk by chunk
+	class Writer
+	{
+		std::ostream * thePtStrm{ nullptr };
+		Kind theKind{ KindXYZ };
+		ModelId theModelId{ ModelUnknown };
+		Encoding theEncoding{ Float64 };
+		Triple theSteps{};
+		std::size_t theChunkSize{ 0u };
+		std::vector<unsigned char> theColumn{}; //!< scratch
+		std::vector<LPA> theLPAs{}; //!< scratch for XYZ geodetic bounds
+
+		//! Write one chunk of numPnts (<= theChunkSize) points
+		inline
+		void
+		writeChunk  // Writer::
+			( Triple const * const & pnts
+			, std::size_t const & numPnts
+			)
+		{
+			ChunkHeader hdr{};
+			std::memcpy(hdr.theTag, "chnk", 4u);
+			hdr.theModelId = theModelId;
+			hdr.theCount = numPnts;
+			boundsOf(pnts, numPnts, hdr.theMins, hdr.theMaxs);
+
+			// geodetic bounds
+			if (KindLPA == theKind)
+			{
+				std::copy(hdr.theMins, hdr.theMins + 3u, hdr.theLpaMins);
+				std::copy(hdr.theMaxs, hdr.theMaxs + 3u, hdr.theLpaMaxs);
+			}
+			else
+			{
+				theLPAs.resize(numPnts);
+				batch::lpaForXyz
+					(pnts, numPnts, theLPAs.data(), modelFor(theModelId));
+				boundsOf
+					(theLPAs.data(), numPnts, hdr.theLpaMins, hdr.theLpaMaxs);
+			}
+
+			// use quantization if requested and range is small enough
+			hdr.theEncoding = theEncoding;
+			if (Fixed32 == hdr.theEncoding)
+			{
+				constexpr double maxQuant
+					{ double(std::numeric_limits<std::uint32_t>::max()) };
+				for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+				{
+					hdr.theSteps[nc] = theSteps[nc];
+					// number of quantization levels must fit in uint32
+					double const range{ hdr.theMaxs[nc] - hdr.theMins[nc] };
+					double const numLevels{ range / theSteps[nc] + 1. };
+					if (! ((0. < theSteps[nc]) && (numLevels <= maxQuant)))
+					{
+						hdr.theEncoding = Float64;
+					}
+				}
+			}
+			std::size_t const valueSize
+				{ (Fixed32 == hdr.theEncoding)
+					? sizeof(std::uint32_t) : sizeof(double)
+				};
+			hdr.theColumnStride = alignedSize(valueSize * numPnts);
+
+			thePtStrm->write(reinterpret_cast<char const *>(&hdr), sizeof(hdr));
+			theColumn.assign(hdr.theColumnStride, 0u);
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+			{
+				unsigned char * const col{ theColumn.data() };
+				for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+				{
+					double const & value = pnts[nn][nc];
+					if (Fixed32 == hdr.theEncoding)
+					{
+						std::uint32_t const quant
+							{ static_cast<std::uint32_t>(std::llround
+								((value - hdr.theMins[nc]) / hdr.theSteps[nc]))
+							};
+						std::memcpy(col + nn*valueSize, &quant, valueSize);
+					}
+					else
+					{
+						std::memcpy(col + nn*valueSize, &value, valueSize);
+					}
+				}
+				thePtStrm->write
+					( reinterpret_cast<char const *>(col)
+					, static_cast<std::streamsize>(hdr.theColumnStride)
+					);
+			}
+		}
+
+	public:
+
+		/*! \brief Start file on stream (writes FileHeader)
+		 *
+		 * If encoding is Fixed32, values are quantized with per component
+		 * steps (e.g. {1.e-3, 1.e-3, 1.e-3} [m] for XYZ or
+		 * {1.e-10, 1.e-10, 1.e-3} [rad,rad,m] for LPA).
+		 */
+		explicit
+		Writer
+			( std::ostream & ostrm
+			, Kind const & kind
+			, ModelId const & modelId = ModelWGS84
+			, Encoding const & encoding = Float64
+			, Triple const & steps = {}
+			, std::size_t const & chunkSize = (1u << 16u)
+			)
+			: thePtStrm{ &ostrm }
+			, theKind{ kind }
+			, theModelId{ modelId }
+			, theEncoding{ encoding }
+			, theSteps{ steps }
+			, theChunkSize{ std::max(std::size_t{ 1u }, chunkSize) }
+		{
+			FileHeader hdr{};
+			std::memcpy(hdr.theMagic, "periCol1", 8u);
+			hdr.theVersion = 1u;
+			hdr.theKind = theKind;
+			thePtStrm->write(reinterpret_cast<char const *>(&hdr), sizeof(hdr));
+		}
+
+		//! Earth model identity recorded for subsequent chunks
+		inline
+		void
+		setModelId  // Writer::
+			( ModelId const & modelId
+			)
+		{
+			theModelId = modelId;
+		}
+
+		//! Append points (as one or more chunks)
+		inline
+		void
+		write  // Writer::
+			( Triple const * const & pnts
+			, std::size_t const & numPnts
+			)
+		{
+			for (std::size_t beg{0u} ; beg < numPnts ; beg += theChunkSize)
+			{
+				std::size_t const num{ std::min(theChunkSize, numPnts - beg) };
+				writeChunk(pnts + beg, num);
+			}
+		}
+
+		//! True if all writes have succeeded
+		inline
+		bool
+		isValid  // Writer::
+			() const
+		{
+			return thePtStrm->good();
+		}
+
+	}; // Writer
+
+	//! Sequential access to columnar file content
+	class Reader
+	{
+		std::istream * thePtStrm{ nullptr };
+		Kind theKind{ KindXYZ };
+		bool theIsValid{ false };
+		std::streamoff theEndPos{ -1 }; //!< stream size (if seekable)
+		std::vector<unsigned char> theColumn{}; //!< scratch
+
+	public:
+
+		//! Attach to stream (reads and checks FileHeader)
+		explicit
+		Reader
+			( std::istream & istrm
+			)
+			: thePtStrm{ &istrm }
+		{
+			FileHeader hdr{};
+			thePtStrm->read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+			theIsValid =
+				(  thePtStrm->good()
+				&& (0 == std::memcmp(hdr.theMagic, "periCol1", 8u))
+				&& (1u == hdr.theVersion)
+				&& ((KindXYZ == hdr.theKind) || (KindLPA == hdr.theKind))
+				);
+			if (theIsValid)
+			{
+				theKind = static_cast<Kind>(hdr.theKind);
+				// note size to detect truncation within skipped chunks
+				std::streampos const begPos{ thePtStrm->tellg() };
+				if (! (std::streampos(-1) == begPos))
+				{
+					thePtStrm->seekg(0, std::ios::end);
+					theEndPos = static_cast<std::streamoff>(thePtStrm->tellg());
+					thePtStrm->seekg(begPos);
+					theIsValid = thePtStrm->good();
+				}
+			}
+		}
+
+		//! True if file header was good (and no read errors since)
+		inline
+		bool
+		isValid  // Reader::
+			() const
+		{
+			return theIsValid;
+		}
+
+		//! Kind of coordinates in file
+		inline
+		Kind
+		kind  // Reader::
+			() const
+		{
+			return theKind;
+		}
+
+		/*! \brief Header of next chunk (false at end of file or on error).
+		 *
+		 * End of file exactly at a chunk boundary is a normal end (and
+		 * isValid() remains true). A partial (truncated) or unrecognized
+		 * chunk header is an error (isValid() becomes false).
+		 */
+		inline
+		bool
+		nextChunk  // Reader::
+			( ChunkHeader * const & ptHdr
+			)
+		{
+			bool got{ false };
+			if (theIsValid)
+			{
+				thePtStrm->read(reinterpret_cast<char *>(ptHdr), sizeof(*ptHdr));
+				if (thePtStrm->good())
+				{
+					got = (0 == std::memcmp(ptHdr->theTag, "chnk", 4u));
+					theIsValid = got;
+				}
+				else
+				{
+					bool const atBoundary
+						{ (0 == thePtStrm->gcount()) && thePtStrm->eof() };
+					theIsValid = atBoundary && (! thePtStrm->bad());
+				}
+			}
+			return got;
+		}
+
+		//! Pass over content of chunk (after nextChunk())
+		inline
+		void
+		skipChunk  // Reader::
+			( ChunkHeader const & hdr
+			)
+		{
+			thePtStrm->seekg
+				(static_cast<std::streamoff>(hdr.payloadSize()), std::ios::cur);
+			theIsValid = theIsValid && thePtStrm->good();
+			// (seeking beyond end of a file stream does not fail)
+			if (theIsValid && (! (theEndPos < 0)))
+			{
+				theIsValid = ! (theEndPos
+					< static_cast<std::streamoff>(thePtStrm->tellg()));
+			}
+		}
+
+		//! Load chunk content (after nextChunk()) into pnts (resized)
+		inline
+		bool
+		readChunk  // Reader::
+			( ChunkHeader const & hdr
+			, std::vector<Triple> * const & ptPnts
+			)
+		{
+			std::size_t const numPnts{ static_cast<std::size_t>(hdr.theCount) };
+			std::size_t const valueSize
+				{ (Fixed32 == hdr.theEncoding)
+					? sizeof(std::uint32_t) : sizeof(double)
+				};
+			theIsValid = theIsValid
+				&& ((Fixed32 == hdr.theEncoding) || (Float64 == hdr.theEncoding))
+				&& (! (hdr.theColumnStride < valueSize * numPnts));
+			if (theIsValid)
+			{
+				ptPnts->resize(numPnts);
+				theColumn.resize(static_cast<std::size_t>(hdr.theColumnStride));
+				for (std::size_t nc{0u} ; nc < 3u ; ++nc)
+				{
+					thePtStrm->read
+						( reinterpret_cast<char *>(theColumn.data())
+						, static_cast<std::streamsize>(theColumn.size())
+						);
+					unsigned char const * const col{ theColumn.data() };
+					for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+					{
+						double & value = (*ptPnts)[nn][nc];
+						if (Fixed32 == hdr.theEncoding)
+						{
+							std::uint32_t quant;
+							std::memcpy(&quant, col + nn*valueSize, valueSize);
+							value = hdr.theMins[nc] + hdr.theSteps[nc] * double(quant);
+						}
+						else
+						{
+							std::memcpy(&value, col + nn*valueSize, valueSize);
+						}
+					}
+				}
+				theIsValid = thePtStrm->good();
+			}
+			return theIsValid;
+		}
+
+	}; // Reader
+
+	//! Summary of transformFile() activity
+	struct Stats
+	{
+		std::size_t theNumChunks{ 0u };
+		std::size_t theNumSkipped{ 0u };
+		std::size_t theNumPnts{ 0u }; //!< number transformed
+		bool theIsValid{ false }; //!< false on read error (e.g. truncation)
+
+	}; // Stats
+
+	/*! \brief Transform chunks of columnar file into the other kind.
+	 *
+	 * XYZ input produces LPA output and vice versa (with same earth
+	 * model and chunking). Chunks with geodetic bounds outside window are
+	 * skipped without being read. \note Selection is per chunk: points
+	 * of overlapping chunks are all transformed (including those outside
+	 * of window).
+	 */
+	inline
+	Stats
+	transformFile
+		( std::istream & istrm
+		, std::ostream & ostrm
+		, Window const & window = {}
+		, Encoding const & encoding = Float64
+		, Triple const & steps = {}
+		)
+	{
+		Stats stats;
+		Reader reader(istrm);
+		if (reader.isValid())
+		{
+			Kind const outKind
+				{ (KindXYZ == reader.kind()) ? KindLPA : KindXYZ };
+			Writer writer(ostrm, outKind, ModelUnknown, encoding, steps);
+			std::vector<Triple> inPnts;
+			std::vector<Triple> outPnts;
+			ChunkHeader hdr{};
+			bool okay{ true };
+			while (okay && reader.nextChunk(&hdr))
+			{
+				++stats.theNumChunks;
+				if (! window.mayContain(hdr))
+				{
+					++stats.theNumSkipped;
+					reader.skipChunk(hdr);
+				}
+				else
+				{
+					okay = reader.readChunk(hdr, &inPnts);
+					if (okay)
+					{
+						ModelId const modelId
+							{ static_cast<ModelId>(hdr.theModelId) };
+						EarthModel const & earth = modelFor(modelId);
+						outPnts.resize(inPnts.size());
+						if (KindXYZ == reader.kind())
+						{
+							batch::lpaForXyz
+								( inPnts.data(), inPnts.size()
+								, outPnts.data(), earth
+								);
+						}
+						else
+						{
+							batch::xyzForLpa
+								( inPnts.data(), inPnts.size()
+								, outPnts.data(), earth
+								);
+						}
+						writer.setModelId(modelId);
+						writer.write(outPnts.data(), outPnts.size());
+						stats.theNumPnts += outPnts.size();
+					}
+				}
+			}
+			stats.theIsValid = okay && reader.isValid()
+				&& (! istrm.bad()) && ostrm.good();
+		}
+		return stats;
+	}
+
+} // [peri::columnar]
+
+
+#endif // peri_Columnar_INCL_
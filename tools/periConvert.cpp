@@ -0,0 +1,989 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#include "periBatch.h"
+#include "periFormat.h"
+#if defined(PERIDETIC_USE_MMAP) // set by build for POSIX platforms
+#include "periMapFile.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+	//! Values for one location (either XYZ or LPA)
+	using Triple = std::array<double, 3u>;
+
+	//! Encoding of point data streams
+	enum Format
+	{
+		  Binary //!< Raw little-endian float64 triples (24 bytes per point)
+		, Text //!< CSV: one point per line (comma and/or white space)
+	};
+
+	//! Configuration from command line
+	struct Options
+	{
+		bool theIsLpaForXyz{ true };
+		Format theInFormat{ Binary };
+		Format theOutFormat{ Binary };
+		bool theUseDegrees{ false };
+		peri::format::Spec theSpec{}; //!< CSV output encoding
+		peri::EarthModel const * thePtModel{ &peri::model::WGS84 };
+		std::size_t theBlockSize{ 1u << 16u }; //!< points per block
+		std::size_t theNumThreads{ 1u }; //!< for conversion of each block
+		std::string theInPath{ "-" };
+		std::string theOutPath{ "-" };
+		bool theUseMap{ false }; //!< zero-copy via mmap (binary files only)
+		bool theInPlace{ false }; //!< overwrite input file (with theUseMap)
+		bool theIsVerbose{ false };
+		bool theIsValid{ false };
+
+		//! Options decoded from command line arguments
+		static
+		Options
+		from
+			( int const & argc
+			, char const * const * const & argv
+			)
+		{
+			Options opts;
+			opts.theNumThreads = std::max
+				(1u, std::thread::hardware_concurrency());
+			std::vector<std::string> paths;
+			bool okay{ 1 < argc };
+			if (okay)
+			{
+				std::string const dir{ argv[1] };
+				opts.theIsLpaForXyz = ("lpaForXyz" == dir);
+				okay = opts.theIsLpaForXyz || ("xyzForLpa" == dir);
+			}
+			for (int narg{2} ; okay && (narg < argc) ; ++narg)
+			{
+				std::string const arg{ argv[narg] };
+				if (("--in=bin" == arg) || ("--in=csv" == arg))
+				{
+					opts.theInFormat = ("--in=bin" == arg) ? Binary : Text;
+				}
+				else
+				if (("--out=bin" == arg) || ("--out=csv" == arg))
+				{
+					opts.theOutFormat = ("--out=bin" == arg) ? Binary : Text;
+				}
+				else
+				if ("--deg" == arg)
+				{
+					opts.theUseDegrees = true;
+				}
+				else
+				if ("--model=WGS84" == arg)
+				{
+					opts.thePtModel = &peri::model::WGS84;
+				}
+				else
+				if ("--model=GRS80" == arg)
+				{
+					opts.thePtModel = &peri::model::GRS80;
+				}
+				else
+				if (0u == arg.compare(0u, 8u, "--block="))
+				{
+					long const size{ std::atol(arg.c_str() + 8u) };
+					okay = (0 < size);
+					if (okay)
+					{
+						opts.theBlockSize = static_cast<std::size_t>(size);
+					}
+				}
+				else
+				if (0u == arg.compare(0u, 10u, "--threads="))
+				{
+					long const num{ std::atol(arg.c_str() + 10u) };
+					okay = (0 < num);
+					if (okay)
+					{
+						opts.theNumThreads = static_cast<std::size_t>(num);
+					}
+				}
+				else
+				if (0u == arg.compare(0u, 9u, "--digits="))
+				{
+					// "--digits=<angular>,<linear>"
+					char const * const beg{ arg.c_str() + 9u };
+					char * next{ nullptr };
+					long const angDigits{ std::strtol(beg, &next, 10) };
+					okay = (beg != next) && (',' == *next);
+					if (okay)
+					{
+						char const * const linBeg{ next + 1 };
+						long const linDigits{ std::strtol(linBeg, &next, 10) };
+						okay = (linBeg != next) && ('\0' == *next)
+							&& (! (angDigits < 0)) && (angDigits < 30)
+							&& (! (linDigits < 0)) && (linDigits < 30);
+						opts.theSpec.theAngDigits = static_cast<int>(angDigits);
+						opts.theSpec.theLinDigits = static_cast<int>(linDigits);
+					}
+				}
+				else
+				if (("--mmap" == arg) || ("--in-place" == arg))
+				{
+#					if defined(PERIDETIC_USE_MMAP)
+					opts.theUseMap = true;
+					opts.theInPlace = ("--in-place" == arg);
+#					else
+					std::cerr << "Option not available on this platform: "
+						<< arg << '\n';
+					okay = false;
+#					endif
+				}
+				else
+				if ("--verbose" == arg)
+				{
+					opts.theIsVerbose = true;
+				}
+				else
+				if ((1u < arg.size()) && ('-' == arg[0]) && ('-' == arg[1]))
+				{
+					std::cerr << "Unknown option: " << arg << '\n';
+					okay = false;
+				}
+				else
+				{
+					paths.emplace_back(arg);
+				}
+			}
+			okay = okay && (paths.size() < 3u);
+			if (okay)
+			{
+				if (0u < paths.size())
+				{
+					opts.theInPath = paths[0];
+				}
+				if (1u < paths.size())
+				{
+					opts.theOutPath = paths[1];
+				}
+			}
+			if (okay && opts.theUseMap)
+			{
+				// mapping requires named binary files
+				okay =
+					(  (Binary == opts.theInFormat)
+					&& (Binary == opts.theOutFormat)
+					&& (! opts.theUseDegrees)
+					&& ("-" != opts.theInPath)
+					&& (opts.theInPlace == (paths.size() < 2u))
+					&& (opts.theInPlace || ("-" != opts.theOutPath))
+					);
+			}
+			opts.theIsValid = okay;
+			return opts;
+		}
+
+		//! Description of command line syntax
+		static
+		std::string
+		usage
+			()
+		{
+			return std::string
+				( "Usage: <progname> {lpaForXyz|xyzForLpa} [options] [inPath [outPath]]"
+				"\nStream point data from inPath to outPath (default or '-' for"
+				"\nstdin/stdout) converting each point in the named direction."
+				"\nOptions:"
+				"\n  --in={bin|csv}   input format (default bin)"
+				"\n  --out={bin|csv}  output format (default bin)"
+				"\n     bin: raw little-endian float64 triples"
+				"\n     csv: one point per line, values separated by ',' or space"
+				"\n          (blank lines and lines starting with '#' are skipped)"
+				"\n  --digits=<a>,<l> CSV output with fixed digits after decimal"
+				"\n                   point for angles <a> and lengths <l>"
+				"\n                   (default: shortest text that is exact)"
+				"\n  --deg            LPA angles are in degrees (default radians)"
+				"\n  --model={WGS84|GRS80}  earth model (default WGS84)"
+				"\n  --block=<num>    points per processing block (default 65536)"
+				"\n  --threads=<num>  conversion threads (default all cores)"
+				"\n  --mmap           map binary inPath/outPath files (zero-copy)"
+				"\n                   (POSIX platforms only)"
+				"\n  --in-place       map inPath and overwrite it with results"
+				"\n                   (with --mmap/--in-place: radians only)"
+				"\n  --verbose        report throughput to stderr"
+				"\n"
+				);
+		}
+
+	}; // Options
+
+	//! Chunk of point data passed between pipeline stages
+	struct Block
+	{
+		std::vector<Triple> thePnts{};
+		std::size_t theNumPnts{ 0u };
+		std::vector<char> theText{}; //!< scratch space for formatting
+
+	}; // Block
+
+	//! Thread-safe FIFO of blocks (pop() returns null once closed and empty)
+	class BlockQueue
+	{
+		std::mutex theMutex{};
+		std::condition_variable theCondVar{};
+		std::deque<Block *> theBlocks{};
+		bool theIsClosed{ false };
+
+	public:
+
+		//! Append block and wake a waiting consumer
+		inline
+		void
+		push
+			( Block * const & ptBlock
+			)
+		{
+			{
+				std::lock_guard<std::mutex> lock(theMutex);
+				theBlocks.emplace_back(ptBlock);
+			}
+			theCondVar.notify_one();
+		}
+
+		//! Signal that no more blocks will be pushed
+		inline
+		void
+		close
+			()
+		{
+			{
+				std::lock_guard<std::mutex> lock(theMutex);
+				theIsClosed = true;
+			}
+			theCondVar.notify_all();
+		}
+
+		//! Next block (waiting if needed), or null after close() and empty
+		inline
+		Block *
+		pop
+			()
+		{
+			Block * ptBlock{ nullptr };
+			std::unique_lock<std::mutex> lock(theMutex);
+			theCondVar.wait
+				(lock, [this] () { return theIsClosed || (! theBlocks.empty()); });
+			if (! theBlocks.empty())
+			{
+				ptBlock = theBlocks.front();
+				theBlocks.pop_front();
+			}
+			return ptBlock;
+		}
+
+	}; // BlockQueue
+
+	//! True if this machine stores doubles in little-endian byte order
+	inline
+	bool
+	isLittleEndian
+		()
+	{
+		std::uint16_t const value{ 1u };
+		unsigned char bytes[2];
+		std::memcpy(bytes, &value, 2u);
+		return (1u == bytes[0]);
+	}
+
+	//! Reverse byte order of each double (for big-endian hosts)
+	inline
+	void
+	swapBytes
+		( Triple * const & pnts
+		, std::size_t const & numPnts
+		)
+	{
+		unsigned char * const bytes{ reinterpret_cast<unsigned char *>(pnts) };
+		std::size_t const numValues{ 3u * numPnts };
+		for (std::size_t nv{0u} ; nv < numValues ; ++nv)
+		{
+			unsigned char * const beg{ bytes + 8u*nv };
+			for (std::size_t nb{0u} ; nb < 4u ; ++nb)
+			{
+				std::swap(beg[nb], beg[7u - nb]);
+			}
+		}
+	}
+
+	//! Source of blocks from binary or CSV stream
+	class Reader
+	{
+		std::FILE * theFile{ nullptr };
+		Format theFormat{ Binary };
+		std::size_t theBlockSize{ 0u };
+		std::vector<char> theCarry{}; //!< partial line from previous read
+		std::size_t theLineNum{ 0u };
+		std::string theLine{}; //!< null terminated copy of current line
+		std::string theError{};
+
+		//! Fill block with binary values
+		inline
+		void
+		readBinary
+			( Block * const & ptBlock
+			)
+		{
+			std::size_t const numBytes{ sizeof(Triple) * theBlockSize };
+			char * const buf{ reinterpret_cast<char *>(ptBlock->thePnts.data()) };
+			std::size_t numGot{ 0u };
+			while (numGot < numBytes)
+			{
+				std::size_t const numRead
+					{ std::fread(buf + numGot, 1u, numBytes - numGot, theFile) };
+				if (0u == numRead)
+				{
+					break;
+				}
+				numGot += numRead;
+			}
+			if (0u != (numGot % sizeof(Triple)))
+			{
+				theError = "Binary input size is not a multiple of 24 bytes";
+			}
+			ptBlock->theNumPnts = numGot / sizeof(Triple);
+			if (! isLittleEndian())
+			{
+				swapBytes(ptBlock->thePnts.data(), ptBlock->theNumPnts);
+			}
+		}
+
+		//! Decode one line of text (true if line holds a point)
+		inline
+		bool
+		parseLine
+			( char const * const & beg
+			, char const * const & end
+			, Triple * const & ptPnt
+			)
+		{
+			bool hasPnt{ false };
+			// skip leading white space
+			char const * ptr{ beg };
+			while ((ptr < end) && ((' ' == *ptr) || ('\t' == *ptr)))
+			{
+				++ptr;
+			}
+			if ((ptr < end) && ('#' != *ptr) && ('\r' != *ptr))
+			{
+				// strtod() needs null termination: copy line (reused buffer)
+				theLine.assign(ptr, end);
+				char const * pos{ theLine.c_str() };
+				std::size_t nv{ 0u };
+				for ( ; nv < 3u ; ++nv)
+				{
+					while ((' ' == *pos) || ('\t' == *pos) || (',' == *pos))
+					{
+						++pos;
+					}
+					char * next{ nullptr };
+					(*ptPnt)[nv] = std::strtod(pos, &next);
+					if (next == pos)
+					{
+						break;
+					}
+					pos = next;
+				}
+				hasPnt = (3u == nv);
+				if (! hasPnt)
+				{
+					theError = "Bad CSV input at line "
+						+ std::to_string(theLineNum);
+				}
+			}
+			return hasPnt;
+		}
+
+		//! Fill block with points from (roughly block size worth of) text
+		inline
+		void
+		readText
+			( Block * const & ptBlock
+			)
+		{
+			// read enough bytes for approximately a block of points
+			std::size_t const numChunk{ 64u * theBlockSize };
+			std::vector<char> & text = ptBlock->theText;
+			text.swap(theCarry);
+			std::size_t const numPrev{ text.size() };
+			text.resize(numPrev + numChunk);
+			std::size_t const numRead
+				{ std::fread(text.data() + numPrev, 1u, numChunk, theFile) };
+			text.resize(numPrev + numRead);
+			bool const atEnd{ 0u == numRead };
+
+			// keep incomplete trailing line for next time
+			std::size_t numUse{ text.size() };
+			if (! atEnd)
+			{
+				while ((0u < numUse) && ('\n' != text[numUse - 1u]))
+				{
+					--numUse;
+				}
+			}
+			theCarry.assign(text.cbegin() + numUse, text.cend());
+
+			// decode complete lines
+			std::vector<Triple> & pnts = ptBlock->thePnts;
+			pnts.clear();
+			char const * ptr{ text.data() };
+			char const * const end{ text.data() + numUse };
+			while (theError.empty() && (ptr < end))
+			{
+				char const * eol
+					{ static_cast<char const *>
+						(std::memchr(ptr, '\n', static_cast<std::size_t>(end - ptr)))
+					};
+				if (! eol)
+				{
+					eol = end;
+				}
+				++theLineNum;
+				Triple pnt;
+				if (parseLine(ptr, eol, &pnt))
+				{
+					pnts.emplace_back(pnt);
+				}
+				ptr = eol + 1;
+			}
+			ptBlock->theNumPnts = pnts.size();
+
+			// a chunk of only comments is not the end of data
+			if ((0u == ptBlock->theNumPnts) && (! atEnd) && theError.empty())
+			{
+				readText(ptBlock);
+			}
+		}
+
+	public:
+
+		//! Attach to open file
+		explicit
+		Reader
+			( std::FILE * const & file
+			, Format const & format
+			, std::size_t const & blockSize
+			)
+			: theFile{ file }
+			, theFormat{ format }
+			, theBlockSize{ blockSize }
+		{ }
+
+		//! Fill block with next points (theNumPnts is zero at end of data)
+		inline
+		void
+		fill
+			( Block * const & ptBlock
+			)
+		{
+			ptBlock->theNumPnts = 0u;
+			if (theError.empty())
+			{
+				if (Binary == theFormat)
+				{
+					ptBlock->thePnts.resize(theBlockSize);
+					readBinary(ptBlock);
+				}
+				else
+				{
+					readText(ptBlock);
+				}
+				if (std::ferror(theFile))
+				{
+					theError = "Error reading input";
+				}
+			}
+		}
+
+		//! Problem description (empty if no error)
+		inline
+		std::string const &
+		error
+			() const
+		{
+			return theError;
+		}
+
+	}; // Reader
+
+	//! Put block contents to binary or CSV stream
+	inline
+	bool
+	writeBlock
+		( std::FILE * const & file
+		, Options const & opts
+		, Block * const & ptBlock
+		)
+	{
+		std::size_t const numPnts{ ptBlock->theNumPnts };
+		bool okay{ true };
+		if (Binary == opts.theOutFormat)
+		{
+			if (! isLittleEndian())
+			{
+				swapBytes(ptBlock->thePnts.data(), numPnts);
+			}
+			std::size_t const numWrote
+				{ std::fwrite(ptBlock->thePnts.data(), sizeof(Triple), numPnts, file) };
+			okay = (numPnts == numWrote);
+		}
+		else
+		{
+			// encode text a page at a time
+			constexpr std::size_t pageSize{ 1u << 20u };
+			std::vector<char> & page = ptBlock->theText;
+			page.resize(pageSize);
+			Triple const * const pnts{ ptBlock->thePnts.data() };
+			std::size_t numDone{ 0u };
+			while (okay && (numDone < numPnts))
+			{
+				std::size_t numPage{ 0u };
+				std::size_t const numBytes
+					{ opts.theIsLpaForXyz
+						? peri::format::lpaPage
+							( pnts + numDone, numPnts - numDone, opts.theSpec
+							, page.data(), page.size(), &numPage
+							)
+						: peri::format::xyzPage
+							( pnts + numDone, numPnts - numDone, opts.theSpec
+							, page.data(), page.size(), &numPage
+							)
+					};
+				okay =
+					(  (0u < numPage)
+					&& (numBytes == std::fwrite(page.data(), 1u, numBytes, file))
+					);
+				numDone += numPage;
+			}
+		}
+		return okay;
+	}
+
+	//! Transform numPnts values in place
+	inline
+	void
+	convertPoints
+		( Options const & opts
+		, Triple * const & pnts
+		, std::size_t const & numPnts
+		)
+	{
+		double const & radPerDeg = peri::sRadPerDeg;
+		if (opts.theIsLpaForXyz)
+		{
+			peri::batch::lpaForXyz(pnts, numPnts, pnts, *opts.thePtModel);
+			if (opts.theUseDegrees)
+			{
+				for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+				{
+					pnts[nn][0] /= radPerDeg;
+					pnts[nn][1] /= radPerDeg;
+				}
+			}
+		}
+		else
+		{
+			if (opts.theUseDegrees)
+			{
+				for (std::size_t nn{0u} ; nn < numPnts ; ++nn)
+				{
+					pnts[nn][0] *= radPerDeg;
+					pnts[nn][1] *= radPerDeg;
+				}
+			}
+			peri::batch::xyzForLpa(pnts, numPnts, pnts, *opts.thePtModel);
+		}
+	}
+
+	/*! \brief Persistent worker threads for in place block conversion.
+	 *
+	 * Workers are started once (per stream) and each block is partitioned
+	 * into one slice per thread (the calling thread converts slice zero).
+	 */
+	class ConvertCrew
+	{
+		Options const & theOpts;
+		std::mutex theMutex{};
+		std::condition_variable theWorkCondVar{};
+		std::condition_variable theDoneCondVar{};
+		Triple * thePnts{ nullptr };
+		std::size_t theNumPnts{ 0u };
+		std::size_t theNumPer{ 0u };
+		std::size_t theGeneration{ 0u };
+		std::size_t theNumPending{ 0u };
+		bool theIsClosed{ false };
+		std::vector<std::thread> theThreads{};
+
+		//! Range of points in slice ndx of current block
+		inline
+		std::pair<std::size_t, std::size_t>
+		sliceRange
+			( std::size_t const & ndx
+			) const
+		{
+			std::size_t const beg{ std::min(theNumPnts, ndx * theNumPer) };
+			std::size_t const end{ std::min(theNumPnts, beg + theNumPer) };
+			return { beg, end };
+		}
+
+		//! Worker loop: convert slice ndx of each block until closed
+		inline
+		void
+		work
+			( std::size_t const & ndx
+			)
+		{
+			std::size_t doneGeneration{ 0u };
+			for (;;)
+			{
+				std::pair<std::size_t, std::size_t> range;
+				{
+					std::unique_lock<std::mutex> lock(theMutex);
+					theWorkCondVar.wait
+						( lock
+						, [this, &doneGeneration] ()
+							{ return theIsClosed
+								|| (! (doneGeneration == theGeneration));
+							}
+						);
+					if (theIsClosed)
+					{
+						break;
+					}
+					doneGeneration = theGeneration;
+					range = sliceRange(ndx);
+				}
+				convertPoints
+					(theOpts, thePnts + range.first, range.second - range.first);
+				bool isLast{ false };
+				{
+					std::lock_guard<std::mutex> lock(theMutex);
+					isLast = (0u == --theNumPending);
+				}
+				if (isLast)
+				{
+					theDoneCondVar.notify_one();
+				}
+			}
+		}
+
+	public:
+
+		//! Start (opts.theNumThreads - 1) worker threads
+		explicit
+		ConvertCrew
+			( Options const & opts
+			)
+			: theOpts{ opts }
+		{
+			std::size_t const numThreads
+				{ std::max(std::size_t{ 1u }, opts.theNumThreads) };
+			theThreads.reserve(numThreads - 1u);
+			for (std::size_t nt{1u} ; nt < numThreads ; ++nt)
+			{
+				theThreads.emplace_back([this, nt] () { work(nt); });
+			}
+		}
+
+		//! Stop and join worker threads
+		~ConvertCrew
+			()
+		{
+			{
+				std::lock_guard<std::mutex> lock(theMutex);
+				theIsClosed = true;
+			}
+			theWorkCondVar.notify_all();
+			for (std::thread & thread : theThreads)
+			{
+				thread.join();
+			}
+		}
+
+		ConvertCrew(ConvertCrew const &) = delete;
+		ConvertCrew & operator=(ConvertCrew const &) = delete;
+
+		//! Transform block contents in place (returns when all complete)
+		inline
+		void
+		convert
+			( Block * const & ptBlock
+			)
+		{
+			std::size_t const numPnts{ ptBlock->theNumPnts };
+			std::size_t const numThreads{ theThreads.size() + 1u };
+			constexpr std::size_t minPerThread{ 1024u };
+			if (theThreads.empty() || (numPnts < 2u * minPerThread))
+			{
+				convertPoints(theOpts, ptBlock->thePnts.data(), numPnts);
+				return;
+			}
+			std::pair<std::size_t, std::size_t> range;
+			{
+				std::lock_guard<std::mutex> lock(theMutex);
+				thePnts = ptBlock->thePnts.data();
+				theNumPnts = numPnts;
+				theNumPer = (numPnts + numThreads - 1u) / numThreads;
+				theNumPending = theThreads.size();
+				++theGeneration;
+				range = sliceRange(0u);
+			}
+			theWorkCondVar.notify_all();
+			convertPoints
+				(theOpts, thePnts + range.first, range.second - range.first);
+			std::unique_lock<std::mutex> lock(theMutex);
+			theDoneCondVar.wait(lock, [this] () { return (0u == theNumPending); });
+		}
+
+	}; // ConvertCrew
+
+	//! Stream all data from inFile to outFile (returns number of points)
+	inline
+	std::size_t
+	convertStream
+		( Options const & opts
+		, std::FILE * const & inFile
+		, std::FILE * const & outFile
+		, std::string * const & ptError
+		)
+	{
+		// two blocks per stage: each stage works on one while the next fills
+		constexpr std::size_t numBlocks{ 6u };
+		std::vector<Block> blocks(numBlocks);
+		BlockQueue freeQ;
+		BlockQueue readQ;
+		BlockQueue doneQ;
+		for (Block & block : blocks)
+		{
+			freeQ.push(&block);
+		}
+
+		// reader thread: input -> readQ
+		Reader reader(inFile, opts.theInFormat, opts.theBlockSize);
+		std::thread readThread
+			( [&reader, &freeQ, &readQ] ()
+				{
+					for (;;)
+					{
+						Block * const ptBlock{ freeQ.pop() };
+						reader.fill(ptBlock);
+						if (0u == ptBlock->theNumPnts)
+						{
+							freeQ.push(ptBlock);
+							break;
+						}
+						readQ.push(ptBlock);
+					}
+					readQ.close();
+				}
+			);
+
+		// writer thread: doneQ -> output
+		bool writeOkay{ true };
+		std::thread writeThread
+			( [&opts, &outFile, &writeOkay, &doneQ, &freeQ] ()
+				{
+					Block * ptBlock{ nullptr };
+					while ((ptBlock = doneQ.pop()))
+					{
+						if (writeOkay)
+						{
+							writeOkay = writeBlock(outFile, opts, ptBlock);
+						}
+						freeQ.push(ptBlock);
+					}
+				}
+			);
+
+		// this thread (with workers): readQ -> conversion -> doneQ
+		ConvertCrew crew(opts);
+		std::size_t numPnts{ 0u };
+		Block * ptBlock{ nullptr };
+		while ((ptBlock = readQ.pop()))
+		{
+			crew.convert(ptBlock);
+			numPnts += ptBlock->theNumPnts;
+			doneQ.push(ptBlock);
+		}
+		doneQ.close();
+
+		readThread.join();
+		writeThread.join();
+
+		if (! reader.error().empty())
+		{
+			*ptError = reader.error();
+		}
+		else
+		if (! (writeOkay && (0 == std::fflush(outFile))))
+		{
+			*ptError = "Error writing output";
+		}
+		return numPnts;
+	}
+
+} // [annon]
+
+
+//! periConvert: Stream bulk point data through XYZ/LPA transformation.
+int
+main
+	( int argc
+	, char ** argv
+	)
+{
+	int stat{ 1 };
+	Options const opts{ Options::from(argc, argv) };
+	if (! opts.theIsValid)
+	{
+		std::cerr << Options::usage();
+	}
+#	if defined(PERIDETIC_USE_MMAP)
+	else
+	if (opts.theUseMap)
+	{
+		using Clock = std::chrono::steady_clock;
+		Clock::time_point const t0{ Clock::now() };
+		peri::mapped::Direction const dir
+			{ opts.theIsLpaForXyz
+				? peri::mapped::LpaForXyz : peri::mapped::XyzForLpa
+			};
+		std::string const outPath
+			{ opts.theInPlace ? std::string{} : opts.theOutPath };
+		std::string const error
+			{ peri::mapped::convertFile
+				( dir, opts.theInPath, outPath
+				, *opts.thePtModel, opts.theNumThreads
+				)
+			};
+		Clock::time_point const t1{ Clock::now() };
+		if (error.empty())
+		{
+			stat = 0;
+		}
+		else
+		{
+			std::cerr << error << '\n';
+		}
+		if (opts.theIsVerbose)
+		{
+			double const sec{ std::chrono::duration<double>(t1 - t0).count() };
+			std::cerr << "mapped conversion time[s]: " << sec << '\n';
+		}
+	}
+#	endif // PERIDETIC_USE_MMAP
+	else
+	{
+		std::FILE * const inFile
+			{ ("-" == opts.theInPath)
+				? stdin : std::fopen(opts.theInPath.c_str(), "rb")
+			};
+		std::FILE * const outFile
+			{ ("-" == opts.theOutPath)
+				? stdout : std::fopen(opts.theOutPath.c_str(), "wb")
+			};
+		if (! inFile)
+		{
+			std::cerr << "Error opening input: " << opts.theInPath << '\n';
+		}
+		else
+		if (! outFile)
+		{
+			std::cerr << "Error opening output: " << opts.theOutPath << '\n';
+		}
+		else
+		{
+			// larger stdio buffers (data are moved in large blocks anyway)
+			std::setvbuf(inFile, nullptr, _IOFBF, 1u << 20u);
+			std::setvbuf(outFile, nullptr, _IOFBF, 1u << 20u);
+
+			using Clock = std::chrono::steady_clock;
+			Clock::time_point const t0{ Clock::now() };
+			std::string error;
+			std::size_t const numPnts
+				{ convertStream(opts, inFile, outFile, &error) };
+			Clock::time_point const t1{ Clock::now() };
+
+			if (error.empty())
+			{
+				stat = 0;
+			}
+			else
+			{
+				std::cerr << error << '\n';
+			}
+			if (opts.theIsVerbose)
+			{
+				double const sec{ std::chrono::duration<double>(t1 - t0).count() };
+				std::cerr
+					<< "numPnts: " << numPnts
+					<< "  time[s]: " << sec
+					<< "  pnts/s: " << (double(numPnts) / sec)
+					<< '\n';
+			}
+		}
+		if (inFile && (stdin != inFile))
+		{
+			std::fclose(inFile);
+		}
+		if (outFile && (stdout != outFile))
+		{
+			if (0 != std::fclose(outFile))
+			{
+				std::cerr << "Error closing output: " << opts.theOutPath << '\n';
+				stat = 1;
+			}
+		}
+	}
+	return stat;
+}
@@ -0,0 +1,250 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef peri_Format_INCL_
+#define peri_Format_INCL_
+
+
+/*! \file
+ * \brief Locale-free text encoding of coordinates into caller buffers.
+ *
+ * Values are encoded with std::to_chars (no streams, no allocation).
+ * Each function writes into [beg,end) and returns one past the last
+ * character written - or nullptr if the buffer is too small (in which
+ * case buffer content is unspecified).
+ */
+
+
+#include "peridetic.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+
+
+namespace peri::format
+{
+	//! Encoding options for coordinate records
+	struct Spec
+	{
+		//! Digits after decimal point for angles (negative: shortest exact)
+		int theAngDigits{ -1 };
+		//! Digits after decimal point for lengths (negative: shortest exact)
+		int theLinDigits{ -1 };
+		//! If true, express angles in degrees (else radians)
+		bool theAngDegrees{ false };
+		//! Separator between values (records end with '\n')
+		char theSep{ ',' };
+
+	}; // Spec
+
+	//! Encode value with fixed digits (or shortest exact form if digits < 0)
+	//! \note Shortest exact form may use e-notation (e.g. "3e+06")
+	inline
+	char *
+	valueChars
+		( char * const & beg
+		, char * const & end
+		, double const & value
+		, int const & digits
+		)
+	{
+		std::to_chars_result const result
+			{ (digits < 0)
+				? std::to_chars(beg, end, value)
+				: std::to_chars(beg, end, value, std::chars_format::fixed, digits)
+			};
+		char * ptr{ nullptr };
+		if (std::errc{} == result.ec)
+		{
+			ptr = result.ptr;
+		}
+		return ptr;
+	}
+
+	//! Encode three values as separated record ending with newline
+	inline
+	char *
+	tripleChars
+		( char * const & beg
+		, char * const & end
+		, double const & valueA
+		, int const & digitsA
+		, double const & valueB
+		, int const & digitsB
+		, double const & valueC
+		, int const & digitsC
+		, char const & sep
+		)
+	{
+		char * ptr{ valueChars(beg, end, valueA, digitsA) };
+		if (ptr && (ptr < end))
+		{
+			*ptr++ = sep;
+			ptr = valueChars(ptr, end, valueB, digitsB);
+		}
+		if (ptr && (ptr < end))
+		{
+			*ptr++ = sep;
+			ptr = valueChars(ptr, end, valueC, digitsC);
+		}
+		if (ptr && (ptr < end))
+		{
+			*ptr++ = '\n';
+		}
+		else
+		{
+			ptr = nullptr;
+		}
+		return ptr;
+	}
+
+	//! Encode "lon,par,alt\n" (angles in radians or degrees per spec)
+	inline
+	char *
+	lpaChars
+		( char * const & beg
+		, char * const & end
+		, LPA const & lpa
+		, Spec const & spec = {}
+		)
+	{
+		double const angScale
+			{ spec.theAngDegrees ? (1. / sRadPerDeg) : 1. };
+		return tripleChars
+			( beg, end
+			, angScale * lpa[0], spec.theAngDigits
+			, angScale * lpa[1], spec.theAngDigits
+			, lpa[2], spec.theLinDigits
+			, spec.theSep
+			);
+	}
+
+	//! Encode "x,y,z\n" (all values use spec.theLinDigits)
+	inline
+	char *
+	xyzChars
+		( char * const & beg
+		, char * const & end
+		, XYZ const & xyz
+		, Spec const & spec = {}
+		)
+	{
+		return tripleChars
+			( beg, end
+			, xyz[0], spec.theLinDigits
+			, xyz[1], spec.theLinDigits
+			, xyz[2], spec.theLinDigits
+			, spec.theSep
+			);
+	}
+
+	/*! \brief Encode as many whole records as fit into page.
+	 *
+	 * Returns number of bytes used and sets *ptNumDone to the number of
+	 * records encoded. Typical use fills a page (e.g. I/O buffer or
+	 * memory mapped output) then continues with remaining records:
+	 * \code
+	 * std::size_t done{ 0u }, num{ 0u };
+	 * while (done < numPnts)
+	 * {
+	 * 	std::size_t const used{ lpaPage(lpas+done, numPnts-done, spec
+	 * 		, page, pageSize, &num) };
+	 * 	write(page, used); done += num;
+	 * }
+	 * \endcode
+	 * \note A single record requires at most a few hundred bytes (e.g.
+	 * fixed format of 1.e300) - pages should be much larger than this.
+	 */
+	template <typename Triple, typename EncodeFunc>
+	inline
+	std::size_t
+	recordsPage
+		( Triple const * const & pnts
+		, std::size_t const & numPnts
+		, Spec const & spec
+		, char * const & page
+		, std::size_t const & pageSize
+		, std::size_t * const & ptNumDone
+		, EncodeFunc const & encode
+		)
+	{
+		char * const end{ page + pageSize };
+		char * used{ page };
+		std::size_t nn{ 0u };
+		for ( ; nn < numPnts ; ++nn)
+		{
+			char * const next{ encode(used, end, pnts[nn], spec) };
+			if (! next)
+			{
+				break;
+			}
+			used = next;
+		}
+		*ptNumDone = nn;
+		return static_cast<std::size_t>(used - page);
+	}
+
+	//! Encode LPA records into page (ref recordsPage())
+	inline
+	std::size_t
+	lpaPage
+		( LPA const * const & lpas
+		, std::size_t const & numPnts
+		, Spec const & spec
+		, char * const & page
+		, std::size_t const & pageSize
+		, std::size_t * const & ptNumDone
+		)
+	{
+		return recordsPage
+			(lpas, numPnts, spec, page, pageSize, ptNumDone, lpaChars);
+	}
+
+	//! Encode XYZ records into page (ref recordsPage())
+	inline
+	std::size_t
+	xyzPage
+		( XYZ const * const & xyzs
+		, std::size_t const & numPnts
+		, Spec const & spec
+		, char * const & page
+		, std::size_t const & pageSize
+		, std::size_t * const & ptNumDone
+		)
+	{
+		return recordsPage
+			(xyzs, numPnts, spec, page, pageSize, ptNumDone, xyzChars);
+	}
+
+} // [peri::format]
+
+
+#endif // peri_Format_INCL_
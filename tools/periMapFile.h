@@ -0,0 +1,457 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+
+#ifndef peri_MapFile_INCL_
+#define peri_MapFile_INCL_
+
+
+/*! \file
+ * \brief Zero-copy transformation of binary point files via mmap (POSIX).
+ *
+ * Files contain packed records of three native (little-endian) float64
+ * values (XYZ or LPA, 24 bytes per point, no header). Input is mapped
+ * read-only and results are written directly into a mapped output file
+ * (pre-sized to match) - or back into the input mapping for in-place
+ * conversion. Records are processed in chunks claimed by worker threads.
+ */
+
+
+#include "periBatch.h"
+
+#if ! (defined(__unix__) || defined(__APPLE__))
+#	error "periMapFile.h requires a POSIX platform (mmap)"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace peri::mapped
+{
+	//! Values for one location (either XYZ or LPA) as stored in file
+	using Triple = std::array<double, 3u>;
+
+	//! Memory mapping of entire file (unmapped and closed at destruction)
+	class MapFile
+	{
+		int theFd{ -1 };
+		void * theData{ nullptr };
+		std::size_t theSize{ 0u };
+		std::string theError{};
+
+		//! Description of most recent system error
+		inline
+		void
+		setError  // MapFile::
+			( std::string const & what
+			, std::string const & path
+			)
+		{
+			theError = what + ": " + path + ": " + std::strerror(errno);
+		}
+
+		//! Map theSize bytes of open file
+		inline
+		void
+		mapOpenFile  // MapFile::
+			( int const & prot
+			, std::string const & path
+			)
+		{
+			// (mmap() of zero bytes is an error - leave data null)
+			if (0u < theSize)
+			{
+				void * const ptr
+					{ ::mmap(nullptr, theSize, prot, MAP_SHARED, theFd, 0) };
+				if (MAP_FAILED == ptr)
+				{
+					setError("Error mapping", path);
+				}
+				else
+				{
+					theData = ptr;
+					// access is (mostly) sequential: encourage read-ahead
+					::madvise(theData, theSize, MADV_SEQUENTIAL);
+				}
+			}
+		}
+
+		//! Release resources
+		inline
+		void
+		release  // MapFile::
+			()
+		{
+			if (theData)
+			{
+				::munmap(theData, theSize);
+				theData = nullptr;
+			}
+			if (! (theFd < 0))
+			{
+				::close(theFd);
+				theFd = -1;
+			}
+		}
+
+	public:
+
+		//! Mapping of existing file (writable if needed for in-place use)
+		inline
+		static
+		MapFile
+		ofExisting  // MapFile::
+			( std::string const & path
+			, bool const & writable = false
+			)
+		{
+			MapFile map;
+			map.theFd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+			struct stat info{};
+			if (map.theFd < 0)
+			{
+				map.setError("Error opening", path);
+			}
+			else
+			if (0 != ::fstat(map.theFd, &info))
+			{
+				map.setError("Error reading size of", path);
+			}
+			else
+			{
+				map.theSize = static_cast<std::size_t>(info.st_size);
+				int const prot
+					{ writable ? (PROT_READ | PROT_WRITE) : PROT_READ };
+				map.mapOpenFile(prot, path);
+			}
+			return map;
+		}
+
+		//! Mapping of newly created (or truncated) file of given size
+		inline
+		static
+		MapFile
+		ofNewSize  // MapFile::
+			( std::string const & path
+			, std::size_t const & size
+			)
+		{
+			MapFile map;
+			map.theFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (map.theFd < 0)
+			{
+				map.setError("Error creating", path);
+			}
+			else
+			if (0 != ::ftruncate(map.theFd, static_cast<off_t>(size)))
+			{
+				map.setError("Error sizing", path);
+			}
+			else
+			{
+				map.theSize = size;
+				map.mapOpenFile(PROT_READ | PROT_WRITE, path);
+			}
+			return map;
+		}
+
+		MapFile
+			() = default;
+
+		MapFile
+			( MapFile && orig
+			)
+			: theFd{ std::exchange(orig.theFd, -1) }
+			, theData{ std::exchange(orig.theData, nullptr) }
+			, theSize{ std::exchange(orig.theSize, 0u) }
+			, theError{ std::move(orig.theError) }
+		{ }
+
+		MapFile &
+		operator=
+			( MapFile && orig
+			)
+		{
+			if (this != &orig)
+			{
+				release();
+				theFd = std::exchange(orig.theFd, -1);
+				theData = std::exchange(orig.theData, nullptr);
+				theSize = std::exchange(orig.theSize, 0u);
+				theError = std::move(orig.theError);
+			}
+			return *this;
+		}
+
+		MapFile
+			( MapFile const & )
+			= delete;
+
+		MapFile &
+		operator=
+			( MapFile const & )
+			= delete;
+
+		~MapFile
+			()
+		{
+			release();
+		}
+
+		//! True if file is open and mapped (or is empty)
+		inline
+		bool
+		isValid  // MapFile::
+			() const
+		{
+			return theError.empty() && (! (theFd < 0));
+		}
+
+		//! Problem description (empty if valid)
+		inline
+		std::string const &
+		error  // MapFile::
+			() const
+		{
+			return theError;
+		}
+
+		//! Number of bytes mapped
+		inline
+		std::size_t
+		size  // MapFile::
+			() const
+		{
+			return theSize;
+		}
+
+		//! Start of mapped memory as point records (null if empty)
+		inline
+		Triple *
+		records  // MapFile::
+			() const
+		{
+			return static_cast<Triple *>(theData);
+		}
+
+		//! Mapped memory as (read-only) text, e.g. for cors::FastParser
+		inline
+		std::string_view
+		text  // MapFile::
+			() const
+		{
+			return std::string_view(static_cast<char const *>(theData), theSize);
+		}
+
+		//! Number of complete point records mapped
+		inline
+		std::size_t
+		numRecords  // MapFile::
+			() const
+		{
+			return (theSize / sizeof(Triple));
+		}
+
+	}; // MapFile
+
+	//! Conversion direction
+	enum Direction
+	{
+		  LpaForXyz
+		, XyzForLpa
+	};
+
+	/*! \brief Transform mapped records with parallel chunks
+	 *
+	 * Worker threads claim consecutive chunks (numPerChunk records) in
+	 * order so that access progresses through memory sequentially.
+	 * Input and output may be the same (in-place). A numPerChunk of zero
+	 * is treated as one.
+	 */
+	inline
+	void
+	convertRecords
+		( Direction const & direction
+		, Triple const * const & inRecs
+		, std::size_t const & numRecs
+		, Triple * const & outRecs
+		, EarthModel const & earthModel = model::WGS84
+		, std::size_t const & numThreads = std::thread::hardware_concurrency()
+		, std::size_t const & numPerChunk = (1u << 16u)
+		)
+	{
+		std::size_t const perChunk{ std::max(std::size_t{ 1u }, numPerChunk) };
+		std::size_t const numChunks{ (numRecs + perChunk - 1u) / perChunk };
+		std::atomic<std::size_t> nextChunk{ 0u };
+		auto const worker
+			{ [&] ()
+				{
+					for (std::size_t nc{ nextChunk.fetch_add(1u) }
+						; nc < numChunks ; nc = nextChunk.fetch_add(1u))
+					{
+						std::size_t const beg{ nc * perChunk };
+						std::size_t const num
+							{ std::min(perChunk, numRecs - beg) };
+						if (LpaForXyz == direction)
+						{
+							batch::lpaForXyz
+								(inRecs + beg, num, outRecs + beg, earthModel);
+						}
+						else
+						{
+							batch::xyzForLpa
+								(inRecs + beg, num, outRecs + beg, earthModel);
+						}
+					}
+				}
+			};
+		std::size_t const numUse
+			{ std::max(std::size_t{ 1u }, std::min(numThreads, numChunks)) };
+		std::vector<std::thread> threads;
+		threads.reserve(numUse);
+		for (std::size_t nt{1u} ; nt < numUse ; ++nt)
+		{
+			threads.emplace_back(worker);
+		}
+		worker(); // this thread also participates
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	//! True if both paths name the same existing file (e.g. via links)
+	inline
+	bool
+	isSameFile
+		( std::string const & pathA
+		, std::string const & pathB
+		)
+	{
+		struct stat infoA{};
+		struct stat infoB{};
+		return
+			(  (0 == ::stat(pathA.c_str(), &infoA))
+			&& (0 == ::stat(pathB.c_str(), &infoB))
+			&& (infoA.st_dev == infoB.st_dev)
+			&& (infoA.st_ino == infoB.st_ino)
+			);
+	}
+
+	/*! \brief Transform binary point file via memory mapping.
+	 *
+	 * If outPath is empty (or refers to the same file as inPath, e.g.
+	 * via a different path spelling or a link), the input file is
+	 * overwritten in place. Otherwise outPath is created with the same
+	 * size as inPath. Returns empty string on success, else description
+	 * of problem.
+	 */
+	inline
+	std::string
+	convertFile
+		( Direction const & direction
+		, std::string const & inPath
+		, std::string const & outPath = {}
+		, EarthModel const & earthModel = model::WGS84
+		, std::size_t const & numThreads = std::thread::hardware_concurrency()
+		, std::size_t const & numPerChunk = (1u << 16u)
+			//!< Records per chunk claimed by each worker (ref convertRecords())
+		)
+	{
+		std::string error;
+		// (output must never truncate the file mapped as input)
+		bool const inPlace
+			{ outPath.empty() || (outPath == inPath)
+			|| isSameFile(inPath, outPath)
+			};
+		std::uint16_t const one{ 1u };
+		if (! (1u == *reinterpret_cast<unsigned char const *>(&one)))
+		{
+			error = "Mapped conversion requires little-endian host";
+		}
+		else
+		{
+			MapFile const inMap{ MapFile::ofExisting(inPath, inPlace) };
+			if (! inMap.isValid())
+			{
+				error = inMap.error();
+			}
+			else
+			if (0u != (inMap.size() % sizeof(Triple)))
+			{
+				error = "Input size is not a multiple of 24 bytes: " + inPath;
+			}
+			else
+			if (inPlace)
+			{
+				convertRecords
+					( direction
+					, inMap.records(), inMap.numRecords(), inMap.records()
+					, earthModel, numThreads, numPerChunk
+					);
+			}
+			else
+			{
+				MapFile const outMap{ MapFile::ofNewSize(outPath, inMap.size()) };
+				if (! outMap.isValid())
+				{
+					error = outMap.error();
+				}
+				else
+				{
+					convertRecords
+						( direction
+						, inMap.records(), inMap.numRecords(), outMap.records()
+						, earthModel, numThreads, numPerChunk
+						);
+				}
+			}
+		}
+		return error;
+	}
+
+} // [peri::mapped]
+
+
+#endif // peri_MapFile_INCL_
@@ -0,0 +1,112 @@
+//
+//
+// MIT License
+//
+// Copyright (c) 2020 Stellacore Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject
+// to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+
+
+#define PERIDETIC_TRACE // for access to peri::trace record functions
+#include "periTrace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+//! periTraceDump: Convert saved trace record file(s) into Chrome JSON.
+int
+main
+	( int argc
+	, char ** argv
+	)
+{
+	int stat{ 1 };
+	if (! (2 < argc))
+	{
+		std::cerr
+			<< "Usage: <progname> outFile.json inFile.trace [inFile.trace ...]"
+			<< "\nConvert trace record files (ref peri::trace::saveRecords())"
+			<< "\ninto Chrome trace JSON for use with chrome://tracing or"
+			<< "\nhttps://ui.perfetto.dev (outFile '-' writes to stdout)."
+			<< '\n';
+	}
+	else
+	{
+		// gather records from all input files
+		std::vector<peri::trace::Record> recs;
+		bool okay{ true };
+		for (int narg{2} ; narg < argc ; ++narg)
+		{
+			std::ifstream ifs(argv[narg]);
+			if (! ifs.good())
+			{
+				std::cerr << "Error opening input: " << argv[narg] << '\n';
+				okay = false;
+				break;
+			}
+			std::size_t numSkipped{ 0u };
+			std::vector<peri::trace::Record> const fileRecs
+				{ peri::trace::loadRecords(ifs, &numSkipped) };
+			recs.insert(recs.end(), fileRecs.cbegin(), fileRecs.cend());
+			if (0u < numSkipped)
+			{
+				std::cerr << "Skipped " << numSkipped
+					<< " malformed line(s) in: " << argv[narg] << '\n';
+			}
+		}
+		std::stable_sort
+			( recs.begin(), recs.end()
+			, [] (peri::trace::Record const & recA, peri::trace::Record const & recB)
+				{ return (recA.theTime < recB.theTime); }
+			);
+
+		if (okay)
+		{
+			std::string const outPath{ argv[1] };
+			if ("-" == outPath)
+			{
+				peri::trace::saveChromeJson(std::cout, recs);
+				stat = 0;
+			}
+			else
+			{
+				std::ofstream ofs(outPath);
+				peri::trace::saveChromeJson(ofs, recs);
+				if (ofs.good())
+				{
+					stat = 0;
+				}
+				else
+				{
+					std::cerr << "Error writing output: " << outPath << '\n';
+				}
+			}
+			std::cerr << "Converted " << recs.size() << " events" << '\n';
+		}
+	}
+	return stat;
+}